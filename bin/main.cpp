@@ -14,7 +14,17 @@ int main(int argc, char** argv) {
     }
     
     try {
-        itmoscript::Interpreter interpreter;
+        itmoscript::Interpreter interpreter{
+            params->need_tree_walk ? itmoscript::vm::ExecutionMode::kTreeWalk : itmoscript::vm::ExecutionMode::kBytecode
+        };
+
+        if (params->max_call_depth.has_value()) {
+            interpreter.SetMaxCallDepth(*params->max_call_depth);
+        }
+
+        if (params->output_buffering.has_value()) {
+            interpreter.SetOutputBuffering(*params->output_buffering);
+        }
 
         if (params->need_repl || params->filename.empty()) {
             std::cout << "ITMOScript super-duper-mega language." << std::endl;
@@ -25,14 +35,16 @@ int main(int argc, char** argv) {
                 repl_mode = itmoscript::ReplMode::kLexer;
             } else if (params->need_parser_mode) {
                 repl_mode = itmoscript::ReplMode::kParser;
+            } else if (params->need_optimizer_mode) {
+                repl_mode = itmoscript::ReplMode::kOptimizer;
             }
 
             interpreter.StartRepl(repl_mode, std::cin, std::cout);
             return 0;
         }
 
-        if (params->need_lexer_mode || params->need_parser_mode) {
-            std::cerr << "Execution mode (--lexer or --parser) is only available in REPL" << std::endl;
+        if (params->need_lexer_mode || params->need_parser_mode || params->need_optimizer_mode) {
+            std::cerr << "Execution mode (--lexer, --parser or --dump-optimized) is only available in REPL" << std::endl;
             return -1;
         }
 
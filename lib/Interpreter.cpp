@@ -15,8 +15,16 @@ bool Interpreter::Interpret(std::istream& code, std::istream& read, std::ostream
 
         evaluator.EnableStandardOperators();
         evaluator.EnableStd();
-
-        evaluator.Evaluate(root, read, write);
+        evaluator.EnableOptimizer(true);
+        evaluator.SetMaxCallDepth(max_call_depth_);
+        evaluator.SetOutputBuffering(output_buffering_);
+
+        if (mode_ == vm::ExecutionMode::kTreeWalk) {
+            evaluator.Evaluate(root, read, write);
+        } else {
+            vm::VirtualMachine machine{evaluator};
+            machine.Evaluate(root, read, write);
+        }
     } catch (const lang_exceptions::RuntimeError& e) {
         write << e.GetCallStackMessage() << std::endl;
         utils::PrintException(write, e, "Runtime error");
@@ -40,7 +48,8 @@ bool Interpreter::InterpretFromFile(const std::string& filename, std::istream& r
 
 
 void Interpreter::StartRepl(ReplMode mode, std::istream& input, std::ostream& output) {
-    REPL repl{mode};
+    REPL repl{mode, mode_};
+    repl.SetMaxCallDepth(max_call_depth_);
     repl.Start(input, output);
 }
     
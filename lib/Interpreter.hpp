@@ -0,0 +1,41 @@
+#pragma once
+
+#include <iostream>
+
+#include "lexer/Lexer.hpp"
+#include "repl/REPL.hpp"
+#include "parser/Parser.hpp"
+#include "evaluation/Evaluator.hpp"
+#include "vm/VirtualMachine.hpp"
+#include "LangException.hpp"
+
+namespace itmoscript {
+
+class Interpreter {
+public:
+    /**
+     * @brief Constructs the interpreter.
+     * @param mode Engine the programs are executed with. The bytecode VM is used by default,
+     * the tree-walking Evaluator is kept for debugging and comparison.
+     */
+    explicit Interpreter(vm::ExecutionMode mode = vm::ExecutionMode::kBytecode)
+        : mode_(mode) {}
+
+    bool Interpret(std::istream& code, std::istream& read, std::ostream& write);
+    bool InterpretFromFile(const std::string& filename, std::istream& read, std::ostream& write);
+
+    void StartRepl(ReplMode mode, std::istream& read, std::ostream& write);
+
+    /** @brief Sets the number of nested calls after which the programs fail, see Evaluator::SetMaxCallDepth. */
+    void SetMaxCallDepth(size_t depth) { max_call_depth_ = depth; }
+
+    /** @brief Sets when the output of the programs is flushed, see OutputSink. */
+    void SetOutputBuffering(OutputSink::Policy policy) { output_buffering_ = policy; }
+
+private:
+    vm::ExecutionMode mode_;
+    size_t max_call_depth_ = Evaluator::kDefaultMaxCallDepth;
+    OutputSink::Policy output_buffering_ = OutputSink::Policy::kLine;
+};
+    
+} // namespace itmoscript
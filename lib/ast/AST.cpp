@@ -2,6 +2,7 @@
 #include "utils.hpp"
 
 #include <format>
+#include <algorithm>
 
 namespace itmoscript {
 
@@ -11,6 +12,10 @@ const std::vector<std::shared_ptr<Statement>>& Program::GetStatements() const {
     return statements_;
 }
 
+std::vector<std::shared_ptr<Statement>>& Program::GetStatements() {
+    return statements_;
+}
+
 void Program::AddStatement(std::shared_ptr<Statement> statement) {
     statements_.push_back(std::move(statement));
 }
@@ -31,6 +36,10 @@ const std::vector<std::shared_ptr<Statement>>& BlockStatement::GetStatements() c
     return statements_;
 }
 
+std::vector<std::shared_ptr<Statement>>& BlockStatement::GetStatements() {
+    return statements_;
+}
+
 void BlockStatement::AddStatement(std::shared_ptr<Statement> statement) {
     statements_.push_back(std::move(statement));
 }
@@ -66,6 +75,10 @@ std::string ReturnStatement::String() const {
     return std::format("return {}", (expr ? expr->String() : ""));
 }
 
+std::string YieldStatement::String() const {
+    return std::format("yield {}", (expr ? expr->String() : ""));
+}
+
 std::string ExpressionStatement::String() const {
     return expr->String();
 }
@@ -82,6 +95,10 @@ std::string InfixExpression::String() const {
     return std::format("({} {} {})", left->String(), kTokenTypeNames.at(oper), right->String());
 }
 
+std::string InvariantExpression::String() const {
+    return std::format("invariant({})", expr->String());
+}
+
 std::string IfBranch::String() const {
     std::string result;
     if (condition != nullptr) {
@@ -142,6 +159,15 @@ std::string ListLiteral::String() const {
     return result;
 }
 
+bool ListLiteral::HasConstantElements() const {
+    return std::ranges::all_of(elements, [](const std::shared_ptr<Expression>& element) {
+        return dynamic_cast<IntegerLiteral*>(element.get()) != nullptr
+            || dynamic_cast<FloatLiteral*>(element.get()) != nullptr
+            || dynamic_cast<BooleanLiteral*>(element.get()) != nullptr
+            || dynamic_cast<NullTypeLiteral*>(element.get()) != nullptr;
+    });
+}
+
 std::string IndexOperatorExpression::String() const {
     std::string result;
     result += operand->String();
@@ -171,6 +197,18 @@ std::string CallExpression::String() const {
     return result;
 }
 
+std::string InlinedCallExpression::String() const {
+    std::string result = std::format("inline {}(", function_name);
+
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        result += arguments[i]->String();
+        if (i != arguments.size() - 1) result += ", ";
+    }
+
+    result += std::format(") {}", body->String());
+    return result;
+}
+
 std::string WhileStatement::String() const {
     std::string result;
     result += "while ";
@@ -4,12 +4,16 @@
 #include <memory>
 #include <vector>
 #include <cstdint>
+#include <limits>
 
 #include "lexer/Lexer.hpp"
 #include "AstVisitor.hpp"
 
 namespace itmoscript {
 
+struct FunctionPrototype;
+class Value;
+
 namespace ast {
 
 struct Node {
@@ -32,15 +36,58 @@ struct Expression : public Node {
     using Node::Node;
 };
 
+/**
+ * @struct Binding
+ * @brief Storage locations an identifier can refer to. Filled by the Resolver.
+ *
+ * @details Whether a name is defined in a block scope is known only at runtime
+ * (an assignment defines the name in the current scope only if no outer scope has it),
+ * so an identifier may have several candidate locations. They are checked in order:
+ * local slots of the current frame, innermost scope first, then the global slot.
+ *
+ * If the last local slot always holds a value (a function parameter or a loop variable),
+ * there is no global fallback and global is kNoGlobal.
+ */
+struct Binding {
+    static constexpr uint32_t kNoGlobal = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> locals;
+    uint32_t global = kNoGlobal;
+
+    /** @brief Checks if the identifier always refers to the last local slot. */
+    bool IsAlwaysLocal() const { return global == kNoGlobal; }
+};
+
+/**
+ * @struct InlineCache
+ * @brief Runtime feedback recorded on the node by the tree-walking Evaluator.
+ *
+ * @details The node remembers the specialization chosen for the operand types it has seen
+ * and the target it resolved to, so the next evaluation with the same types skips the generic
+ * dispatch. If the types change too often, the node falls back to the generic path for good.
+ * The meaning of the fields is private to the Evaluator.
+ */
+struct InlineCache {
+    uint8_t state = 0;
+    uint8_t left_type = 0;
+    uint8_t right_type = 0;
+    uint8_t misses = 0;
+    const void* target = nullptr;
+};
+
 class Program : public Node {
 public:
     using Node::Node;
     const std::vector<std::shared_ptr<Statement>>& GetStatements() const;
+    std::vector<std::shared_ptr<Statement>>& GetStatements();
     void AddStatement(std::shared_ptr<Statement> statement);
 
     std::string String() const override;
     void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
 
+    /** @brief Number of local slots used by the top-level blocks. Filled by the Resolver. */
+    uint32_t frame_size = 0;
+
 private:
     std::vector<std::shared_ptr<Statement>> statements_;
 };
@@ -59,6 +106,8 @@ struct Identifier : public Expression {
     void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
 
     std::string name;
+    Binding binding;
+    InlineCache cache;
 };
 
 struct AssignStatement : public Statement {
@@ -88,6 +137,20 @@ struct ReturnStatement : public Statement {
     std::shared_ptr<Expression> expr;
 };
 
+/**
+ * @struct YieldStatement
+ * @brief `yield` passes the value to the code iterating the generator and suspends the function
+ * until the next value is requested. The function containing it is a generator, see FunctionLiteral::is_generator.
+ */
+struct YieldStatement : public Statement {
+    using Statement::Statement;
+    std::string String() const override;
+    void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
+
+    /** @brief Null for the bare `yield`, which yields nil. */
+    std::shared_ptr<Expression> expr;
+};
+
 struct PrefixExpression : public Expression {
     using Expression::Expression;
     std::string String() const override;
@@ -105,6 +168,37 @@ struct InfixExpression : public Expression {
     TokenType oper;
     std::shared_ptr<Expression> right;
     std::shared_ptr<Expression> left;
+    InlineCache cache;
+};
+
+/**
+ * @struct LogicalExpression
+ * @brief `and` / `or` expression. The right operand is evaluated only
+ * if the left one doesn't decide the result.
+ */
+struct LogicalExpression : public InfixExpression {
+    using InfixExpression::InfixExpression;
+    void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
+};
+
+/**
+ * @struct InvariantExpression
+ * @brief Loop-invariant expression hoisted by the Optimizer. It is evaluated at its first use
+ * in the loop, later uses take the value from a local slot, which is cleared when the loop starts.
+ *
+ * @details Only values of the value types are kept: an evaluation creating a String or a List
+ * is repeated every time. If the loop may modify strings and lists in place, the inputs
+ * are the bindings of the identifiers read by the expression, and the value is kept
+ * only if none of them holds a String or a List either.
+ */
+struct InvariantExpression : public Expression {
+    using Expression::Expression;
+    std::string String() const override;
+    void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
+
+    std::shared_ptr<Expression> expr;
+    uint32_t slot = 0;
+    std::vector<Binding> inputs;
 };
 
 struct IntegerLiteral : public Expression {
@@ -126,6 +220,9 @@ struct StringLiteral : public Expression {
     void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
 
     std::string value;
+
+    /** @brief Interned value of the literal, see ConstantPool. Set at the first evaluation. */
+    std::shared_ptr<const Value> constant;
 };
 
 struct BooleanLiteral : public Expression {
@@ -147,6 +244,18 @@ struct FunctionLiteral : public Expression {
 
     std::vector<std::shared_ptr<Identifier>> parameters;
     std::shared_ptr<BlockStatement> body;
+
+    /** 
+     * @brief Number of local slots of the function frame. Filled by the Resolver.
+     * Parameters occupy the first slots, the body is executed in the function scope itself.
+     */
+    uint32_t frame_size = 0;
+
+    /** @brief The body contains a `yield`: a call returns a Generator instead of executing the body. */
+    bool is_generator = false;
+
+    /** @brief Shared part of the functions created by the literal. Built at the first evaluation. */
+    std::shared_ptr<const FunctionPrototype> prototype;
 };
 
 struct IndexOperatorExpression : public Expression {
@@ -158,6 +267,7 @@ struct IndexOperatorExpression : public Expression {
     std::shared_ptr<Expression> index;
     std::shared_ptr<Expression> second_index;
     bool is_slice = false;
+    InlineCache cache;
 };
 
 struct ListLiteral : public Expression {
@@ -165,18 +275,36 @@ struct ListLiteral : public Expression {
     std::string String() const override;
     void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
 
+    /** @brief Checks if all the elements are number, boolean or nil literals. */
+    bool HasConstantElements() const;
+
     std::vector<std::shared_ptr<Expression>> elements;
+
+    /**
+     * @brief Value of a literal of constants, see ConstantPool. Set at the first evaluation,
+     * stays null if the list is built on every evaluation.
+     */
+    std::shared_ptr<const Value> constant;
+    bool constant_checked = false;
 };
 
 class BlockStatement : public Statement {
 public:
     using Statement::Statement;
     const std::vector<std::shared_ptr<Statement>>& GetStatements() const;
+    std::vector<std::shared_ptr<Statement>>& GetStatements();
     void AddStatement(std::shared_ptr<Statement> statement);
 
     std::string String() const;
     void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
 
+    /**
+     * @brief Local slots [slots_begin, slots_end) of the names defined in this block.
+     * They are cleared when the block is left. Filled by the Resolver.
+     */
+    uint32_t slots_begin = 0;
+    uint32_t slots_end = 0;
+
 private:
     std::vector<std::shared_ptr<Statement>> statements_;
 };
@@ -207,6 +335,28 @@ struct CallExpression : public Expression {
     std::shared_ptr<Expression> function; // Identifier or FunctionLiteral
     std::vector<std::shared_ptr<Expression>> arguments;
     std::optional<std::string> function_name; // Filled if function is an Identifier
+    InlineCache cache;
+};
+
+/**
+ * @struct InlinedCallExpression
+ * @brief Call of a small script function replaced by the Optimizer with the expression the function returns.
+ *
+ * @details The arguments are stored to the local slots [slots_begin, slots_begin + arguments.size())
+ * of the current frame, which the copied body reads instead of the parameters. The slots
+ * [slots_begin, slots_end) take the whole frame of the function and are cleared after the call.
+ * The call is still pushed to the call stack, so stacktrace() and errors show the function.
+ */
+struct InlinedCallExpression : public Expression {
+    using Expression::Expression;
+    std::string String() const override;
+    void Accept(AstVisitor& visitor) override { visitor.Visit(*this); }
+
+    std::string function_name;
+    std::vector<std::shared_ptr<Expression>> arguments;
+    std::shared_ptr<Expression> body;
+    uint32_t slots_begin = 0;
+    uint32_t slots_end = 0;
 };
 
 struct WhileStatement : public Statement {
@@ -216,6 +366,12 @@ struct WhileStatement : public Statement {
 
     std::shared_ptr<Expression> condition;
     std::shared_ptr<BlockStatement> body;
+    /**
+     * @brief Local slots [invariants_begin, invariants_end) of the expressions hoisted from the loop.
+     * They are cleared when the loop starts. Filled by the Optimizer.
+     */
+    uint32_t invariants_begin = 0;
+    uint32_t invariants_end = 0;
 };
 
 struct ForStatement : public Statement {
@@ -226,6 +382,12 @@ struct ForStatement : public Statement {
     std::shared_ptr<Identifier> iter;
     std::shared_ptr<Expression> range;
     std::shared_ptr<BlockStatement> body;
+    /**
+     * @brief Local slots [invariants_begin, invariants_end) of the expressions hoisted from the loop.
+     * They are cleared when the loop starts. Filled by the Optimizer.
+     */
+    uint32_t invariants_begin = 0;
+    uint32_t invariants_end = 0;
 };
 
 struct BreakStatement : public Statement {
@@ -11,8 +11,11 @@ struct Identifier;
 struct AssignStatement;
 struct OperatorAssignStatement;
 struct ReturnStatement;
+struct YieldStatement;
 struct PrefixExpression;
 struct InfixExpression;
+struct LogicalExpression;
+struct InvariantExpression;
 struct IntegerLiteral;
 struct FloatLiteral;
 struct StringLiteral;
@@ -22,6 +25,7 @@ struct BlockStatement;
 struct IfExpression;
 struct FunctionLiteral;
 struct CallExpression;
+struct InlinedCallExpression;
 struct WhileStatement;
 struct ForStatement;
 struct BreakStatement;
@@ -47,6 +51,8 @@ public:
     virtual void Visit(Identifier&) = 0;
     virtual void Visit(PrefixExpression&) = 0;
     virtual void Visit(InfixExpression&) = 0;
+    virtual void Visit(LogicalExpression&) = 0;
+    virtual void Visit(InvariantExpression&) = 0;
     virtual void Visit(IndexOperatorExpression&) = 0;
 
     virtual void Visit(IntegerLiteral&) = 0;
@@ -58,7 +64,9 @@ public:
     virtual void Visit(ListLiteral&) = 0;
     
     virtual void Visit(CallExpression&) = 0;
+    virtual void Visit(InlinedCallExpression&) = 0;
     virtual void Visit(ReturnStatement&) = 0;
+    virtual void Visit(YieldStatement&) = 0;
 
     virtual void Visit(BlockStatement&) = 0;
     virtual void Visit(IfExpression&) = 0;
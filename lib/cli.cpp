@@ -1,5 +1,7 @@
 #include "cli.hpp"
 
+#include <charconv>
+
 namespace itmoscript {
 
 namespace cli {
@@ -11,9 +13,39 @@ std::expected<Parameters, std::string> ParseArguments(const std::vector<std::str
         if (arg == "--lexer" || arg == "-l") {
             config.need_lexer_mode = true;
             config.need_parser_mode = false;
+            config.need_optimizer_mode = false;
         } else if (arg == "--parser" || arg == "-p") {
             config.need_parser_mode = true;
             config.need_lexer_mode = false;
+            config.need_optimizer_mode = false;
+        } else if (arg == "--dump-optimized" || arg == "-o") {
+            config.need_optimizer_mode = true;
+            config.need_lexer_mode = false;
+            config.need_parser_mode = false;
+        } else if (arg == "--tree-walk" || arg == "-t") {
+            config.need_tree_walk = true;
+        } else if (arg.starts_with("--max-depth=")) {
+            std::string_view value = std::string_view{arg}.substr(std::string_view{"--max-depth="}.size());
+            size_t depth = 0;
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), depth);
+
+            if (error != std::errc{} || end != value.data() + value.size() || depth == 0) {
+                return std::unexpected{arg};
+            }
+
+            config.max_call_depth = depth;
+        } else if (arg.starts_with("--buffering=")) {
+            std::string_view value = std::string_view{arg}.substr(std::string_view{"--buffering="}.size());
+
+            if (value == "line") {
+                config.output_buffering = OutputSink::Policy::kLine;
+            } else if (value == "block") {
+                config.output_buffering = OutputSink::Policy::kBlock;
+            } else if (value == "none") {
+                config.output_buffering = OutputSink::Policy::kNone;
+            } else {
+                return std::unexpected{arg};
+            }
         } else if (!arg.starts_with('-')) {
             config.filename = arg;
         } else {
@@ -21,7 +53,7 @@ std::expected<Parameters, std::string> ParseArguments(const std::vector<std::str
         }
     }
 
-    if (config.filename.empty() && !config.need_lexer_mode && !config.need_parser_mode) {
+    if (config.filename.empty() && !config.need_lexer_mode && !config.need_parser_mode && !config.need_optimizer_mode) {
         config.need_repl = true;
     }
 
@@ -3,6 +3,10 @@
 #include <string>
 #include <vector>
 #include <expected>
+#include <optional>
+#include <cstddef>
+
+#include "evaluation/OutputSink.hpp"
 
 namespace itmoscript {
 
@@ -12,6 +16,10 @@ struct Parameters {
     bool need_repl = false;
     bool need_lexer_mode = false;
     bool need_parser_mode = false;
+    bool need_optimizer_mode = false;
+    bool need_tree_walk = false;
+    std::optional<size_t> max_call_depth;
+    std::optional<OutputSink::Policy> output_buffering;
     std::string filename;
     bool need_help = false;
 };
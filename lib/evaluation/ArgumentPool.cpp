@@ -0,0 +1,24 @@
+#include "ArgumentPool.hpp"
+
+namespace itmoscript {
+
+ArgumentPool::Lease ArgumentPool::Acquire() {
+    if (used_ == buffers_.size()) {
+        buffers_.emplace_back();
+    }
+
+    return Lease{*this, buffers_[used_++]};
+}
+
+void ArgumentPool::ClearBorrowed() {
+    for (size_t i = 0; i < used_; ++i) {
+        buffers_[i].clear();
+    }
+}
+
+void ArgumentPool::Release(std::vector<Value>& buffer) {
+    buffer.clear();
+    --used_;
+}
+
+} // namespace itmoscript
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+#include "objects/Value.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class ArgumentPool
+ * @brief Reusable buffers for the arguments of function calls.
+ * 
+ * @details Arguments of nested calls are collected at the same time
+ * (e.g. f(g(x))), so every call borrows its own buffer for the time of the call.
+ * Buffers are returned in the reverse order and keep their capacity,
+ * so the calls don't allocate once the pool has grown to the deepest nesting.
+ * 
+ * @example
+ * ```
+ * ArgumentPool::Lease args = pool.Acquire();
+ * args->push_back(Int{1});
+ * Call(*args);
+ * ```
+ */
+class ArgumentPool {
+public:
+    /** @brief Borrowed buffer. It's cleared and returned to the pool on destruction. */
+    class Lease {
+    public:
+        Lease(ArgumentPool& pool, std::vector<Value>& buffer)
+            : pool_(pool), buffer_(buffer) {}
+
+        Lease(const Lease&) = delete;
+        Lease(Lease&&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() { pool_.Release(buffer_); }
+
+        std::vector<Value>& operator*() { return buffer_; }
+        std::vector<Value>* operator->() { return &buffer_; }
+
+    private:
+        ArgumentPool& pool_;
+        std::vector<Value>& buffer_;
+    };
+
+    ArgumentPool() = default;
+
+    ArgumentPool(const ArgumentPool&) = delete;
+    ArgumentPool(ArgumentPool&&) = delete;
+    ArgumentPool& operator=(const ArgumentPool&) = delete;
+    ArgumentPool& operator=(ArgumentPool&&) = delete;
+    ~ArgumentPool() = default;
+
+    /** @brief Borrows an empty buffer. */
+    Lease Acquire();
+
+    /** @brief Calls the function for every value in the borrowed buffers. */
+    template<typename F>
+    void ForEachValue(F&& func) const {
+        for (size_t i = 0; i < used_; ++i) {
+            for (const Value& value : buffers_[i]) {
+                func(value);
+            }
+        }
+    }
+
+    /** @brief Destroys the values in the borrowed buffers, they stay borrowed. */
+    void ClearBorrowed();
+
+private:
+    /** @brief Buffers [0, used_) are borrowed. Deque keeps them in place when it grows. */
+    std::deque<std::vector<Value>> buffers_;
+    size_t used_ = 0;
+
+    void Release(std::vector<Value>& buffer);
+};
+
+} // namespace itmoscript
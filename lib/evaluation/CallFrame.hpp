@@ -5,16 +5,21 @@
 #include <cstddef>
 #include <vector>
 
+#include "lexer/Token.hpp"
+
 namespace itmoscript {
 
 /**
  * @struct CallFrame
  * @brief Represents the current call frame, used for stacktrace printing
  * and debugging. Contains the function name and the entry token (position of the call).
+ * 
+ * @details The frame doesn't own its data: both pointers refer to the AST or the compiled code
+ * being executed, which outlive the call. Exceptions copy what they need when thrown.
  */
 struct CallFrame {
-    std::string function_name;
-    Token entry_token;
+    const std::string* function_name;
+    const Token* entry_token;
 };
 
 using CallStack = std::vector<CallFrame>;
@@ -0,0 +1,22 @@
+#include "ConstantPool.hpp"
+
+namespace itmoscript {
+
+std::shared_ptr<const Value> ConstantPool::InternString(const std::string& text) {
+    if (auto it = strings_.find(text); it != strings_.end()) {
+        return it->second;
+    }
+
+    String string = CreateString(text);
+    string->Freeze();
+
+    std::shared_ptr<const Value> constant = Add(std::move(string));
+    strings_.emplace(text, constant);
+    return constant;
+}
+
+std::shared_ptr<const Value> ConstantPool::Add(Value value) {
+    return std::make_shared<const Value>(std::move(value));
+}
+
+} // namespace itmoscript
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "objects/Value.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class ConstantPool
+ * @brief Values of the program literals, built once instead of on every evaluation.
+ * 
+ * @details The values are owned by the literal nodes, so they are freed together with the program
+ * (e.g. a line of the REPL), while the functions it defined still keep their bodies' constants.
+ * The pool only interns the strings of the program being evaluated and is cleared before the next one.
+ * 
+ * String literals are interned: all the literals with the same text share one frozen String.
+ * Strings are modified in place by assignments, so a frozen String is thawed (see Value::Thaw())
+ * before it is stored to a variable or to a list, and the constant itself never changes.
+ * 
+ * List literals of numbers, booleans and nils are stored as lists. Every evaluation
+ * of such literal copies the constant, which shares its elements until the first write.
+ */
+class ConstantPool {
+public:
+    /** @brief Returns the frozen String with the given text, creating it if needed. */
+    std::shared_ptr<const Value> InternString(const std::string& text);
+
+    /** @brief Makes the value a constant. */
+    std::shared_ptr<const Value> Add(Value value);
+
+    /** @brief Forgets the interned strings, the literals keep their values. */
+    void Clear() { strings_.clear(); }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const Value>> strings_;
+};
+
+} // namespace itmoscript
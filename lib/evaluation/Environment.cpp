@@ -1,36 +1,31 @@
 #include "Environment.hpp"
-#include "objects/Value.hpp"
 
 namespace itmoscript {
 
-bool Environment::Has(const std::string& name) const {
-    return storage_.contains(name) || (parent_ != nullptr && parent_->Has(name));
+Value* Environment::Find(uint32_t slot) {
+    std::optional<Value>& value = slots_[slot];
+    return value.has_value() ? &*value : nullptr;
 }
 
-const Value& Environment::Get(const std::string& name) const {
-    if (storage_.contains(name)) {
-        return storage_.at(name);
-    } else {
-        return parent_->Get(name);
-    }
+void Environment::Set(uint32_t slot, Value value) {
+    slots_[slot] = std::move(value);
 }
 
-void Environment::Set(const std::string& name, Value value) {
-    if (storage_.contains(name)) {
-        storage_[name] = std::move(value);
-    } else if (parent_ != nullptr && parent_->Has(name)) {
-        parent_->Set(name, std::move(value));
-    } else {
-        storage_[name] = std::move(value);
+void Environment::Clear(uint32_t begin, uint32_t end) {
+    for (uint32_t slot = begin; slot < end; ++slot) {
+        slots_[slot].reset();
     }
 }
 
-void Environment::SetInLocal(const std::string& name, Value value) {
-    storage_[name] = std::move(value);
+void Environment::Reset(size_t size) {
+    slots_.clear();
+    slots_.resize(size);
 }
 
-bool Environment::IsInLocal(const std::string& name) const {
-    return storage_.contains(name);
+void Environment::Reserve(size_t size) {
+    if (size > slots_.size()) {
+        slots_.resize(size);
+    }
 }
 
 } // namespace itmoscript
@@ -1,28 +1,28 @@
 #pragma once
 
-#include <unordered_map>
-#include <string>
+#include <vector>
 #include <optional>
-#include <memory>
+#include <cstdint>
 
-namespace itmoscript {
+#include "objects/Value.hpp"
 
-class Value;
+namespace itmoscript {
 
 /**
  * @class Environment
- * @brief Holds the current scope's variable and their values.
- * Also has a link to the parent (outer) scope to be able to search for
- * the identifiers there and change their values.
+ * @brief Holds the variables of a single frame (a function call, the top-level program
+ * or the global scope) as a flat array of slots.
+ * 
+ * @details Slots are assigned to names at compile time by the Resolver,
+ * so no name lookup happens at runtime. A slot is either defined or not:
+ * block scopes share the frame of the enclosing function and forget their slots
+ * when they are left.
  */
 class Environment {
 public:
-    /**
-     * @brief Constructs the environment object with a link to the parent.
-     * For the global scope parent == nullptr.
-     */
-    explicit Environment(std::shared_ptr<Environment> parent)
-        : parent_(std::move(parent)) {}
+    /** @brief Constructs the environment with the given number of undefined slots. */
+    explicit Environment(size_t size = 0)
+        : slots_(size) {}
 
     Environment(const Environment&) = delete;
     Environment(Environment&&) = default;
@@ -30,44 +30,47 @@ public:
     Environment& operator=(Environment&&) = default;
     ~Environment() = default;
 
-    /**
-     * @brief Checks if name is registered in the current scope or 
-     * in any of parent scopes.
-     */
-    bool Has(const std::string& name) const;
+    /** @brief Checks if the slot holds a value. */
+    bool Has(uint32_t slot) const { return slots_[slot].has_value(); }
 
     /**
-     * @brief Returns value associated with the given name if it exists in the current scope.
-     * Otherwise, goes up in the scope chain and searches there.
-     * 
-     * The caller must be sure that the name exists, always call Has() before using Get().
+     * @brief Returns the value of the slot.
+     * The caller must be sure that the slot is defined, always call Has() before using Get().
      */
-    const Value& Get(const std::string& name) const;
+    const Value& Get(uint32_t slot) const { return *slots_[slot]; }
 
-    /**
-     * @brief Assigns the identifier to the given value.
-     * @details If it's registered in the current scope, assigns in the current scope.
-     * Otherwise, goes up until it founds the identifier.
-     * 
-     * If the identifier is not found in the scope chain, registers it in the current scope.
-     */
-    void Set(const std::string& name, Value value);
+    /** @brief Returns pointer to the value of the slot, nullptr if the slot is undefined. */
+    Value* Find(uint32_t slot);
 
-    /**
-     * @brief Assigns the identifier to the given value in the current scope,
-     * not going up in the scope chain.
-     */
-    void SetInLocal(const std::string& name, Value value);
+    /** @brief Assigns the value to the slot, defining it if needed. */
+    void Set(uint32_t slot, Value value);
+
+    /** @brief Makes slots [begin, end) undefined, destroying their values. */
+    void Clear(uint32_t begin, uint32_t end);
 
     /**
-     * @brief Checks if name is registered in the current scope,
-     * not going up in the scope chain.
+     * @brief Makes the environment hold the given number of undefined slots.
+     * The storage is reused, so it doesn't allocate unless the environment grows.
      */
-    bool IsInLocal(const std::string& name) const;
+    void Reset(size_t size);
+
+    /** @brief Grows the environment up to the given number of slots. Existing slots are kept. */
+    void Reserve(size_t size);
+
+    size_t size() const { return slots_.size(); }
+
+    /** @brief Calls the function for the value of every defined slot. */
+    template<typename F>
+    void ForEachValue(F&& func) const {
+        for (const std::optional<Value>& slot : slots_) {
+            if (slot.has_value()) {
+                func(*slot);
+            }
+        }
+    }
 
 private:
-    std::unordered_map<std::string, Value> storage_;
-    std::shared_ptr<Environment> parent_;
+    std::vector<std::optional<Value>> slots_;
 };
 
 } // namespace itmoscript
@@ -1,10 +1,14 @@
 #include "Evaluator.hpp"
+#include "Optimizer.hpp"
+#include "NativeStack.hpp"
+#include "PurityAnalyzer.hpp"
+#include "TreeWalkGenerator.hpp"
 #include "utils.hpp"
+#include "objects/Iteration.hpp"
 
 #include "exceptions/OperatorTypeError.hpp"
 #include "exceptions/UndefinedNameError.hpp"
 #include "exceptions/ParametersCountError.hpp"
-#include "exceptions/DuplicateParameterError.hpp"
 #include "exceptions/IndexOperandTypeError.hpp"
 #include "exceptions/IndexTypeError.hpp"
 #include "exceptions/IndexOutOfRangeError.hpp"
@@ -15,25 +19,80 @@
 #include "exceptions/UncallableObjectCallError.hpp"
 #include "exceptions/StandardOverrideError.hpp"
 #include "exceptions/ImmutableAssignmentError.hpp"
+#include "exceptions/RecursionDepthError.hpp"
+#include "exceptions/ImpureFunctionError.hpp"
+#include "stdlib/exceptions/InvalidArgumentError.hpp"
 
 #include <format>
 #include <cmath>
-#include <set>
 #include <algorithm>
 #include <limits>
 
 namespace itmoscript {
 
-Evaluator::Evaluator() {
+namespace {
+
+const Token kNoToken{};
+const std::string kAnonymousFunctionName = "<anonymous function>";
+
+/** @brief Checks if the operator on two numbers of the same type is computed without the dispatch. */
+bool IsInlinedNumericOper(TokenType oper) {
+    switch (oper) {
+        case TokenType::kPlus:
+        case TokenType::kMinus:
+        case TokenType::kAsterisk:
+        case TokenType::kEqual:
+        case TokenType::kNotEqual:
+        case TokenType::kLess:
+        case TokenType::kLessOrEqual:
+        case TokenType::kGreater:
+        case TokenType::kGreaterOrEqual:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** @brief Computes the operator the same way the standard handler does. */
+template<NumericValueType T>
+Value ApplyNumericOper(TokenType oper, T left, T right) {
+    switch (oper) {
+        case TokenType::kPlus: return left + right;
+        case TokenType::kMinus: return left - right;
+        case TokenType::kAsterisk: return left * right;
+        case TokenType::kEqual: return left == right;
+        case TokenType::kNotEqual: return left != right;
+        case TokenType::kLess: return left < right;
+        case TokenType::kLessOrEqual: return left <= right;
+        case TokenType::kGreater: return left > right;
+        case TokenType::kGreaterOrEqual: return left >= right;
+        default: std::unreachable();
+    }
+}
+
+uint8_t ToCacheType(ValueType type) {
+    return static_cast<uint8_t>(type);
+}
+
+} // namespace
+
+Evaluator::Evaluator()
+    : current_token_(&kNoToken) {
     RegisterTypeConversions();
-    env_stack_.emplace_back(std::make_shared<Environment>(nullptr));
+    env_stack_.Push(0);
 }
 
 void Evaluator::Evaluate(ast::Program& root, std::istream& input, std::ostream& output) {
+    OutputSink::Scope output_scope{output_sink_, input, output};
     input_ = &input;
-    output_ = &output;
+    output_ = &output_scope.stream();
     call_stack_.clear();
-    last_exec_result_ = Eval(root);
+    PrepareProgram(root);
+    inside_loop_ = false;
+
+    // every script call nests several C++ calls, so deep recursion needs a bigger stack than the caller's
+    NativeStack::Run(NativeStack::kDefaultSize, [this, &root] { last_exec_result_ = Eval(root); });
+    current_token_ = &kNoToken;
 }
 
 void Evaluator::EnableStandardOperators() {
@@ -41,16 +100,31 @@ void Evaluator::EnableStandardOperators() {
     RegisterUnaryOps();
     RegisterComparisonOps();
     RegisterStringOps();
-    RegisterLogicalOps();
     RegisterListOps();
+
+    operator_registry_.RegisterPromotions(type_convertion_system_);
 }
 
 void Evaluator::EnableStd() {
     std_lib_.LoadDefault();
+
+    // the purity of the function depends on the globals, so memoize() is a part of the Evaluator
+    std_lib_.Register("memoize", [this](std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+        return Memoize(args, from, call_stack);
+    });
+}
+
+void Evaluator::EnableOptimizer(bool propagate_constants) {
+    optimize_ = true;
+    propagate_constants_ = propagate_constants;
+}
+
+void Evaluator::Optimize(ast::Program& program) {
+    PrepareProgram(program);
 }
 
 std::optional<Value> Evaluator::HandleUnaryOper(TokenType oper, const Value& right) {
-    if (auto handler = operator_registry_.FindExactHandler(oper, right.GetType())) {
+    if (const auto* handler = operator_registry_.FindHandler(oper, right.GetType())) {
         return std::invoke(*handler, right);
     }
 
@@ -58,46 +132,335 @@ std::optional<Value> Evaluator::HandleUnaryOper(TokenType oper, const Value& rig
 }
 
 std::optional<Value> Evaluator::HandleBinaryOper(TokenType oper, const Value& left, const Value& right) {
-    if (auto handler = operator_registry_.FindExactHandler(oper, left.GetType(), right.GetType())) {
-        return std::invoke(*handler, left, right);
+    const OperatorRegistry::BinaryDispatch& entry = operator_registry_.FindHandler(oper, left.GetType(), right.GetType());
+
+    if (entry.handler == nullptr) {
+        return std::nullopt;
     }
 
-    if (auto common = type_convertion_system_.FindCommonType(left.GetType(), right.GetType())) {
-        auto lhs = type_convertion_system_.TryConvert(left, *common);
-        auto rhs = type_convertion_system_.TryConvert(right, *common);
+    return InvokeBinaryDispatch(entry, left, right);
+}
+
+Value Evaluator::InvokeBinaryDispatch(
+    const OperatorRegistry::BinaryDispatch& entry, 
+    const Value& left, 
+    const Value& right
+) {
+    if (!entry.IsPromoted()) {
+        return std::invoke(*entry.handler, left, right);
+    }
 
-        if (lhs && rhs) {
-            if (auto handler = operator_registry_.FindExactHandler(oper, *common, *common)) {
-                return std::invoke(*handler, *lhs, *rhs);
+    // operands are converted to the common type of the handler
+    if (entry.convert_left == nullptr) {
+        return std::invoke(*entry.handler, left, std::invoke(*entry.convert_right, right));
+    } else if (entry.convert_right == nullptr) {
+        return std::invoke(*entry.handler, std::invoke(*entry.convert_left, left), right);
+    }
+
+    return std::invoke(
+        *entry.handler,
+        std::invoke(*entry.convert_left, left),
+        std::invoke(*entry.convert_right, right)
+    );
+}
+
+Value Evaluator::EvalInfixOper(ast::InfixExpression& node, const Value& left, const Value& right) {
+    ast::InlineCache& cache = node.cache;
+    ValueType left_type = left.GetType();
+    ValueType right_type = right.GetType();
+
+    if (cache.left_type == ToCacheType(left_type) && cache.right_type == ToCacheType(right_type)) {
+        switch (static_cast<Specialization>(cache.state)) {
+            case Specialization::kIntOper:
+                return ApplyNumericOper(node.oper, left.Get<Int>(), right.Get<Int>());
+            case Specialization::kFloatOper:
+                return ApplyNumericOper(node.oper, left.Get<Float>(), right.Get<Float>());
+            case Specialization::kDispatch:
+                return InvokeBinaryDispatch(
+                    *static_cast<const OperatorRegistry::BinaryDispatch*>(cache.target), 
+                    left, 
+                    right
+                );
+            default:
+                break;
+        }
+    }
+
+    const OperatorRegistry::BinaryDispatch& entry = operator_registry_.FindHandler(node.oper, left_type, right_type);
+
+    if (entry.handler == nullptr) {
+        ThrowRuntimeError<lang_exceptions::OperatorTypeError>(kTokenTypeNames.at(node.oper), left_type, right_type);
+    }
+
+    if (RecordCacheMiss(cache, left_type, right_type)) {
+        Specialization kind = Specialization::kDispatch;
+
+        if (left_type == right_type && IsInlinedNumericOper(node.oper)) {
+            if (left_type == ValueType::kInt) {
+                kind = Specialization::kIntOper;
+            } else if (left_type == ValueType::kFloat) {
+                kind = Specialization::kFloatOper;
             }
         }
+
+        cache.state = static_cast<uint8_t>(kind);
+        cache.target = &entry;
     }
 
-    return std::nullopt;
+    return InvokeBinaryDispatch(entry, left, right);
+}
+
+bool Evaluator::RecordCacheMiss(ast::InlineCache& cache, ValueType left, ValueType right) const {
+    auto state = static_cast<Specialization>(cache.state);
+
+    if (state == Specialization::kMegamorphic) {
+        return false;
+    }
+
+    if (state != Specialization::kUninitialized && ++cache.misses > kMaxCacheMisses) {
+        // the types never match the guard again
+        cache = ast::InlineCache{.state = static_cast<uint8_t>(Specialization::kMegamorphic)};
+        cache.left_type = cache.right_type = std::numeric_limits<uint8_t>::max();
+        return false;
+    }
+
+    cache.left_type = ToCacheType(left);
+    cache.right_type = ToCacheType(right);
+    return true;
 }
 
 Environment& Evaluator::env() {
-    return *env_stack_.back();
+    return env_stack_.top();
+}
+
+void Evaluator::PrepareProgram(ast::Program& program) {
+    Resolver resolver{global_slots_};
+    resolver.Resolve(program);
+    defined_globals_.insert(resolver.defined_globals().begin(), resolver.defined_globals().end());
+
+    if (optimize_) {
+        Optimizer optimizer{*this};
+        optimizer.Optimize(program, propagate_constants_ ? &resolver : nullptr);
+    }
+
+    // the literals of the previous programs keep their constants, the new ones aren't shared with them
+    constants_.Clear();
+
+    globals_.Reserve(global_slots_.size());
+    env_stack_.Truncate(0);
+    env_stack_.Push(program.frame_size);
+}
+
+void Evaluator::EnterFunctionFrame(const Function& func, std::vector<Value>& args) {
+    Environment& frame = env_stack_.Push(func.frame_size());
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        args[i].Thaw();
+        frame.Set(static_cast<uint32_t>(i), std::move(args[i]));
+    }
+}
+
+void Evaluator::CheckCallDepth() const {
+    if (call_stack_.size() >= max_call_depth_ || NativeStack::IsExhausted()) {
+        ThrowRuntimeError<lang_exceptions::RecursionDepthError>(call_stack_.size());
+    }
+}
+
+Value Evaluator::Memoize(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    if (args.empty() || args.size() > 2) {
+        throw lang_exceptions::ParametersCountError{from, call_stack, "memoize", 1, args.size()};
+    }
+
+    stdlib::AssertType<Function>(args[0], 0, from, call_stack);
+    size_t capacity = MemoTable::kDefaultCapacity;
+
+    if (args.size() == 2) {
+        stdlib::AssertType<Int>(args[1], 1, from, call_stack);
+
+        if (args[1].Get<Int>() <= 0) {
+            stdlib::ThrowError<lang_exceptions::InvalidArgumentError>(
+                from,
+                call_stack,
+                1uz,
+                "capacity in memoize() must be positive"
+            );
+        }
+
+        capacity = static_cast<size_t>(args[1].Get<Int>());
+    }
+
+    const Function& func = args[0].Get<Function>();
+    PurityAnalyzer analyzer{std_lib_, defined_globals_};
+
+    if (!analyzer.Analyze(*func.body())) {
+        throw lang_exceptions::ImpureFunctionError{
+            from,
+            call_stack,
+            "function passed to memoize() is not pure: it uses globals, makes I/O or calls a function it got"
+        };
+    }
+
+    auto memo = std::make_shared<MemoTable>(capacity);
+
+    for (const PurityAnalyzer::Callee& callee : analyzer.callees()) {
+        memo->unchecked_callees.push_back(MemoTable::Callee{.name = *callee.name, .global = callee.global});
+    }
+
+    return Function{func.shared_prototype(), std::move(memo)};
+}
+
+std::optional<bool> Evaluator::IsPure(const Function& func, std::unordered_set<const FunctionPrototype*>& checked) {
+    // a memoized function is checked by memoize() and by its own calls
+    if (func.memo() != nullptr || !checked.insert(&func.prototype()).second) {
+        return true;
+    }
+
+    PurityAnalyzer analyzer{std_lib_, defined_globals_};
+
+    if (!analyzer.Analyze(*func.body())) {
+        return false;
+    }
+
+    bool known = true;
+
+    for (const PurityAnalyzer::Callee& callee : analyzer.callees()) {
+        const Value* value = globals_.Find(callee.global);
+
+        if (value == nullptr || !value->IsOfType<Function>()) {
+            known = false;
+            continue;
+        }
+
+        std::optional<bool> pure = IsPure(value->Get<Function>(), checked);
+
+        if (pure == false) {
+            return false;
+        }
+
+        known = known && pure.has_value();
+    }
+
+    return known ? std::optional<bool>{true} : std::nullopt;
+}
+
+bool Evaluator::CheckMemoizedCallees(MemoTable& memo) {
+    std::unordered_set<const FunctionPrototype*> checked;
+
+    std::erase_if(memo.unchecked_callees, [this, &checked](const MemoTable::Callee& callee) {
+        const Value* value = globals_.Find(callee.global);
+
+        if (value == nullptr || !value->IsOfType<Function>()) {
+            return false;
+        }
+
+        std::optional<bool> pure = IsPure(value->Get<Function>(), checked);
+
+        if (pure == false) {
+            ThrowRuntimeError<lang_exceptions::ImpureFunctionError>(
+                std::format("memoized function calls '{}', which is not pure", callee.name)
+            );
+        }
+
+        return pure.has_value();
+    });
+
+    return memo.unchecked_callees.empty();
 }
 
-void Evaluator::PushEnv() {
-    env_stack_.emplace_back(std::make_shared<Environment>(env_stack_.back()));
+std::optional<Value> Evaluator::FindMemoized(
+    const Function& func,
+    std::span<Value> args,
+    std::vector<PendingMemo>& pending
+) {
+    const std::shared_ptr<MemoTable>& memo = func.memo();
+
+    if (!MemoTable::IsHashable(args) || (!memo->unchecked_callees.empty() && !CheckMemoizedCallees(*memo))) {
+        return std::nullopt;
+    }
+
+    if (std::optional<Value> result = memo->Find(args)) {
+        return result;
+    }
+
+    pending.push_back(PendingMemo{.table = memo, .key = MemoTable::MakeKey(args)});
+
+    for (Value& arg : args) {
+        if (arg.IsOfType<String>()) {
+            arg = arg.GetCopy();
+        }
+    }
+
+    return std::nullopt;
 }
 
-void Evaluator::PopEnv() {
-    env_stack_.pop_back();
+void Evaluator::StoreMemoized(std::vector<PendingMemo>& pending, const Value& result) {
+    for (PendingMemo& memo : pending) {
+        memo.table->Insert(std::move(memo.key), result);
+    }
+
+    pending.clear();
 }
 
-void Evaluator::EnterFunctionScope() {
-    env_stack_.emplace_back(std::make_shared<Environment>(env_stack_.front()));
+void Evaluator::LeaveFunctionFrame() {
+    env_stack_.Pop();
 }
 
-void Evaluator::LeaveFunctionScope() {
-    PopEnv();
+Value* Evaluator::FindVariable(const ast::Binding& binding) {
+    for (uint32_t slot : binding.locals) {
+        if (Value* value = env().Find(slot)) {
+            return value;
+        }
+    }
+
+    if (binding.global != ast::Binding::kNoGlobal) {
+        return globals_.Find(binding.global);
+    }
+
+    return nullptr;
+}
+
+Value* Evaluator::FindVariable(ast::Identifier& ident) {
+    // a name is defined in at most one of its candidate slots at a time,
+    // so the slot found by the previous lookup is checked first
+    const ast::Binding& binding = ident.binding;
+    ast::InlineCache& cache = ident.cache;
+
+    if (cache.state != 0) {
+        size_t candidate = cache.state - 1;
+        Value* value = candidate < binding.locals.size() 
+            ? env().Find(binding.locals[candidate]) 
+            : globals_.Find(binding.global);
+
+        if (value != nullptr) {
+            return value;
+        }
+    }
+
+    for (size_t i = 0; i < binding.locals.size(); ++i) {
+        if (Value* value = env().Find(binding.locals[i])) {
+            if (i < std::numeric_limits<uint8_t>::max()) {
+                cache.state = static_cast<uint8_t>(i + 1);
+            }
+
+            return value;
+        }
+    }
+
+    if (binding.global == ast::Binding::kNoGlobal) {
+        return nullptr;
+    }
+
+    Value* value = globals_.Find(binding.global);
+
+    if (value != nullptr && binding.locals.size() < std::numeric_limits<uint8_t>::max()) {
+        cache.state = static_cast<uint8_t>(binding.locals.size() + 1);
+    }
+
+    return value;
 }
 
 const Evaluator::ExecResult& Evaluator::Eval(ast::Node& node) {
-    current_token_ = node.token;
+    current_token_ = &node.token;
     node.Accept(*this);
     return last_exec_result_;
 }
@@ -106,38 +469,58 @@ const Value& Evaluator::GetLastEvaluatedValue() const {
     return last_exec_result_.value;
 }
 
-const Value& Evaluator::ResolveIdentifier(const ast::Identifier& ident) {
-    if (!env().Has(ident.name)) {
-        if (std_lib_.Has(ident.name)) {
-            ThrowRuntimeError<lang_exceptions::StandardFunctionNoCallError>(ident.token);
+const Value& Evaluator::ResolveIdentifier(ast::Identifier& ident) {
+    if (Value* value = FindVariable(ident)) {
+        return *value;
+    }
+
+    return ResolveIdentifier(ident.name, ident.binding, ident.token);
+}
+
+const Value& Evaluator::ResolveIdentifier(const std::string& name, const ast::Binding& binding, const Token& token) {
+    Value* value = FindVariable(binding);
+
+    if (value == nullptr) {
+        if (std_lib_.Has(name)) {
+            ThrowRuntimeError<lang_exceptions::StandardFunctionNoCallError>(token);
         } else {
-            ThrowRuntimeError<lang_exceptions::UndefinedNameError>(ident.token);
+            ThrowRuntimeError<lang_exceptions::UndefinedNameError>(token);
         }
     }
 
-    return env().Get(ident.name);
+    return *value;
 }
 
-void Evaluator::AssignIdentifier(const std::string& name, Value value) {
-    if (env().Has(name) && env().Get(name).IsOfType<Function>()) {
-        ThrowRuntimeError<lang_exceptions::ImmutableAssignmentError>(
-            name, GetType<Function>()
-        );
-    }
+void Evaluator::AssignIdentifier(const std::string& name, const ast::Binding& binding, Value value) {
+    value.Thaw();
 
-    env().Set(name, std::move(value));
+    if (Value* existing = FindVariable(binding)) {
+        if (existing->IsOfType<Function>()) {
+            ThrowRuntimeError<lang_exceptions::ImmutableAssignmentError>(
+                name, GetType<Function>()
+            );
+        }
+
+        *existing = std::move(value);
+    } else if (!binding.locals.empty()) {
+        env().Set(binding.locals.front(), std::move(value));
+    } else {
+        globals_.Set(binding.global, std::move(value));
+    }
 }
 
 
-void Evaluator::AssignIdentifierWithCopy(const std::string& name, Value value) {
-    if (!value.IsReferenceType() || !env().Has(name)) {
-        AssignIdentifier(name, std::move(value));
+void Evaluator::AssignIdentifierWithCopy(const std::string& name, const ast::Binding& binding, Value value) {
+    Value* existing = FindVariable(binding);
+
+    if (!value.IsReferenceType() || existing == nullptr) {
+        AssignIdentifier(name, binding, std::move(value));
         return;
     }
 
-    Value env_val = env().Get(name);
+    Value env_val = *existing;
     if (env_val.GetType() != value.GetType()) {
-        AssignIdentifier(name, std::move(value));
+        AssignIdentifier(name, binding, std::move(value));
         return;
     }
 
@@ -145,14 +528,15 @@ void Evaluator::AssignIdentifierWithCopy(const std::string& name, Value value) {
         *env_val.Get<List>() = std::move(*value.GetCopy().Get<List>());
     } else if (value.IsOfType<String>()) {
         *env_val.Get<String>() = std::move(*value.GetCopy().Get<String>());
-    } else if (value.IsOfType<Function>()) {
-        AssignIdentifier(name, std::move(value));
+    } else {
+        // functions and generators can't be copied, the handle is assigned
+        AssignIdentifier(name, binding, std::move(value));
     }
 }
 
 void Evaluator::Visit(ast::Program& program) {
     for (const auto& stmt : program.GetStatements()) {
-        current_token_ = program.token;
+        current_token_ = &program.token;
         stmt->Accept(*this);
     }
 }
@@ -178,7 +562,11 @@ void Evaluator::Visit(ast::FloatLiteral& node) {
 }
 
 void Evaluator::Visit(ast::StringLiteral& node) {
-    last_exec_result_.value = CreateString(node.value);
+    if (node.constant == nullptr) {
+        node.constant = constants_.InternString(node.value);
+    }
+
+    last_exec_result_.value = *node.constant;
     last_exec_result_.control = ControlFlowState::kNormal;
 }
 
@@ -194,10 +582,10 @@ void Evaluator::Visit(ast::AssignStatement& stmt) {
 
     Eval(*stmt.expr);
 
-    if (!env().Has(stmt.ident->name) || dynamic_cast<ast::Identifier*>(stmt.expr.get())) {
-        AssignIdentifier(stmt.ident->name, last_exec_result_.value);
+    if (FindVariable(stmt.ident->binding) == nullptr || dynamic_cast<ast::Identifier*>(stmt.expr.get())) {
+        AssignIdentifier(stmt.ident->name, stmt.ident->binding, last_exec_result_.value);
     } else {
-        AssignIdentifierWithCopy(stmt.ident->name, last_exec_result_.value);
+        AssignIdentifierWithCopy(stmt.ident->name, stmt.ident->binding, last_exec_result_.value);
     }
 }
 
@@ -211,7 +599,7 @@ void Evaluator::Visit(ast::OperatorAssignStatement& stmt) {
 
     if (auto new_value = HandleBinaryOper(kCompoundAssignOperators.at(stmt.oper), ident_value, right_res.value)) {
         last_exec_result_.value = *new_value;
-        AssignIdentifier(stmt.ident->name, last_exec_result_.value);
+        AssignIdentifier(stmt.ident->name, stmt.ident->binding, last_exec_result_.value);
     } else {
         ThrowRuntimeError<lang_exceptions::OperatorTypeError>(
             kTokenTypeNames.at(stmt.oper),
@@ -222,24 +610,40 @@ void Evaluator::Visit(ast::OperatorAssignStatement& stmt) {
 }
 
 void Evaluator::Visit(ast::CallExpression& expr) {
-    std::vector<Value> args;
-    args.reserve(expr.arguments.size());
+    ArgumentPool::Lease args = arguments_->Acquire();
     
     for (auto& arg : expr.arguments) {
-        args.push_back(Eval(*arg).value);
+        args->push_back(Eval(*arg).value);
+    }
+
+    if (expr.cache.state == static_cast<uint8_t>(Specialization::kUninitialized)) {
+        SpecializeCall(expr);
     }
 
-    if (expr.function_name && !env().Has(*expr.function_name)) {
-        if (std_lib_.HasOutStreamHandlingFunc(*expr.function_name)) {
-            CallOutStreamLibraryFunction(*expr.function_name, args);
+    switch (static_cast<Specialization>(expr.cache.state)) {
+        case Specialization::kValueBuiltin:
+            last_exec_result_.value = std::invoke(
+                *static_cast<const stdlib::ValueHandlingFunction*>(expr.cache.target),
+                *args, *current_token_, call_stack_
+            );
+            last_exec_result_.control = ControlFlowState::kNormal;
             return;
-        } else if (std_lib_.HasInStreamHandlingFunc(*expr.function_name)) {
-            CallInStreamLibraryFunction(*expr.function_name, args);
+        case Specialization::kOutStreamBuiltin:
+            last_exec_result_.value = std::invoke(
+                *static_cast<const stdlib::OutStreamHandlingFunction*>(expr.cache.target),
+                *output_, *args, *current_token_, call_stack_
+            );
+            last_exec_result_.control = ControlFlowState::kNormal;
             return;
-        } else if (std_lib_.HasValueHandlingFunc(*expr.function_name)) {
-            CallLibraryFunction(*expr.function_name, args);
+        case Specialization::kInStreamBuiltin:
+            last_exec_result_.value = std::invoke(
+                *static_cast<const stdlib::InStreamHandlingFunction*>(expr.cache.target),
+                *input_, *args, *current_token_, call_stack_
+            );
+            last_exec_result_.control = ControlFlowState::kNormal;
             return;
-        }
+        default:
+            break;
     }
 
     ExecResult func_result = Eval(*expr.function);
@@ -249,11 +653,84 @@ void Evaluator::Visit(ast::CallExpression& expr) {
 
     const Function& func = func_result.value.Get<Function>();
 
-    last_exec_result_.value = CallFunction(GetFunctionName(expr.function_name), func, args);
+    last_exec_result_.value = CallFunction(GetFunctionName(expr.function_name), func, *args);
     last_exec_result_.control = ControlFlowState::kNormal;
 }
 
-Value Evaluator::CallFunction(std::string name, const Function& func, std::vector<Value>& args) {
+void Evaluator::Visit(ast::InlinedCallExpression& expr) {
+    for (size_t i = 0; i < expr.arguments.size(); ++i) {
+        Value arg = Eval(*expr.arguments[i]).value;
+        arg.Thaw();
+        env().Set(expr.slots_begin + static_cast<uint32_t>(i), std::move(arg));
+    }
+
+    current_token_ = &expr.token;
+    call_stack_.push_back(CallFrame{.function_name = &expr.function_name, .entry_token = current_token_});
+
+    Eval(*expr.body);
+
+    call_stack_.pop_back();
+    env().Clear(expr.slots_begin, expr.slots_end);
+    last_exec_result_.control = ControlFlowState::kNormal;
+}
+
+void Evaluator::SpecializeCall(ast::CallExpression& expr) const {
+    expr.cache.state = static_cast<uint8_t>(Specialization::kScriptFunction);
+
+    // standard names can't be assigned, so only a parameter or a loop variable may shadow
+    // the standard function, and those are always local
+    if (!expr.function_name || static_cast<ast::Identifier&>(*expr.function).binding.IsAlwaysLocal()) {
+        return;
+    }
+
+    if (const auto* func = std_lib_.FindOutStreamHandlingFunc(*expr.function_name)) {
+        expr.cache.state = static_cast<uint8_t>(Specialization::kOutStreamBuiltin);
+        expr.cache.target = func;
+    } else if (const auto* func = std_lib_.FindInStreamHandlingFunc(*expr.function_name)) {
+        expr.cache.state = static_cast<uint8_t>(Specialization::kInStreamBuiltin);
+        expr.cache.target = func;
+    } else if (const auto* func = std_lib_.FindValueHandlingFunc(*expr.function_name)) {
+        expr.cache.state = static_cast<uint8_t>(Specialization::kValueBuiltin);
+        expr.cache.target = func;
+    }
+}
+
+bool Evaluator::PrepareTailCall(ast::CallExpression& expr) {
+    // the choice depends only on the callee expression, so it's made before the arguments are evaluated
+    if (expr.cache.state == static_cast<uint8_t>(Specialization::kUninitialized)) {
+        SpecializeCall(expr);
+    }
+
+    if (expr.cache.state != static_cast<uint8_t>(Specialization::kScriptFunction)) {
+        return false;
+    }
+
+    ArgumentPool::Lease args = arguments_->Acquire();
+
+    for (auto& arg : expr.arguments) {
+        args->push_back(Eval(*arg).value);
+    }
+
+    ExecResult func_result = Eval(*expr.function);
+    if (func_result.value.GetType() != ValueType::kFunction) {
+        ThrowRuntimeError<lang_exceptions::UncallableObjectCallError>(expr.function->String());
+    }
+
+    const Function& func = func_result.value.Get<Function>();
+    const std::string& name = GetFunctionName(expr.function_name);
+
+    if (args->size() != func.parameters().size()) {
+        ThrowRuntimeError<lang_exceptions::ParametersCountError>(name, func.parameters().size(), args->size());
+    }
+
+    tail_call_.function_name = &name;
+    tail_call_.entry_token = current_token_;
+    tail_call_.function = func;
+    tail_call_.args.swap(*args);
+    return true;
+}
+
+Value Evaluator::CallFunction(const std::string& name, const Function& func, std::vector<Value>& args) {
     if (args.size() != func.parameters().size()) {
         ThrowRuntimeError<lang_exceptions::ParametersCountError>(
             name,
@@ -262,51 +739,79 @@ Value Evaluator::CallFunction(std::string name, const Function& func, std::vecto
         );
     }
 
-    EnterFunctionScope();
+    if (func.is_generator()) {
+        return MakeGenerator(name, func, args);
+    }
+
+    std::vector<PendingMemo> pending_memos;
+
+    if (func.memo() != nullptr) {
+        if (std::optional<Value> result = FindMemoized(func, args, pending_memos)) {
+            return std::move(*result);
+        }
+    }
+
+    CheckCallDepth();
+    EnterFunctionFrame(func, args);
     
-    call_stack_.push_back(CallFrame{.function_name = std::move(name), .entry_token = current_token_});
+    call_stack_.push_back(CallFrame{.function_name = &name, .entry_token = current_token_});
+
+    // the body is executed in the function scope itself
+    current_token_ = &func.body()->token;
+    EvalStatements(*func.body());
+
+    // the entry token of a tail call points to the code of the function which made it
+    std::optional<Function> caller;
+    std::optional<Function> callee;
+
+    while (tail_call_.function.has_value()) {
+        caller = std::move(callee);
+        callee = std::move(tail_call_.function);
+        tail_call_.function.reset();
+
+        if (callee->is_generator()) {
+            last_exec_result_.value = MakeGenerator(*tail_call_.function_name, *callee, tail_call_.args);
+            last_exec_result_.control = ControlFlowState::kReturn;
+            tail_call_.args.clear();
+            break;
+        }
+
+        if (callee->memo() != nullptr) {
+            if (std::optional<Value> result = FindMemoized(*callee, tail_call_.args, pending_memos)) {
+                tail_call_.args.clear();
+                last_exec_result_.value = std::move(*result);
+                last_exec_result_.control = ControlFlowState::kReturn;
+                break;
+            }
+        }
+
+        LeaveFunctionFrame();
+        EnterFunctionFrame(*callee, tail_call_.args);
+        tail_call_.args.clear();
 
-    for (size_t i = 0; i < func.parameters().size(); ++i) {
-        const std::string& param_name = func.parameters().at(i)->name;
-        env().SetInLocal(param_name, std::move(args[i]));
+        call_stack_.back() = CallFrame{
+            .function_name = tail_call_.function_name,
+            .entry_token = tail_call_.entry_token,
+        };
+
+        current_token_ = &callee->body()->token;
+        EvalStatements(*callee->body());
     }
 
-    ExecResult res = Eval(*func.body());
-    LeaveFunctionScope();
+    ExecResult res = last_exec_result_;
+
+    LeaveFunctionFrame();
     call_stack_.pop_back();
 
-    if (res.control == ControlFlowState::kReturn) {
-        return res.value;
-    } else {
-        return NullType{};
+    if (res.control != ControlFlowState::kReturn) {
+        res.value = NullType{};
     }
-}
 
-void Evaluator::CallLibraryFunction(const std::string& name, std::vector<Value>& args) {
-    last_exec_result_.value = std_lib_.Call(name, args, current_token_, call_stack_);
-    last_exec_result_.control = ControlFlowState::kNormal;
-}
-
-void Evaluator::CallOutStreamLibraryFunction(const std::string& name, std::vector<Value>& args) {
-    last_exec_result_.value = std_lib_.CallOutStreamHandlingFunc(
-        *output_, 
-        name,
-        args, 
-        current_token_, 
-        call_stack_
-    );
-    last_exec_result_.control = ControlFlowState::kNormal;
-}
+    if (!pending_memos.empty()) {
+        StoreMemoized(pending_memos, res.value);
+    }
 
-void Evaluator::CallInStreamLibraryFunction(const std::string& name, std::vector<Value>& args) {
-    last_exec_result_.value = std_lib_.CallInStreamHandlingFunc(
-        *input_, 
-        name,
-        args, 
-        current_token_, 
-        call_stack_
-    );
-    last_exec_result_.control = ControlFlowState::kNormal;
+    return res.value;
 }
 
 void Evaluator::Visit(ast::ReturnStatement& stmt) {
@@ -314,6 +819,12 @@ void Evaluator::Visit(ast::ReturnStatement& stmt) {
         ThrowRuntimeError<lang_exceptions::ControlFlowError>("unexpected 'return' outside of a function");
     }
 
+    // the call is made by CallFunction after this function returns
+    if (auto* call = dynamic_cast<ast::CallExpression*>(stmt.expr.get()); call && PrepareTailCall(*call)) {
+        last_exec_result_.control = ControlFlowState::kReturn;
+        return;
+    }
+
     if (stmt.expr != nullptr) {
         last_exec_result_ = Eval(*stmt.expr);
     } else {
@@ -323,12 +834,35 @@ void Evaluator::Visit(ast::ReturnStatement& stmt) {
     last_exec_result_.control = ControlFlowState::kReturn;
 }
 
+Value Evaluator::MakeGenerator(const std::string& name, const Function& func, std::vector<Value>& args) {
+    if (!Coroutine::IsSupported()) {
+        ThrowRuntimeError<lang_exceptions::ControlFlowError>(
+            "generators are not supported by the tree-walking evaluation on this platform"
+        );
+    }
+
+    return Generator{new TreeWalkGenerator(*this, name, func, args)};
+}
+
+void Evaluator::Visit(ast::YieldStatement& stmt) {
+    if (generator_ == nullptr) {
+        ThrowRuntimeError<lang_exceptions::ControlFlowError>("unexpected 'yield' outside of a generator");
+    }
+
+    Value value = stmt.expr != nullptr ? Eval(*stmt.expr).value : Value{};
+    generator_->Yield(std::move(value));
+
+    last_exec_result_.value = NullType{};
+    last_exec_result_.control = ControlFlowState::kNormal;
+}
+
 void Evaluator::Visit(ast::WhileStatement& stmt) {
     bool prev_loop = inside_loop_;
     inside_loop_ = true;
 
     last_exec_result_.value = NullType{};
     last_exec_result_.control = ControlFlowState::kNormal;
+    env().Clear(stmt.invariants_begin, stmt.invariants_end);
 
     while (Eval(*stmt.condition).value.IsTruphy()) {
         Eval(*stmt.body);
@@ -341,6 +875,12 @@ void Evaluator::Visit(ast::WhileStatement& stmt) {
         }
     }
 
+    // a loop is a statement, its value is nil however it ends; a return keeps the returned value
+    if (last_exec_result_.control != ControlFlowState::kReturn) {
+        last_exec_result_.value = NullType{};
+        last_exec_result_.control = ControlFlowState::kNormal;
+    }
+
     inside_loop_ = prev_loop;
 }
 
@@ -350,23 +890,31 @@ void Evaluator::Visit(ast::ForStatement& stmt) {
 
     last_exec_result_.value = NullType{};
     last_exec_result_.control = ControlFlowState::kNormal;
+    env().Clear(stmt.invariants_begin, stmt.invariants_end);
 
     ExecResult range_res = Eval(*stmt.range);
 
-    if (range_res.value.GetType() != ValueType::kList) {
+    if (!IsIterable(range_res.value)) {
         ThrowRuntimeError<lang_exceptions::UnsupportedTypeError>(
-            "range in the for loop is not of type List"
+            "range in the for loop is not of type List, String or Generator"
         );
     }
 
-    const List& range = range_res.value.Get<List>();
+    Value range = std::move(range_res.value);
 
-    for (const Value& value : range->data()) {
-        PushEnv();
-        env().SetInLocal(stmt.iter->name, value);
-        Eval(*stmt.body);
+    uint32_t iter_slot = stmt.iter->binding.locals.back();
+
+    for (size_t index = 0;; ++index) {
+        // a generator is resumed from the loop
+        current_token_ = &stmt.token;
+        std::optional<Value> value = GetIterElement(range, index);
+        if (!value.has_value()) {
+            break;
+        }
 
-        PopEnv();
+        env().Set(iter_slot, std::move(*value));
+        Eval(*stmt.body);
+        env().Clear(iter_slot, iter_slot + 1);
 
         if (last_exec_result_.control == ControlFlowState::kBreak) {
             last_exec_result_.control = ControlFlowState::kNormal;
@@ -375,6 +923,14 @@ void Evaluator::Visit(ast::ForStatement& stmt) {
             break;
         }
     }
+
+    // a loop is a statement, its value is nil however it ends; a return keeps the returned value
+    if (last_exec_result_.control != ControlFlowState::kReturn) {
+        last_exec_result_.value = NullType{};
+        last_exec_result_.control = ControlFlowState::kNormal;
+    }
+
+    inside_loop_ = prev_loop;
 }
 
 void Evaluator::Visit(ast::BreakStatement& stmt) {
@@ -392,30 +948,37 @@ void Evaluator::Visit(ast::ContinueStatement& stmt) {
 }
 
 void Evaluator::Visit(ast::ListLiteral& list_literal) {
+    last_exec_result_.control = ControlFlowState::kNormal;
+
+    if (list_literal.constant != nullptr) {
+        // the copy shares the elements with the constant until the first write
+        last_exec_result_.value = list_literal.constant->GetCopy();
+        return;
+    }
+
     std::vector<Value> elements;
     elements.reserve(list_literal.elements.size());
     
     for (auto& expr : list_literal.elements) {
         elements.push_back(Eval(*expr).value);
+        elements.back().Thaw();
     }
 
-    last_exec_result_.value = CreateList(std::move(elements));
-    last_exec_result_.control = ControlFlowState::kNormal;
-}
+    Value list = CreateList(std::move(elements));
 
-void Evaluator::Visit(ast::FunctionLiteral& func) {
-    std::set<std::string> seen_params;
+    if (!list_literal.constant_checked) {
+        list_literal.constant_checked = true;
 
-    for (const std::shared_ptr<ast::Identifier>& param : func.parameters) {
-        if (seen_params.contains(param->name)) {
-            ThrowRuntimeError<lang_exceptions::DuplicateParameterError>(param->name);
+        if (list_literal.HasConstantElements()) {
+            list_literal.constant = constants_.Add(list.GetCopy());
         }
-
-        seen_params.insert(param->name);
     }
 
-    auto parameters = std::make_shared<std::vector<std::shared_ptr<ast::Identifier>>>(func.parameters);
-    last_exec_result_.value = Function(std::move(parameters), func.body);
+    last_exec_result_.value = std::move(list);
+}
+
+void Evaluator::Visit(ast::FunctionLiteral& func) {
+    last_exec_result_.value = Function(FunctionPrototype::Of(func));
     last_exec_result_.control = ControlFlowState::kNormal;
 }
 
@@ -448,20 +1011,34 @@ void Evaluator::Visit(ast::BlockStatement& block) {
         return;
     }
 
-    PushEnv();
+    EvalStatements(block);
+
+    // blocks declaring nothing have an empty range, leaving them costs nothing
+    env().Clear(block.slots_begin, block.slots_end);
+}
+
+bool Evaluator::CanKeepInvariant(const Value& value, const std::vector<ast::Binding>& inputs) {
+    if (value.IsReferenceType()) {
+        return false;
+    }
+
+    return std::ranges::none_of(inputs, [this](const ast::Binding& binding) {
+        const Value* input = FindVariable(binding);
+        return input == nullptr || input->IsReferenceType();
+    });
+}
 
+void Evaluator::EvalStatements(const ast::BlockStatement& block) {
     for (const auto& stmt : block.GetStatements()) {
         Eval(*stmt);
         if (last_exec_result_.control != ControlFlowState::kNormal) {
             break;
         }
     }
-
-    PopEnv();
 }
 
 void Evaluator::Visit(ast::ExpressionStatement& node) {
-    current_token_ = node.token;
+    current_token_ = &node.token;
     node.expr->Accept(*this);
 }
 
@@ -482,121 +1059,165 @@ void Evaluator::Visit(ast::InfixExpression& node) {
     ExecResult left_res = Eval(*node.left);
     ExecResult right_res = Eval(*node.right);
     
-    if (auto new_value = HandleBinaryOper(node.oper, left_res.value, right_res.value)) {
-        last_exec_result_.value = *new_value;
-    } else {
-        ThrowRuntimeError<lang_exceptions::OperatorTypeError>(
-            kTokenTypeNames.at(node.oper),
-            left_res.value.GetType(), 
-            right_res.value.GetType()
-        );
-    }
+    last_exec_result_.value = EvalInfixOper(node, left_res.value, right_res.value);
 }
 
-void Evaluator::Visit(ast::IndexOperatorExpression& expr) {
-    if (expr.is_slice) {
-        EvalSliceIndexExpression(expr);
-        return;
+void Evaluator::Visit(ast::LogicalExpression& node) {
+    bool result = Eval(*node.left).value.IsTruphy();
+
+    // false decides `and`, true decides `or`
+    if (result == (node.oper == TokenType::kAnd)) {
+        result = Eval(*node.right).value.IsTruphy();
     }
 
-    ExecResult operand = Eval(*expr.operand);
-    ValueType op_type = operand.value.GetType();
-        
+    last_exec_result_.value = result;
     last_exec_result_.control = ControlFlowState::kNormal;
+}
 
-    if (op_type != ValueType::kString && op_type != ValueType::kList) {
-        ThrowRuntimeError<lang_exceptions::IndexOperandTypeError>(op_type);
+void Evaluator::Visit(ast::InvariantExpression& expr) {
+    if (const Value* kept = env().Find(expr.slot)) {
+        last_exec_result_.value = *kept;
+        last_exec_result_.control = ControlFlowState::kNormal;
+        return;
     }
 
-    ExecResult index = Eval(*expr.index);
+    Eval(*expr.expr);
 
-    if (index.value.GetType() != ValueType::kInt) {
-        ThrowRuntimeError<lang_exceptions::IndexTypeError>(index.value.GetType());
+    if (CanKeepInvariant(last_exec_result_.value, expr.inputs)) {
+        env().Set(expr.slot, last_exec_result_.value);
     }
+}
 
-    Int given_pos = index.value.Get<Int>();
+void Evaluator::Visit(ast::IndexOperatorExpression& expr) {
+    if (expr.is_slice) {
+        EvalSliceIndexExpression(expr);
+        return;
+    }
 
-    if (op_type == ValueType::kString) {
-        const String& str = operand.value.Get<String>();
-        size_t pos = given_pos >= 0 ? given_pos : str->size() + given_pos;
+    ExecResult operand = Eval(*expr.operand);
+    CheckIndexOperandType(operand.value);
 
-        if (pos >= str->size()) {
-            ThrowRuntimeError<lang_exceptions::IndexOutOfRangeError>(given_pos, str->size());
+    ExecResult index = Eval(*expr.index);
+    ValueType operand_type = operand.value.GetType();
+    ValueType index_type = index.value.GetType();
+    ast::InlineCache& cache = expr.cache;
+
+    if (cache.left_type != ToCacheType(operand_type) || cache.right_type != ToCacheType(index_type)) {
+        if (RecordCacheMiss(cache, operand_type, index_type)) {
+            cache.state = static_cast<uint8_t>(
+                operand_type == ValueType::kList && index_type == ValueType::kInt 
+                    ? Specialization::kListIndex 
+                    : Specialization::kMegamorphic
+            );
         }
+    }
 
-        last_exec_result_.value = CreateString(std::string{str->at(pos)});
-    } else if (op_type == ValueType::kList) {
+    if (cache.state == static_cast<uint8_t>(Specialization::kListIndex)) {
         const List& list = operand.value.Get<List>();
+        Int given_pos = index.value.Get<Int>();
         size_t pos = given_pos >= 0 ? given_pos : list->size() + given_pos;
-        
+
         if (pos >= list->size()) {
             ThrowRuntimeError<lang_exceptions::IndexOutOfRangeError>(given_pos, list->size());
         }
 
         last_exec_result_.value = list->At(pos);
+    } else {
+        last_exec_result_.value = GetByIndex(operand.value, index.value);
     }
+
+    last_exec_result_.control = ControlFlowState::kNormal;
 }
 
 void Evaluator::EvalSliceIndexExpression(ast::IndexOperatorExpression& expr) {
     ExecResult operand = Eval(*expr.operand);
-    ValueType op_type = operand.value.GetType();
-
-    if (op_type != ValueType::kString && op_type != ValueType::kList) {
-        ThrowRuntimeError<lang_exceptions::IndexOperandTypeError>(op_type);
-    }
+    CheckIndexOperandType(operand.value);
 
     size_t start = 0;
     size_t end = std::numeric_limits<size_t>::max();
 
     if (expr.index != nullptr) {
-        ExecResult index_res = Eval(*expr.index);
-        
-        if (index_res.value.GetType() != ValueType::kInt) {
-            ThrowRuntimeError<lang_exceptions::IndexTypeError>(index_res.value.GetType());
-        } else if (index_res.value.Get<Int>() < 0) {
-            ThrowRuntimeError<lang_exceptions::NegativeIndexError>(index_res.value.Get<Int>());
-        }
-
-        start = index_res.value.Get<Int>();
+        start = GetSliceBound(Eval(*expr.index).value);
     }
 
     if (expr.second_index != nullptr) {
-        ExecResult index_res = Eval(*expr.second_index);
-        
-        if (index_res.value.GetType() != ValueType::kInt) {
-            ThrowRuntimeError<lang_exceptions::IndexTypeError>(index_res.value.GetType());
-        } else if (index_res.value.Get<Int>() < 0) {
-            ThrowRuntimeError<lang_exceptions::NegativeIndexError>(index_res.value.Get<Int>());
-        }
-
-        end = index_res.value.Get<Int>();
+        end = GetSliceBound(Eval(*expr.second_index).value);
     }
 
+    last_exec_result_.value = GetSlice(operand.value, start, end);
     last_exec_result_.control = ControlFlowState::kNormal;
+}
 
-    if (op_type == ValueType::kList) {
-        const List& list = operand.value.Get<List>();
-        last_exec_result_.value = CreateList(list->GetSlice(start, end));
-    } else if (op_type == ValueType::kString) {
-        const String& str = operand.value.Get<String>();
+void Evaluator::CheckIndexOperandType(const Value& operand) const {
+    ValueType op_type = operand.GetType();
 
-        if (start > end || start >= str->size()) {
-            last_exec_result_.value = CreateString(std::string{});
-            return;
+    if (op_type != ValueType::kString && op_type != ValueType::kList) {
+        ThrowRuntimeError<lang_exceptions::IndexOperandTypeError>(op_type);
+    }
+}
+
+Value Evaluator::GetByIndex(const Value& operand, const Value& index) const {
+    CheckIndexOperandType(operand);
+
+    if (index.GetType() != ValueType::kInt) {
+        ThrowRuntimeError<lang_exceptions::IndexTypeError>(index.GetType());
+    }
+
+    Int given_pos = index.Get<Int>();
+
+    if (operand.IsOfType<String>()) {
+        const String& str = operand.Get<String>();
+        size_t pos = given_pos >= 0 ? given_pos : str->size() + given_pos;
+
+        if (pos >= str->size()) {
+            ThrowRuntimeError<lang_exceptions::IndexOutOfRangeError>(given_pos, str->size());
         }
 
-        if (end >= str->size())
-            end = str->size();
+        return CreateString(std::string{str->at(pos)});
+    }
 
-        last_exec_result_.value = CreateString(std::string(
-            str->begin() + start,
-            str->begin() + end
-        ));
+    const List& list = operand.Get<List>();
+    size_t pos = given_pos >= 0 ? given_pos : list->size() + given_pos;
+    
+    if (pos >= list->size()) {
+        ThrowRuntimeError<lang_exceptions::IndexOutOfRangeError>(given_pos, list->size());
     }
+
+    return list->At(pos);
 }
 
-std::string Evaluator::GetFunctionName(const std::optional<std::string>& name) {
-    return name.has_value() ? *name : "<anonymous function>";
+size_t Evaluator::GetSliceBound(const Value& bound) const {
+    if (bound.GetType() != ValueType::kInt) {
+        ThrowRuntimeError<lang_exceptions::IndexTypeError>(bound.GetType());
+    } else if (bound.Get<Int>() < 0) {
+        ThrowRuntimeError<lang_exceptions::NegativeIndexError>(bound.Get<Int>());
+    }
+
+    return bound.Get<Int>();
+}
+
+Value Evaluator::GetSlice(const Value& operand, size_t start, size_t end) const {
+    if (operand.IsOfType<List>()) {
+        return CreateList(operand.Get<List>()->GetSlice(start, end));
+    }
+
+    const String& str = operand.Get<String>();
+
+    if (start > end || start >= str->size()) {
+        return CreateString(std::string{});
+    }
+
+    if (end >= str->size())
+        end = str->size();
+
+    return CreateString(std::string(
+        str->begin() + start,
+        str->begin() + end
+    ));
+}
+
+const std::string& Evaluator::GetFunctionName(const std::optional<std::string>& name) const {
+    return name.has_value() ? *name : kAnonymousFunctionName;
 }
 
 void Evaluator::RegisterTypeConversions() {
@@ -696,6 +1317,34 @@ void Evaluator::RegisterComparisonOps() {
         }
     );
 
+    operator_registry_.RegisterBinaryOper<Generator, Generator>(
+        TokenType::kEqual, 
+        [](const Value& left, const Value& right) {
+            return left.Get<Generator>() == right.Get<Generator>();
+        }
+    );
+
+    operator_registry_.RegisterBinaryOper<Generator, Generator>(
+        TokenType::kNotEqual, 
+        [](const Value& left, const Value& right) {
+            return left.Get<Generator>() != right.Get<Generator>();
+        }
+    );
+
+    operator_registry_.RegisterBinaryOper<File, File>(
+        TokenType::kEqual, 
+        [](const Value& left, const Value& right) {
+            return left.Get<File>() == right.Get<File>();
+        }
+    );
+
+    operator_registry_.RegisterBinaryOper<File, File>(
+        TokenType::kNotEqual, 
+        [](const Value& left, const Value& right) {
+            return left.Get<File>() != right.Get<File>();
+        }
+    );
+
     operator_registry_.RegisterBinaryOper<List, List>(
         TokenType::kEqual, 
         [](const Value& left, const Value& right) {
@@ -744,27 +1393,15 @@ void Evaluator::RegisterListOps() {
     operator_registry_.RegisterBinaryOper<List, List>(
         TokenType::kPlus, 
         [this](const Value& left, const Value& right) {
-            std::vector<Value> result = left.Get<List>()->data();
-            const std::vector<Value>& right_vals = right.Get<List>()->data();
-            result.insert(result.end(), right_vals.begin(), right_vals.end());
-
-            return CreateList(result);
-        }
-    );
-}
+            std::span<const Value> left_vals = left.Get<List>()->data();
+            std::span<const Value> right_vals = right.Get<List>()->data();
 
-void Evaluator::RegisterLogicalOps() {
-    operator_registry_.RegisterCommutativeOperatorForAllPairsOfTypes(
-        TokenType::kAnd, 
-        [](const Value& left, const Value& right) {
-            return left.IsTruphy() && right.IsTruphy();
-        }
-    );
+            std::vector<Value> result;
+            result.reserve(left_vals.size() + right_vals.size());
+            result.insert(result.end(), left_vals.begin(), left_vals.end());
+            result.insert(result.end(), right_vals.begin(), right_vals.end());
 
-    operator_registry_.RegisterCommutativeOperatorForAllPairsOfTypes(
-        TokenType::kOr, 
-        [](const Value& left, const Value& right) {
-            return left.IsTruphy() || right.IsTruphy();
+            return CreateList(std::move(result));
         }
     );
 }
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <optional>
 #include <variant>
 #include <cstdint>
 #include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <span>
 #include <iostream>
 
 #include "utils.hpp"
@@ -15,11 +18,17 @@
 #include "objects/Value.hpp"
 #include "objects/Function.hpp"
 #include "objects/List.hpp"
+#include "objects/MemoTable.hpp"
 
 #include "evaluation/TypeConversionSystem.hpp"
 #include "evaluation/OperatorRegistry.hpp"
 #include "evaluation/Environment.hpp"
+#include "evaluation/FrameStack.hpp"
+#include "evaluation/ArgumentPool.hpp"
+#include "evaluation/ConstantPool.hpp"
+#include "evaluation/Resolver.hpp"
 #include "evaluation/CallFrame.hpp"
+#include "evaluation/OutputSink.hpp"
 
 #include "exceptions/ZeroDivisionError.hpp"
 #include "exceptions/SequenceMultiplicationError.hpp"
@@ -28,6 +37,14 @@
 
 namespace itmoscript {
 
+namespace vm {
+
+class VirtualMachine;
+
+} // namespace vm
+
+class TreeWalkGenerator;
+
 /**
  * @class Evaluator
  * @brief Walks through the AST and evaluates every node it reaches. Controls the flow of evaluation,
@@ -35,6 +52,9 @@ namespace itmoscript {
  * 
  * @details Implements the AstVisitor interface.
  * All Visit() methods are private, the Node class is a friend of AstVisitor.
+ *
+ * The runtime services (scopes, operators, standard library, call stack) are shared
+ * with vm::VirtualMachine, which executes the bytecode compiled from the same AST.
  */
 class Evaluator : public ast::AstVisitor {
 public:
@@ -65,7 +85,8 @@ public:
      * 
      * @param root Reference to the root AST node (ast::Program)
      * @param input Input stream for read() operations (e.g. std::cin or file stream)
-     * @param output Output stream for print()/println() (e.g. std::cout or file stream)
+     * @param output Output stream for print()/println() (e.g. std::cout or file stream).
+     * The output is buffered and flushed by the end of the evaluation, see SetOutputBuffering.
      * 
      * @throws RuntimeError if evaluation fails (e.g., division by zero, undefined var)
      * 
@@ -86,16 +107,48 @@ public:
     /** @brief Registers all the functions in the standard library, making them able to use. */
     void EnableStd();
 
+    /**
+     * @brief Makes the evaluator optimize the programs before evaluating them, see Optimizer.
+     * @param propagate_constants Whether the globals assigned once are replaced by their values.
+     * Must be false if the globals outlive the program, e.g. in the REPL.
+     */
+    void EnableOptimizer(bool propagate_constants);
+
+    /** @brief Resolves and optimizes the program without evaluating it, e.g. to print the optimized code. */
+    void Optimize(ast::Program& program);
+
+    /**
+     * @brief Sets the number of nested calls after which a RecursionDepthError is raised.
+     * The tree-walking evaluation may also stop earlier, when its native stack is exhausted.
+     */
+    void SetMaxCallDepth(size_t depth) { max_call_depth_ = depth; }
+    size_t max_call_depth() const { return max_call_depth_; }
+
+    /** @brief Sets when the output of print()/println() is flushed, see OutputSink. */
+    void SetOutputBuffering(OutputSink::Policy policy) { output_sink_.SetPolicy(policy); }
+
     const Value& GetLastEvaluatedValue() const;
 
+    static constexpr size_t kDefaultMaxCallDepth = 1'000'000;
+
 private:
-    Token current_token_;
+    friend class vm::VirtualMachine;
+    friend class Optimizer;
+    friend class TreeWalkGenerator;
+
+    /** @brief Token of the node being evaluated, used to report errors. Never null. */
+    const Token* current_token_;
 
     TypeConversionSystem type_convertion_system_;
     OperatorRegistry operator_registry_;
 
     bool inside_loop_ = false;
 
+    bool optimize_ = false;
+    bool propagate_constants_ = false;
+
+    size_t max_call_depth_ = kDefaultMaxCallDepth;
+
     enum class ControlFlowState {
         kNormal,
         kReturn,
@@ -108,40 +161,133 @@ private:
         ControlFlowState control = ControlFlowState::kNormal;
     };
 
+    /**
+     * @struct TailCall
+     * @brief Call made by `return f(...)`. The returning function leaves it to its CallFunction,
+     * which executes it in place of the finished call, so the C++ stack doesn't grow.
+     */
+    struct TailCall {
+        const std::string* function_name = nullptr;
+        const Token* entry_token = nullptr;
+        std::optional<Function> function; // set while the call is pending
+        std::vector<Value> args;
+    };
+
     CallStack call_stack_;
-    std::vector<std::shared_ptr<Environment>> env_stack_;
+
+    /** @brief Slots of the global names, kept between evaluations. */
+    GlobalSlots global_slots_;
+    Environment globals_;
+
+    /** @brief Global slots assigned at the top level of the evaluated programs, see Resolver::defined_globals(). */
+    std::unordered_set<uint32_t> defined_globals_;
+
+    /** @brief Frames of the active function calls, the bottom one is the top-level program. */
+    FrameStack env_stack_;
+    ArgumentPool argument_pool_;
+
+    /** @brief Pool the running code borrows argument buffers from, a generator body has its own one. */
+    ArgumentPool* arguments_ = &argument_pool_;
+
+    /** @brief Generator whose body is being evaluated, nullptr outside of generators. */
+    TreeWalkGenerator* generator_ = nullptr;
+
+    /** @brief Interned literals of the current program, the literal nodes own their values. */
+    ConstantPool constants_;
 
     ExecResult last_exec_result_;
+    TailCall tail_call_;
     stdlib::StdLib std_lib_;
 
+    /** @brief Stream of the output sink, valid during the evaluation. */
     std::ostream* output_;
     std::istream* input_;
+    OutputSink output_sink_;
 
+    /**
+     * @brief Specializations of the nodes with an inline cache, stored in ast::InlineCache::state.
+     * @see ast::InlineCache
+     */
+    enum class Specialization : uint8_t {
+        kUninitialized,
+        kMegamorphic,    // types changed too often, the generic path is used
+        kIntOper,        // the operator is computed inline for two Ints
+        kFloatOper,      // the operator is computed inline for two Floats
+        kDispatch,       // target is the OperatorRegistry::BinaryDispatch entry
+        kListIndex,      // a List indexed by an Int
+        kValueBuiltin,   // target is the stdlib::ValueHandlingFunction
+        kOutStreamBuiltin,
+        kInStreamBuiltin,
+        kScriptFunction, // the callee is a value, evaluated on every call
+    };
+
+    /** @brief Number of the type changes after which the node stops respecializing. */
+    static constexpr uint8_t kMaxCacheMisses = 4;
+
+    /** @brief Returns the frame of the innermost function call. */
     Environment& env();
 
     /**
-     * @brief "Enters" new scope. Pushes new environment to the env_stack_,
-     * with parent link to the current scope.
+     * @brief Resolves identifiers of the program, optimizes it if enabled and sets up a fresh frame for it.
+     * Globals registered by the previous evaluations are preserved.
+     */
+    void PrepareProgram(ast::Program& program);
+
+    /**
+     * @brief Pushes the frame of the called function, with the arguments in the parameter slots.
+     * @details Parameters are always the first slots of the frame, so they
+     * "shadow" the names from the outer scopes.
+     */
+    void EnterFunctionFrame(const Function& func, std::vector<Value>& args);
+
+    /** @brief Throws RecursionDepthError if one more call would be too deep. */
+    void CheckCallDepth() const;
+
+    /**
+     * @brief Implements memoize(function[, capacity]): returns the function sharing the code of the argument,
+     * which caches its results in a MemoTable. Throws ImpureFunctionError if the function is not pure.
      */
-    void PushEnv();
+    Value Memoize(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
 
     /**
-     * @brief "Leaves" the current scope. Erases all identifiers registed inside of it.
+     * @brief Checks if the function and the global functions it calls are pure, see PurityAnalyzer.
+     * Functions being checked already are assumed to be pure, so recursion doesn't make a function impure.
+     * @return std::nullopt if some of the called globals has no function yet.
      */
-    void PopEnv();
+    std::optional<bool> IsPure(const Function& func, std::unordered_set<const FunctionPrototype*>& checked);
 
     /**
-     * @brief "Enters" function scope, setting the parent of the top environment
-     * to global scope.
+     * @brief Checks the global functions called by the memoized function, see MemoTable::unchecked_callees.
+     * @return false if some of them has no function yet.
+     * @throws ImpureFunctionError if some of them is not pure.
      */
-    void EnterFunctionScope();
+    bool CheckMemoizedCallees(MemoTable& memo);
 
     /**
-     * @brief "Leaves" function scope. Erases all identifiers registed inside of it.
-     * @details Just calls PopEnv(). This method is made only for consistency
-     * in function call evaluation.
+     * @brief Looks the arguments of the memoized function up in its cache.
+     * @return The cached result. On a miss, the result to store is added to pending, and String arguments
+     * are replaced with copies: the call may modify them, while the cached calls don't.
      */
-    void LeaveFunctionScope();
+    std::optional<Value> FindMemoized(const Function& func, std::span<Value> args, std::vector<PendingMemo>& pending);
+
+    /** @brief Stores the result of the finished call to the caches waiting for it. */
+    static void StoreMemoized(std::vector<PendingMemo>& pending, const Value& result);
+
+    /** @brief Pops the frame of the function, destroying all its locals. */
+    void LeaveFunctionFrame();
+
+    /**
+     * @brief Returns pointer to the value the binding refers to.
+     * Candidate slots are checked in order: locals of the current frame, then the global slot.
+     * @return nullptr if the name is not defined at the moment.
+     */
+    Value* FindVariable(const ast::Binding& binding);
+
+    /**
+     * @brief Same as FindVariable(const ast::Binding&), but checks the candidate slot found
+     * by the previous lookup of the identifier first.
+     */
+    Value* FindVariable(ast::Identifier& ident);
 
     /**
      * @brief Evaluates the given node by calling node.Accept(*this).
@@ -161,20 +307,51 @@ private:
      */
     std::optional<Value> HandleBinaryOper(TokenType oper, const Value& left, const Value& right);
 
+    /** @brief Calls the handler of the entry, converting the operands to its types if needed. */
+    Value InvokeBinaryDispatch(const OperatorRegistry::BinaryDispatch& entry, const Value& left, const Value& right);
+
+    /**
+     * @brief Evaluates the operator of the node using its inline cache.
+     * Respecializes the node if the operand types differ from the cached ones.
+     * @throw OperatorTypeError If the operator is not defined for the operand types.
+     */
+    Value EvalInfixOper(ast::InfixExpression& node, const Value& left, const Value& right);
+
+    /**
+     * @brief Records the operand types of the cache miss.
+     * @return false if the node has become megamorphic and must not be specialized.
+     */
+    bool RecordCacheMiss(ast::InlineCache& cache, ValueType left, ValueType right) const;
+
+    /** @brief Chooses how the call is made: directly to the standard function or through the callee value. */
+    void SpecializeCall(ast::CallExpression& expr) const;
+
+    /**
+     * @brief Evaluates the arguments and the callee of the returned call and makes it the tail call.
+     * @return false if the callee is a standard function, which is called as usual.
+     */
+    bool PrepareTailCall(ast::CallExpression& expr);
+
     /**
-     * @brief Checks if the given identifier is registered either in the current scope or in any
+     * @brief Checks if the given identifier is defined either in the current scope or in any
      * of the outer scopes. If it is, returns const ref to it's value.
      * @throw UndefinedNameError If the identifier is not found in all of the scope chain.
      */
-    const Value& ResolveIdentifier(const ast::Identifier& ident);
+    const Value& ResolveIdentifier(ast::Identifier& ident);
+
+    /**
+     * @brief Same as ResolveIdentifier(ast::Identifier&), but takes the binding
+     * and the token to report separately.
+     */
+    const Value& ResolveIdentifier(const std::string& name, const ast::Binding& binding, const Token& token);
 
     /**
      * @brief Assigns the identifier to the given value.
      * If the identifier exists in the current scope or in any outer scope, changes it's value.
      * 
-     * Otherwise, registers the new identifier with the given value.
+     * Otherwise, defines the identifier in the innermost scope (or as a global at the top level).
      */
-    void AssignIdentifier(const std::string& name, Value value);
+    void AssignIdentifier(const std::string& name, const ast::Binding& binding, Value value);
 
     /**
      * @brief Assigns a value to an identifier with deep copy semantics for reference types.
@@ -194,7 +371,7 @@ private:
      * clear(x)
      * // Using this function ensures 'x' is actually cleared
      */
-    void AssignIdentifierWithCopy(const std::string& name, Value value);
+    void AssignIdentifierWithCopy(const std::string& name, const ast::Binding& binding, Value value);
 
     /**
      * @brief Calls the function with given arguments.
@@ -205,17 +382,52 @@ private:
      * @details When the control flow enters the function, it creates it's local scope with parameters
      * set to the corresponing values passed to the function.
      * So, local function parameters "shadow" parameters from the outer scope.
+     * Tail calls made by the function reuse its frame and its entry of the call stack.
+     * A memoized function returns the cached result without the call, if there is one.
+     */
+    Value CallFunction(const std::string& name, const Function& func, std::vector<Value>& args);
+
+    /**
+     * @brief Creates the generator of the call of a generator function, the body is not executed yet.
+     * @throws ControlFlowError if the platform can't suspend the tree-walking evaluation.
      */
-    Value CallFunction(std::string name, const Function& func, std::vector<Value>& args);
+    Value MakeGenerator(const std::string& name, const Function& func, std::vector<Value>& args);
 
     /**
      * @brief Returns the identifier associated with the function if it's named,
      * "<anonymous function>" otherwise.
      */
-    std::string GetFunctionName(const std::optional<std::string>& name);
+    const std::string& GetFunctionName(const std::optional<std::string>& name) const;
+
+    /**
+     * @brief Checks if the value of an ast::InvariantExpression can be kept until the loop ends:
+     * it and all the inputs must be of the value types.
+     */
+    bool CanKeepInvariant(const Value& value, const std::vector<ast::Binding>& inputs);
+
+    /** @brief Evaluates statements of the block in the current scope, stopping at control flow changes. */
+    void EvalStatements(const ast::BlockStatement& block);
 
     void EvalSliceIndexExpression(ast::IndexOperatorExpression& expr);
 
+    /** @throw IndexOperandTypeError If the operand is neither a String nor a List. */
+    void CheckIndexOperandType(const Value& operand) const;
+
+    /**
+     * @brief Returns the element of the String or the List on the given position.
+     * Negative positions are counted from the end.
+     */
+    Value GetByIndex(const Value& operand, const Value& index) const;
+
+    /**
+     * @brief Checks that the slice bound is a non-negative Int.
+     * @return The bound as a position.
+     */
+    size_t GetSliceBound(const Value& bound) const;
+
+    /** @brief Returns the part of the String or the List in the range [start, end). */
+    Value GetSlice(const Value& operand, size_t start, size_t end) const;
+
     template<NumericValueType T>
     void RegisterCommonAriphmeticOps();
 
@@ -230,13 +442,8 @@ private:
     void RegisterUnaryOps();
     void RegisterComparisonOps();
     void RegisterStringOps();
-    void RegisterLogicalOps();
     void RegisterListOps();
 
-    void CallLibraryFunction(const std::string& name, std::vector<Value>& args);
-    void CallOutStreamLibraryFunction(const std::string& name, std::vector<Value>& args);
-    void CallInStreamLibraryFunction(const std::string& name, std::vector<Value>& args);
-
     /**
      * @brief Throws RuntimeError's inheritant exception with given type and arguments.
      * Also includes current token and current call stack to the exception constructor.
@@ -257,6 +464,8 @@ private:
     void Visit(ast::ExpressionStatement&) override;
     void Visit(ast::PrefixExpression&) override;
     void Visit(ast::InfixExpression&) override;
+    void Visit(ast::LogicalExpression&) override;
+    void Visit(ast::InvariantExpression&) override;
     void Visit(ast::IndexOperatorExpression&) override;
 
     void Visit(ast::Identifier&) override;
@@ -273,7 +482,9 @@ private:
     void Visit(ast::AssignStatement&) override;
     void Visit(ast::OperatorAssignStatement&) override;
     void Visit(ast::CallExpression&) override;
+    void Visit(ast::InlinedCallExpression&) override;
     void Visit(ast::ReturnStatement&) override;
+    void Visit(ast::YieldStatement&) override;
 
     void Visit(ast::WhileStatement&) override;
     void Visit(ast::ForStatement&) override;
@@ -357,7 +568,7 @@ void Evaluator::ThrowRuntimeError(Token token, Args&&... args) const {
 
 template<typename ErrorType, typename ...Args>
 void Evaluator::ThrowRuntimeError(Args&&... args) const {
-    throw ErrorType{current_token_, call_stack_, std::forward<Args>(args)...};
+    throw ErrorType{*current_token_, call_stack_, std::forward<Args>(args)...};
 }
 
 } // namespace itmoscript
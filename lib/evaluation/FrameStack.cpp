@@ -0,0 +1,25 @@
+#include "FrameStack.hpp"
+
+namespace itmoscript {
+
+Environment& FrameStack::Push(size_t size) {
+    if (size_ == frames_.size()) {
+        frames_.emplace_back();
+    }
+
+    Environment& frame = frames_[size_++];
+    frame.Reset(size);
+    return frame;
+}
+
+void FrameStack::Pop() {
+    frames_[--size_].Reset(0);
+}
+
+void FrameStack::Truncate(size_t depth) {
+    while (size_ > depth) {
+        Pop();
+    }
+}
+
+} // namespace itmoscript
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "evaluation/Environment.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class FrameStack
+ * @brief Stack of the frames of active function calls. The bottom frame belongs to the top-level program.
+ * 
+ * @details Popped frames are not destroyed: their values are released, but the storage is kept
+ * and reused by the next calls, so once the stack has been as deep as the program needs,
+ * entering a function doesn't allocate.
+ * 
+ * References to frames are invalidated by Push().
+ */
+class FrameStack {
+public:
+    FrameStack() = default;
+
+    FrameStack(const FrameStack&) = delete;
+    FrameStack(FrameStack&&) = delete;
+    FrameStack& operator=(const FrameStack&) = delete;
+    FrameStack& operator=(FrameStack&&) = delete;
+    ~FrameStack() = default;
+
+    /** @brief Pushes the frame with the given number of undefined slots. */
+    Environment& Push(size_t size);
+
+    /** @brief Pops the top frame, destroying all its values. */
+    void Pop();
+
+    /** @brief Pops the frames until there are only depth of them. */
+    void Truncate(size_t depth);
+
+    Environment& top() { return frames_[size_ - 1]; }
+
+    size_t size() const { return size_; }
+
+private:
+    /** @brief Frames [0, size_) are active, the rest are kept for reuse. */
+    std::vector<Environment> frames_;
+    size_t size_ = 0;
+};
+
+} // namespace itmoscript
@@ -0,0 +1,227 @@
+#include "NativeStack.hpp"
+
+#include <exception>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define ITMOSCRIPT_HAS_PTHREAD
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#define ITMOSCRIPT_HAS_UCONTEXT
+#endif
+
+namespace itmoscript {
+
+namespace {
+
+/** @brief Lowest address the current thread may use before the reserve, 0 if the stack is not managed. */
+thread_local uintptr_t stack_limit = 0;
+
+struct StackTask {
+    size_t size;
+    const std::function<void()>* func;
+    std::exception_ptr error;
+};
+
+#ifdef ITMOSCRIPT_HAS_PTHREAD
+void* RunTask(void* arg) {
+    auto* task = static_cast<StackTask*>(arg);
+
+    // the stack grows down from the frame of this function
+    char marker = 0;
+    stack_limit = reinterpret_cast<uintptr_t>(&marker) - (task->size - NativeStack::kReserve);
+
+    try {
+        (*task->func)();
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+
+    return nullptr;
+}
+#endif
+
+/** @brief Thrown by Coroutine::Suspend() to unwind the stack of a destroyed coroutine. */
+struct Cancellation {};
+
+/** @brief State of the coroutine being started, makecontext() can't pass a pointer portably. */
+thread_local void* starting_coroutine = nullptr;
+
+} // namespace
+
+void NativeStack::Run(size_t size, const std::function<void()>& func) {
+#ifdef ITMOSCRIPT_HAS_PTHREAD
+    StackTask task{.size = size, .func = &func};
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    if (pthread_attr_init(&attr) == 0) {
+        bool started = pthread_attr_setstacksize(&attr, size) == 0
+            && pthread_create(&thread, &attr, RunTask, &task) == 0;
+        pthread_attr_destroy(&attr);
+
+        if (started) {
+            pthread_join(thread, nullptr);
+
+            if (task.error) {
+                std::rethrow_exception(task.error);
+            }
+
+            return;
+        }
+    }
+#endif
+
+    func();
+}
+
+bool NativeStack::IsExhausted() {
+    char marker = 0;
+    return stack_limit != 0 && reinterpret_cast<uintptr_t>(&marker) < stack_limit;
+}
+
+struct Coroutine::State {
+    std::function<void()> body;
+    size_t stack_size = 0;
+
+    /** @brief The mapping of the stack, its lowest page is the guard. */
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    uintptr_t limit = 0;
+    uintptr_t caller_limit = 0;
+
+    bool started = false;
+    bool finished = false;
+    bool cancelled = false;
+    std::exception_ptr error;
+
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    ucontext_t caller;
+    ucontext_t context;
+#endif
+};
+
+Coroutine::Coroutine(std::function<void()> body, size_t stack_size)
+    : state_(std::make_unique<State>()) {
+    state_->body = std::move(body);
+    state_->stack_size = stack_size;
+
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    state_->mapping_size = stack_size + page;
+
+    void* mapping = mmap(
+        nullptr,
+        state_->mapping_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+        -1,
+        0
+    );
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("cannot allocate the stack of a coroutine");
+    }
+
+    state_->mapping = mapping;
+    mprotect(mapping, page, PROT_NONE);
+    state_->limit = reinterpret_cast<uintptr_t>(mapping) + page + NativeStack::kReserve;
+#else
+    throw std::logic_error("coroutines are not supported on this platform");
+#endif
+}
+
+Coroutine::~Coroutine() {
+    if (state_->started && !state_->finished) {
+        state_->cancelled = true;
+        SwitchIn();
+    }
+
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    munmap(state_->mapping, state_->mapping_size);
+#endif
+}
+
+bool Coroutine::IsSupported() {
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Coroutine::Resume() {
+    if (state_->finished) {
+        return;
+    }
+
+    SwitchIn();
+
+    if (state_->error) {
+        std::rethrow_exception(std::exchange(state_->error, nullptr));
+    }
+}
+
+void Coroutine::Suspend() {
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    swapcontext(&state_->context, &state_->caller);
+#endif
+
+    if (state_->cancelled) {
+        throw Cancellation{};
+    }
+}
+
+bool Coroutine::finished() const {
+    return state_->finished;
+}
+
+void Coroutine::SwitchIn() {
+#ifdef ITMOSCRIPT_HAS_UCONTEXT
+    State& state = *state_;
+
+    if (!state.started) {
+        getcontext(&state.context);
+        state.context.uc_stack.ss_sp = static_cast<char*>(state.mapping) + (state.mapping_size - state.stack_size);
+        state.context.uc_stack.ss_size = state.stack_size;
+        state.context.uc_link = &state.caller;
+        makecontext(&state.context, &Coroutine::Enter, 0);
+
+        state.started = true;
+        starting_coroutine = &state;
+    }
+
+    // the body checks its depth against its own stack
+    state.caller_limit = stack_limit;
+    stack_limit = state.limit;
+
+    swapcontext(&state.caller, &state.context);
+
+    stack_limit = state.caller_limit;
+#endif
+}
+
+void Coroutine::Enter() {
+    auto* state = static_cast<State*>(std::exchange(starting_coroutine, nullptr));
+
+    try {
+        state->body();
+    } catch (const Cancellation&) {
+        // the stack is unwound, the coroutine is being destroyed
+    } catch (...) {
+        state->error = std::current_exception();
+    }
+
+    // returns to the caller through uc_link
+    state->finished = true;
+}
+
+} // namespace itmoscript
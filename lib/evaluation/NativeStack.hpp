@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace itmoscript {
+
+/**
+ * @class NativeStack
+ * @brief Runs the tree-walking evaluation on a dedicated thread with a big stack.
+ *
+ * @details Every script call nests several C++ calls of the Evaluator, so deep recursion
+ * needs much more than the default stack of the main thread. The stack is only reserved:
+ * the pages are committed when they are touched.
+ *
+ * The code running on such a stack checks IsExhausted() before going deeper,
+ * so the recursion ends with a language error instead of a crash.
+ */
+class NativeStack {
+public:
+    /** @brief Size of the stack the evaluation runs on. */
+    static constexpr size_t kDefaultSize = size_t{512} << 20;
+
+    /** @brief Part of the stack kept free for the code between two checks, e.g. builtins and nested expressions. */
+    static constexpr size_t kReserve = size_t{1} << 20;
+
+    /**
+     * @brief Calls the function on a new thread with the stack of the given size and waits for it.
+     * Exceptions are rethrown in the calling thread.
+     * If the thread can't be created, the function is called on the current stack.
+     */
+    static void Run(size_t size, const std::function<void()>& func);
+
+    /** @brief Checks if the current thread runs on a stack of Run() and it has less than kReserve left. */
+    static bool IsExhausted();
+};
+
+/**
+ * @class Coroutine
+ * @brief Function running on its own native stack, which may suspend itself and be resumed later.
+ *
+ * @details The tree-walking evaluation keeps its state on the native stack, so a generator
+ * suspended in the middle of its body keeps its whole stack. The stack is reserved like the one
+ * of NativeStack::Run() and its depth is checked by NativeStack::IsExhausted() too.
+ *
+ * A coroutine destroyed while suspended is resumed once more to unwind its stack:
+ * Suspend() throws an exception the body must not catch.
+ */
+class Coroutine {
+public:
+    /** @brief Size of the stack of a coroutine. Only the touched pages are committed. */
+    static constexpr size_t kDefaultStackSize = size_t{64} << 20;
+
+    /** @brief Prepares the coroutine, the body doesn't run until the first Resume(). */
+    explicit Coroutine(std::function<void()> body, size_t stack_size = kDefaultStackSize);
+
+    Coroutine(const Coroutine&) = delete;
+    Coroutine(Coroutine&&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+    Coroutine& operator=(Coroutine&&) = delete;
+    ~Coroutine();
+
+    /** @brief Checks if the platform can run coroutines. If it can't, the constructor throws. */
+    static bool IsSupported();
+
+    /**
+     * @brief Runs the body until it calls Suspend() or returns.
+     * An exception thrown by the body finishes the coroutine and is rethrown here.
+     */
+    void Resume();
+
+    /** @brief Returns from the Resume() call running the body. Must be called by the body only. */
+    void Suspend();
+
+    bool finished() const;
+
+private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+
+    /** @brief Switches to the body, leaving its exception in the state. */
+    void SwitchIn();
+
+    static void Enter();
+};
+
+} // namespace itmoscript
@@ -2,43 +2,71 @@
 
 namespace itmoscript {
 
+OperatorRegistry::OperatorRegistry()
+    : binary_table_(kOperatorsCount * kValueTypesCount * kValueTypesCount),
+      unary_table_(kOperatorsCount * kValueTypesCount, nullptr) {}
+
 void OperatorRegistry::RegisterCommutativeOperatorForAllPairsOfTypes(TokenType oper, BinaryHandler handler) {
-    RegisterCommutativeOperatorForAllTypes<NullType>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<Int>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<Float>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<String>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<Bool>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<Function>(oper, handler);
-    RegisterCommutativeOperatorForAllTypes<List>(oper, handler);
+    const BinaryHandler* stored = StoreHandler(std::move(handler));
+
+    for (ValueType left : kValueTypes) {
+        for (ValueType right : kValueTypes) {
+            SetHandler(oper, left, right, stored);
+        }
+    }
 }
 
 void OperatorRegistry::RegisterUnaryOperatorForAllTypes(TokenType oper, UnaryHandler handler) {
-    RegisterUnaryOper<NullType>(oper, handler);
-    RegisterUnaryOper<Int>(oper, handler);
-    RegisterUnaryOper<Float>(oper, handler);
-    RegisterUnaryOper<String>(oper, handler);
-    RegisterUnaryOper<Bool>(oper, handler);
-    RegisterUnaryOper<Function>(oper, handler);
-    RegisterUnaryOper<List>(oper, handler);
+    const UnaryHandler* stored = StoreHandler(std::move(handler));
+
+    for (ValueType type : kValueTypes) {
+        unary_table_[UnaryIndex(oper, type)] = stored;
+    }
 }
 
-std::optional<OperatorRegistry::BinaryHandler>
-OperatorRegistry::FindExactHandler(TokenType oper, ValueType left, ValueType right) {
-    auto key = std::make_pair(left, right);
-    if (binary_ops_.contains(oper) && binary_ops_[oper].contains(key)) {
-        return binary_ops_[oper][key];
+void OperatorRegistry::RegisterPromotions(const TypeConversionSystem& conversions) {
+    for (size_t oper_index = 0; oper_index < kOperatorsCount; ++oper_index) {
+        TokenType oper = static_cast<TokenType>(oper_index);
+
+        for (ValueType left : kValueTypes) {
+            for (ValueType right : kValueTypes) {
+                BinaryDispatch& entry = binary_table_[BinaryIndex(oper, left, right)];
+
+                if (entry.handler != nullptr && !entry.IsPromoted()) {
+                    continue;
+                }
+
+                entry = BinaryDispatch{};
+                std::optional<ValueType> common = conversions.FindCommonType(left, right);
+
+                if (!common || (*common == left && *common == right)) {
+                    continue;
+                }
+
+                const BinaryDispatch& common_entry = binary_table_[BinaryIndex(oper, *common, *common)];
+
+                if (common_entry.handler == nullptr) {
+                    continue;
+                }
+
+                entry.handler = common_entry.handler;
+                entry.convert_left = conversions.FindConverter(left, *common);
+                entry.convert_right = conversions.FindConverter(right, *common);
+            }
+        }
     }
+}
 
-    return std::nullopt;
+const OperatorRegistry::BinaryHandler* OperatorRegistry::StoreHandler(BinaryHandler handler) {
+    return &binary_handlers_.emplace_back(std::move(handler));
 }
 
-std::optional<OperatorRegistry::UnaryHandler>
-OperatorRegistry::FindExactHandler(TokenType oper, ValueType right) {
-    if (unary_ops_.contains(oper) && unary_ops_[oper].contains(right)) {
-        return unary_ops_[oper][right];
-    }
+const OperatorRegistry::UnaryHandler* OperatorRegistry::StoreHandler(UnaryHandler handler) {
+    return &unary_handlers_.emplace_back(std::move(handler));
+}
 
-    return std::nullopt;
+void OperatorRegistry::SetHandler(TokenType oper, ValueType left, ValueType right, const BinaryHandler* handler) {
+    binary_table_[BinaryIndex(oper, left, right)] = BinaryDispatch{.handler = handler};
 }
 
 } // namespace itmoscript
@@ -1,7 +1,10 @@
 #pragma once
 
-#include <unordered_map>
+#include <array>
+#include <deque>
+#include <vector>
 #include <string>
+#include <cstddef>
 #include <functional>
 
 #include "objects/Value.hpp"
@@ -13,6 +16,11 @@ namespace itmoscript {
  * @class OperatorRegistry
  * @brief Stores operator handlers for specific types.
  * Allows registering and retrieving operator handlers for unary and binary operators.
+ * 
+ * @details Handlers are looked up in dense tables indexed by the operator and the operand types,
+ * so finding a handler is a single indexing operation. Mixed-type operands which are evaluated
+ * through the implicit conversion to a common type (e.g. Int + Float) get their entries
+ * precomputed by RegisterPromotions().
  */
 class OperatorRegistry {
 public:
@@ -28,6 +36,27 @@ public:
      */
     using UnaryHandler = std::function<Value(const Value&)>;
 
+    /**
+     * @brief Entry of the binary operators table.
+     * If the operands must be converted to a common type first, the converters are set
+     * for the operands which need the conversion.
+     */
+    struct BinaryDispatch {
+        const BinaryHandler* handler = nullptr;
+        const TypeConversionSystem::Converter* convert_left = nullptr;
+        const TypeConversionSystem::Converter* convert_right = nullptr;
+
+        bool IsPromoted() const { return convert_left != nullptr || convert_right != nullptr; }
+    };
+
+    OperatorRegistry();
+
+    OperatorRegistry(const OperatorRegistry&) = delete;
+    OperatorRegistry(OperatorRegistry&&) = delete;
+    OperatorRegistry& operator=(const OperatorRegistry&) = delete;
+    OperatorRegistry& operator=(OperatorRegistry&&) = delete;
+    ~OperatorRegistry() = default;
+
     template<CoreValueType Right>
     void RegisterUnaryOper(TokenType oper, UnaryHandler handler);
 
@@ -89,50 +118,81 @@ public:
     void RegisterAllComparisonOpsForRefType();
 
     /**
-     * @brief Finds exact handler for given binary operator with given left and right types.
-     * @return The handler if it was found for given types and operator, std::nullopt otherwise.
+     * @brief Precomputes the entries for the operands of different types which have no exact handler,
+     * but can be converted to a common type having one. Must be called after all the operators
+     * and conversions are registered. 
+     * @see TypeConversionSystem::FindCommonType()
+     */
+    void RegisterPromotions(const TypeConversionSystem& conversions);
+
+    /**
+     * @brief Finds the handler for given binary operator with given left and right types.
+     * @return The table entry, its handler is nullptr if the operator is not defined for the types.
      */
-    std::optional<BinaryHandler> FindExactHandler(TokenType oper, ValueType left, ValueType right);
+    const BinaryDispatch& FindHandler(TokenType oper, ValueType left, ValueType right) const {
+        return binary_table_[BinaryIndex(oper, left, right)];
+    }
 
     /**
-     * @brief Finds exact handler for given unary operator with given value type.
-     * @return The handler if it was found for given type and operator, std::nullopt otherwise.
+     * @brief Finds the handler for given unary operator with given value type.
+     * @return The handler if it was found for given type and operator, nullptr otherwise.
      */
-    std::optional<UnaryHandler> FindExactHandler(TokenType oper, ValueType type);
+    const UnaryHandler* FindHandler(TokenType oper, ValueType type) const {
+        return unary_table_[UnaryIndex(oper, type)];
+    }
 
 private:
-    std::unordered_map<
-        TokenType, 
-        std::unordered_map<
-            std::pair<ValueType, ValueType>,
-            BinaryHandler,
-            ValueTypePairHash
-        >
-    > binary_ops_;
-
-    std::unordered_map<
-        TokenType, 
-        std::unordered_map<
-            ValueType,
-            UnaryHandler
-        >
-    > unary_ops_;
+    static constexpr size_t kOperatorsCount = static_cast<size_t>(TokenType::kNil) + 1;
+    static constexpr size_t kValueTypesCount = static_cast<size_t>(ValueType::kNullType) + 1;
+
+    static constexpr std::array<ValueType, 9> kValueTypes = {
+        ValueType::kInt,
+        ValueType::kFloat,
+        ValueType::kBool,
+        ValueType::kString,
+        ValueType::kList,
+        ValueType::kFunction,
+        ValueType::kGenerator,
+        ValueType::kFile,
+        ValueType::kNullType,
+    };
+
+    static constexpr size_t UnaryIndex(TokenType oper, ValueType type) {
+        return static_cast<size_t>(oper) * kValueTypesCount + static_cast<size_t>(type);
+    }
+
+    static constexpr size_t BinaryIndex(TokenType oper, ValueType left, ValueType right) {
+        return UnaryIndex(oper, left) * kValueTypesCount + static_cast<size_t>(right);
+    }
+
+    /** @brief Owns the handlers, the deques keep them in place, so the tables can point to them. */
+    std::deque<BinaryHandler> binary_handlers_;
+    std::deque<UnaryHandler> unary_handlers_;
+
+    std::vector<BinaryDispatch> binary_table_;
+    std::vector<const UnaryHandler*> unary_table_;
+
+    const BinaryHandler* StoreHandler(BinaryHandler handler);
+    const UnaryHandler* StoreHandler(UnaryHandler handler);
+
+    void SetHandler(TokenType oper, ValueType left, ValueType right, const BinaryHandler* handler);
 };
 
 template<CoreValueType Right>
 void OperatorRegistry::RegisterUnaryOper(TokenType oper, UnaryHandler handler) {
-    unary_ops_[oper][GetType<Right>()] = handler;
+    unary_table_[UnaryIndex(oper, GetType<Right>())] = StoreHandler(std::move(handler));
 }
 
 template<CoreValueType Left, CoreValueType Right>
 void OperatorRegistry::RegisterBinaryOper(TokenType oper, BinaryHandler handler) {
-    binary_ops_[oper][{GetType<Left>(), GetType<Right>()}] = handler;
+    SetHandler(oper, GetType<Left>(), GetType<Right>(), StoreHandler(std::move(handler)));
 }
 
 template<CoreValueType T, CoreValueType U>
 void OperatorRegistry::RegisterCommutativeOperator(TokenType oper, BinaryHandler handler) {
-    binary_ops_[oper][{GetType<T>(), GetType<U>()}] = handler;
-    binary_ops_[oper][{GetType<U>(), GetType<T>()}] = handler;
+    const BinaryHandler* stored = StoreHandler(std::move(handler));
+    SetHandler(oper, GetType<T>(), GetType<U>(), stored);
+    SetHandler(oper, GetType<U>(), GetType<T>(), stored);
 }
 
 template<CoreValueType T>
@@ -140,13 +200,12 @@ void OperatorRegistry::RegisterCommutativeOperatorForAllTypes(
     TokenType oper, 
     OperatorRegistry::BinaryHandler handler) 
 {
-    RegisterCommutativeOperator<T, NullType>(oper, handler);
-    RegisterCommutativeOperator<T, Int>(oper, handler);
-    RegisterCommutativeOperator<T, Float>(oper, handler);
-    RegisterCommutativeOperator<T, String>(oper, handler);
-    RegisterCommutativeOperator<T, Bool>(oper, handler);
-    RegisterCommutativeOperator<T, Function>(oper, handler);
-    RegisterCommutativeOperator<T, List>(oper, handler);
+    const BinaryHandler* stored = StoreHandler(std::move(handler));
+
+    for (ValueType other : kValueTypes) {
+        SetHandler(oper, GetType<T>(), other, stored);
+        SetHandler(oper, other, GetType<T>(), stored);
+    }
 }
 
 template<CoreValueType T>
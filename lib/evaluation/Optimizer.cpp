@@ -0,0 +1,1211 @@
+#include "Optimizer.hpp"
+#include "Evaluator.hpp"
+#include "Resolver.hpp"
+#include "StandardFunctions.hpp"
+
+#include "LangException.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace itmoscript {
+
+namespace {
+
+/** @brief Returns the name of the standard function the call refers to, nullptr if it may call a script function. */
+const std::string* GetStandardCallee(const ast::CallExpression& expr) {
+    auto* ident = dynamic_cast<const ast::Identifier*>(expr.function.get());
+
+    // standard names can't be assigned, only a parameter or a loop variable may shadow them
+    if (ident == nullptr || ident->binding.IsAlwaysLocal()) {
+        return nullptr;
+    }
+
+    return &ident->name;
+}
+
+/** @brief Checks if the expression evaluates to a number, a boolean or nil, or fails. */
+bool IsValueTypeExpression(const ast::Expression& expr) {
+    if (dynamic_cast<const ast::IntegerLiteral*>(&expr) || dynamic_cast<const ast::FloatLiteral*>(&expr)
+        || dynamic_cast<const ast::BooleanLiteral*>(&expr) || dynamic_cast<const ast::NullTypeLiteral*>(&expr)
+        || dynamic_cast<const ast::PrefixExpression*>(&expr) || dynamic_cast<const ast::LogicalExpression*>(&expr)) {
+        return true;
+    }
+
+    if (auto* hoisted = dynamic_cast<const ast::InvariantExpression*>(&expr)) {
+        return IsValueTypeExpression(*hoisted->expr);
+    }
+
+    if (auto* call = dynamic_cast<const ast::CallExpression*>(&expr)) {
+        const std::string* callee = GetStandardCallee(*call);
+        return callee != nullptr && kNumericFunctions.contains(*callee);
+    }
+
+    auto* infix = dynamic_cast<const ast::InfixExpression*>(&expr);
+    if (infix == nullptr) {
+        return false;
+    }
+
+    // strings and lists are produced only by +, - and * and only when both operands aren't numbers
+    switch (infix->oper) {
+        case TokenType::kPlus:
+        case TokenType::kMinus:
+            return IsValueTypeExpression(*infix->left) || IsValueTypeExpression(*infix->right);
+        case TokenType::kAsterisk:
+            return IsValueTypeExpression(*infix->left) && IsValueTypeExpression(*infix->right);
+        default:
+            return true;
+    }
+}
+
+/** @brief Appends the bindings of the identifiers the expression reads, except the called ones. */
+void CollectInputs(const ast::Expression& expr, std::vector<ast::Binding>& inputs) {
+    if (auto* ident = dynamic_cast<const ast::Identifier*>(&expr)) {
+        inputs.push_back(ident->binding);
+    } else if (auto* hoisted = dynamic_cast<const ast::InvariantExpression*>(&expr)) {
+        CollectInputs(*hoisted->expr, inputs);
+    } else if (auto* prefix = dynamic_cast<const ast::PrefixExpression*>(&expr)) {
+        CollectInputs(*prefix->right, inputs);
+    } else if (auto* infix = dynamic_cast<const ast::InfixExpression*>(&expr)) {
+        CollectInputs(*infix->left, inputs);
+        CollectInputs(*infix->right, inputs);
+    } else if (auto* index = dynamic_cast<const ast::IndexOperatorExpression*>(&expr)) {
+        CollectInputs(*index->operand, inputs);
+
+        if (index->index != nullptr) {
+            CollectInputs(*index->index, inputs);
+        }
+
+        if (index->second_index != nullptr) {
+            CollectInputs(*index->second_index, inputs);
+        }
+    } else if (auto* call = dynamic_cast<const ast::CallExpression*>(&expr)) {
+        for (const auto& arg : call->arguments) {
+            CollectInputs(*arg, inputs);
+        }
+    }
+}
+
+/** @brief Checks if the expression never evaluates to a Generator, so iterating its value runs no script code. */
+bool IsNeverGenerator(const ast::Expression& expr) {
+    // operators never produce a generator
+    if (dynamic_cast<const ast::StringLiteral*>(&expr) || dynamic_cast<const ast::ListLiteral*>(&expr)
+        || dynamic_cast<const ast::InfixExpression*>(&expr) || IsValueTypeExpression(expr)) {
+        return true;
+    }
+
+    if (auto* hoisted = dynamic_cast<const ast::InvariantExpression*>(&expr)) {
+        return IsNeverGenerator(*hoisted->expr);
+    }
+
+    // no pure standard function returns a generator
+    if (auto* call = dynamic_cast<const ast::CallExpression*>(&expr)) {
+        const std::string* callee = GetStandardCallee(*call);
+        return callee != nullptr && kPureFunctions.contains(*callee);
+    }
+
+    return false;
+}
+
+/** @brief Checks if the call of the standard function may drain a Generator argument, running its body. */
+bool MayDrainGenerator(const ast::CallExpression& expr, const std::string& callee) {
+    return kGeneratorDrainingFunctions.contains(callee)
+        && !std::ranges::all_of(expr.arguments, [](const auto& arg) { return IsNeverGenerator(*arg); });
+}
+
+/**
+ * @class LoopEffects
+ * @brief Collects what the repeated part of a loop (the condition and the body) may modify.
+ * Nested function literals are skipped: their bodies are executed only by a call.
+ *
+ * @details The InvariantHoister relies on calls_functions and modifies_objects being set whenever
+ * script code may run inside the loop, since that code may assign any global or modify any object.
+ * Script code runs only by:
+ * - a call of a script function, or of a standard function which is neither pure nor value-preserving;
+ * - a standard call draining a generator, see kGeneratorDrainingFunctions;
+ * - an iteration over a generator, see AddIteration();
+ * - a yield, which hands control to the consumer.
+ * A new way to run script code, e.g. a standard function calling its argument, must be added here,
+ * otherwise hoisted values go stale.
+ */
+class LoopEffects : public ast::AstVisitor {
+public:
+    /** @brief Names assigned in the loop, including the variables of the loops. */
+    std::unordered_set<std::string> assigned;
+
+    /** @brief The loop calls a script function, which may assign any global. */
+    bool calls_functions = false;
+
+    /**
+     * @brief A String or a List may be modified in place: by a standard list function,
+     * by a script function or by an assignment to its alias.
+     */
+    bool modifies_objects = false;
+
+    /** @brief Adds the iteration over the range, which resumes a generator on every step. */
+    void AddIteration(const ast::Expression& range) {
+        if (!IsNeverGenerator(range)) {
+            calls_functions = true;
+            modifies_objects = true;
+        }
+    }
+
+    void Visit(ast::Program& program) override {
+        for (const auto& stmt : program.GetStatements()) {
+            stmt->Accept(*this);
+        }
+    }
+
+    void Visit(ast::BlockStatement& block) override {
+        for (const auto& stmt : block.GetStatements()) {
+            stmt->Accept(*this);
+        }
+    }
+
+    void Visit(ast::AssignStatement& stmt) override {
+        assigned.insert(stmt.ident->name);
+        stmt.expr->Accept(*this);
+
+        // the Evaluator copies a String or a List into the object the name refers to
+        if (dynamic_cast<ast::Identifier*>(stmt.expr.get()) == nullptr && !IsValueTypeExpression(*stmt.expr)) {
+            modifies_objects = true;
+        }
+    }
+
+    void Visit(ast::OperatorAssignStatement& stmt) override {
+        assigned.insert(stmt.ident->name);
+        stmt.expr->Accept(*this);
+    }
+
+    void Visit(ast::CallExpression& expr) override {
+        for (const auto& arg : expr.arguments) {
+            arg->Accept(*this);
+        }
+
+        const std::string* callee = GetStandardCallee(expr);
+
+        if (callee == nullptr) {
+            expr.function->Accept(*this);
+        }
+
+        if (callee != nullptr && MayDrainGenerator(expr, *callee)) {
+            calls_functions = true;
+            modifies_objects = true;
+            return;
+        }
+
+        if (callee != nullptr && (kPureFunctions.contains(*callee) || kValuePreservingFunctions.contains(*callee))) {
+            return;
+        }
+
+        if (callee == nullptr || !kListModifyingFunctions.contains(*callee)) {
+            calls_functions = true;
+        }
+
+        modifies_objects = true;
+    }
+
+    void Visit(ast::InlinedCallExpression& expr) override {
+        for (const auto& arg : expr.arguments) {
+            arg->Accept(*this);
+        }
+
+        expr.body->Accept(*this);
+    }
+
+    void Visit(ast::ForStatement& stmt) override {
+        assigned.insert(stmt.iter->name);
+        stmt.range->Accept(*this);
+        AddIteration(*stmt.range);
+        stmt.body->Accept(*this);
+    }
+
+    void Visit(ast::WhileStatement& stmt) override {
+        stmt.condition->Accept(*this);
+        stmt.body->Accept(*this);
+    }
+
+    void Visit(ast::IfExpression& expr) override {
+        for (auto& alternative : expr.alternatives) {
+            if (alternative.condition != nullptr) {
+                alternative.condition->Accept(*this);
+            }
+
+            alternative.consequence->Accept(*this);
+        }
+    }
+
+    void Visit(ast::ExpressionStatement& stmt) override { stmt.expr->Accept(*this); }
+    void Visit(ast::PrefixExpression& expr) override { expr.right->Accept(*this); }
+    void Visit(ast::InvariantExpression& expr) override { expr.expr->Accept(*this); }
+
+    void Visit(ast::InfixExpression& expr) override {
+        expr.left->Accept(*this);
+        expr.right->Accept(*this);
+    }
+
+    void Visit(ast::LogicalExpression& expr) override {
+        expr.left->Accept(*this);
+        expr.right->Accept(*this);
+    }
+
+    void Visit(ast::IndexOperatorExpression& expr) override {
+        expr.operand->Accept(*this);
+
+        if (expr.index != nullptr) {
+            expr.index->Accept(*this);
+        }
+
+        if (expr.second_index != nullptr) {
+            expr.second_index->Accept(*this);
+        }
+    }
+
+    void Visit(ast::ListLiteral& list) override {
+        for (const auto& element : list.elements) {
+            element->Accept(*this);
+        }
+    }
+
+    void Visit(ast::ReturnStatement& stmt) override {
+        if (stmt.expr != nullptr) {
+            stmt.expr->Accept(*this);
+        }
+    }
+
+    void Visit(ast::YieldStatement& stmt) override {
+        if (stmt.expr != nullptr) {
+            stmt.expr->Accept(*this);
+        }
+
+        // the consumer runs while the generator is suspended and may assign any global or modify any object
+        calls_functions = true;
+        modifies_objects = true;
+    }
+
+    void Visit(ast::Identifier&) override {}
+    void Visit(ast::IntegerLiteral&) override {}
+    void Visit(ast::BooleanLiteral&) override {}
+    void Visit(ast::NullTypeLiteral&) override {}
+    void Visit(ast::FloatLiteral&) override {}
+    void Visit(ast::StringLiteral&) override {}
+    void Visit(ast::FunctionLiteral&) override {}
+    void Visit(ast::BreakStatement&) override {}
+    void Visit(ast::ContinueStatement&) override {}
+};
+
+/**
+ * @class InvariantHoister
+ * @brief Replaces the largest loop-invariant expressions of a loop with ast::InvariantExpression.
+ *
+ * @details An expression is invariant if it consists of literals, operators, indexing and pure
+ * standard calls, and reads only the names the loop doesn't assign. A name which may refer
+ * to a global is also variable if the loop calls a script function.
+ */
+class InvariantHoister : public ast::AstVisitor {
+public:
+    /** @param frame_size Size of the frame the loop is executed in, the hoisted values get new slots in it. */
+    InvariantHoister(const LoopEffects& effects, uint32_t& frame_size)
+        : effects_(effects), frame_size_(frame_size) {}
+
+    /** @brief Hoists the invariant parts of the expression evaluated on every iteration. */
+    void HoistFrom(std::shared_ptr<ast::Expression>& expr) {
+        if (IsInvariant(*expr)) {
+            Hoist(expr);
+        }
+    }
+
+    void Visit(ast::Program& program) override {
+        for (const auto& stmt : program.GetStatements()) {
+            stmt->Accept(*this);
+        }
+    }
+
+    void Visit(ast::BlockStatement& block) override {
+        for (const auto& stmt : block.GetStatements()) {
+            stmt->Accept(*this);
+        }
+    }
+
+    void Visit(ast::ExpressionStatement& stmt) override { HoistFrom(stmt.expr); }
+    void Visit(ast::AssignStatement& stmt) override { HoistFrom(stmt.expr); }
+    void Visit(ast::OperatorAssignStatement& stmt) override { HoistFrom(stmt.expr); }
+
+    void Visit(ast::ReturnStatement& stmt) override {
+        if (stmt.expr != nullptr) {
+            HoistFrom(stmt.expr);
+        }
+    }
+
+    void Visit(ast::YieldStatement& stmt) override {
+        if (stmt.expr != nullptr) {
+            HoistFrom(stmt.expr);
+        }
+    }
+
+    void Visit(ast::WhileStatement& stmt) override {
+        HoistFrom(stmt.condition);
+        stmt.body->Accept(*this);
+    }
+
+    void Visit(ast::ForStatement& stmt) override {
+        HoistFrom(stmt.range);
+        stmt.body->Accept(*this);
+    }
+
+    void Visit(ast::IfExpression& expr) override {
+        for (auto& alternative : expr.alternatives) {
+            if (alternative.condition != nullptr) {
+                HoistFrom(alternative.condition);
+            }
+
+            alternative.consequence->Accept(*this);
+        }
+
+        invariant_ = false;
+    }
+
+    void Visit(ast::Identifier& ident) override {
+        invariant_ = !effects_.assigned.contains(ident.name)
+            && (ident.binding.IsAlwaysLocal() || !effects_.calls_functions);
+    }
+
+    void Visit(ast::InvariantExpression& expr) override {
+        invariant_ = IsInvariant(*expr.expr);
+    }
+
+    void Visit(ast::PrefixExpression& expr) override {
+        invariant_ = IsInvariant(*expr.right);
+    }
+
+    void Visit(ast::InfixExpression& expr) override {
+        invariant_ = AreInvariant({&expr.left, &expr.right});
+    }
+
+    void Visit(ast::LogicalExpression& expr) override {
+        invariant_ = AreInvariant({&expr.left, &expr.right});
+    }
+
+    void Visit(ast::IndexOperatorExpression& expr) override {
+        invariant_ = AreInvariant({&expr.operand, &expr.index, &expr.second_index});
+    }
+
+    void Visit(ast::CallExpression& expr) override {
+        std::vector<std::shared_ptr<ast::Expression>*> args;
+        args.reserve(expr.arguments.size());
+
+        for (auto& arg : expr.arguments) {
+            args.push_back(&arg);
+        }
+
+        const std::string* callee = GetStandardCallee(expr);
+        bool is_pure = callee != nullptr && kPureFunctions.contains(*callee) && !MayDrainGenerator(expr, *callee);
+
+        invariant_ = AreInvariant(std::move(args), is_pure);
+    }
+
+    void Visit(ast::InlinedCallExpression& expr) override {
+        std::vector<std::shared_ptr<ast::Expression>*> args;
+        args.reserve(expr.arguments.size());
+
+        for (auto& arg : expr.arguments) {
+            args.push_back(&arg);
+        }
+
+        // the body reads the slots of the arguments, which are set on every call
+        AreInvariant(std::move(args), false);
+        invariant_ = false;
+    }
+
+    void Visit(ast::ListLiteral& list) override {
+        std::vector<std::shared_ptr<ast::Expression>*> elements;
+        elements.reserve(list.elements.size());
+
+        for (auto& element : list.elements) {
+            elements.push_back(&element);
+        }
+
+        // a new list is created every time, it can't be kept
+        AreInvariant(std::move(elements), false);
+        invariant_ = false;
+    }
+
+    void Visit(ast::IntegerLiteral&) override { invariant_ = true; }
+    void Visit(ast::BooleanLiteral&) override { invariant_ = true; }
+    void Visit(ast::NullTypeLiteral&) override { invariant_ = true; }
+    void Visit(ast::FloatLiteral&) override { invariant_ = true; }
+    void Visit(ast::StringLiteral&) override { invariant_ = true; }
+    void Visit(ast::FunctionLiteral&) override { invariant_ = false; }
+    void Visit(ast::BreakStatement&) override {}
+    void Visit(ast::ContinueStatement&) override {}
+
+private:
+    const LoopEffects& effects_;
+    uint32_t& frame_size_;
+    bool invariant_ = false;
+
+    bool IsInvariant(ast::Expression& expr) {
+        invariant_ = false;
+        expr.Accept(*this);
+        return invariant_;
+    }
+
+    /**
+     * @brief Checks the operands of an expression. If they are not all invariant
+     * or the expression itself can't be, hoists the invariant ones.
+     * @param operands Operands of the expression, nullptr ones are absent.
+     */
+    bool AreInvariant(std::vector<std::shared_ptr<ast::Expression>*> operands, bool can_be_invariant = true) {
+        std::vector<std::shared_ptr<ast::Expression>*> invariant_operands;
+        size_t present = 0;
+
+        for (std::shared_ptr<ast::Expression>* operand : operands) {
+            if (*operand == nullptr) {
+                continue;
+            }
+
+            ++present;
+
+            if (IsInvariant(**operand)) {
+                invariant_operands.push_back(operand);
+            }
+        }
+
+        if (can_be_invariant && invariant_operands.size() == present) {
+            return true;
+        }
+
+        for (std::shared_ptr<ast::Expression>* operand : invariant_operands) {
+            Hoist(*operand);
+        }
+
+        return false;
+    }
+
+    /** @brief Checks if keeping the value of the invariant expression saves anything. */
+    static bool IsWorthHoisting(const ast::Expression& expr) {
+        if (dynamic_cast<const ast::InvariantExpression*>(&expr) != nullptr) {
+            return true;
+        }
+
+        if (auto* call = dynamic_cast<const ast::CallExpression*>(&expr)) {
+            // other pure functions create strings and lists
+            const std::string* callee = GetStandardCallee(*call);
+            return callee != nullptr && kNumericFunctions.contains(*callee);
+        }
+
+        if (dynamic_cast<const ast::PrefixExpression*>(&expr) == nullptr
+            && dynamic_cast<const ast::InfixExpression*>(&expr) == nullptr
+            && dynamic_cast<const ast::IndexOperatorExpression*>(&expr) == nullptr) {
+            return false;
+        }
+
+        // an expression of literals is left unfolded only if it fails or builds a big value
+        std::vector<ast::Binding> inputs;
+        CollectInputs(expr, inputs);
+        return !inputs.empty();
+    }
+
+    void Hoist(std::shared_ptr<ast::Expression>& expr) {
+        if (!IsWorthHoisting(*expr)) {
+            return;
+        }
+
+        auto hoisted = std::dynamic_pointer_cast<ast::InvariantExpression>(expr);
+
+        // an expression hoisted from a nested loop moves to this one
+        if (hoisted == nullptr) {
+            hoisted = std::make_shared<ast::InvariantExpression>(expr->token);
+            hoisted->expr = std::move(expr);
+        }
+
+        hoisted->slot = frame_size_++;
+        hoisted->inputs.clear();
+
+        if (effects_.modifies_objects) {
+            CollectInputs(*hoisted->expr, hoisted->inputs);
+        }
+
+        expr = std::move(hoisted);
+    }
+};
+
+/**
+ * @class InlinedBodyCopier
+ * @brief Copies the expression returned by an inlined function to the call site.
+ *
+ * @details The local slots of the function frame are moved by the offset to the free slots
+ * of the caller frame, the globals stay the same: a function sees no locals of its caller.
+ * Only operators, literals, indexing and calls by name are copied, and only up to the size limit.
+ */
+class InlinedBodyCopier {
+public:
+    /** @param function_global Global slot of the function, its body must not refer to it. */
+    InlinedBodyCopier(uint32_t offset, uint32_t function_global)
+        : offset_(offset), function_global_(function_global) {}
+
+    /** @return The copy, nullptr if the expression can't be inlined. */
+    std::shared_ptr<ast::Expression> Copy(const ast::Expression& expr) {
+        if (++size_ > Optimizer::kMaxInlinedSize) {
+            return nullptr;
+        }
+
+        if (auto* ident = dynamic_cast<const ast::Identifier*>(&expr)) {
+            return CopyIdentifier(*ident);
+        }
+
+        if (auto* call = dynamic_cast<const ast::CallExpression*>(&expr)) {
+            auto* callee = dynamic_cast<const ast::Identifier*>(call->function.get());
+            auto copy = std::make_shared<ast::CallExpression>(*call);
+            copy->cache = {};
+
+            if (callee == nullptr || (copy->function = CopyIdentifier(*callee)) == nullptr) {
+                return nullptr;
+            }
+
+            return CopyOperands(copy->arguments) ? copy : nullptr;
+        }
+
+        if (auto* inlined = dynamic_cast<const ast::InlinedCallExpression*>(&expr)) {
+            auto copy = std::make_shared<ast::InlinedCallExpression>(*inlined);
+            copy->slots_begin += offset_;
+            copy->slots_end += offset_;
+            return CopyOperands(copy->arguments) && CopyOperand(copy->body) ? copy : nullptr;
+        }
+
+        if (auto* logical = dynamic_cast<const ast::LogicalExpression*>(&expr)) {
+            auto copy = std::make_shared<ast::LogicalExpression>(*logical);
+            copy->cache = {};
+            return CopyOperand(copy->left) && CopyOperand(copy->right) ? copy : nullptr;
+        }
+
+        if (auto* infix = dynamic_cast<const ast::InfixExpression*>(&expr)) {
+            auto copy = std::make_shared<ast::InfixExpression>(*infix);
+            copy->cache = {};
+            return CopyOperand(copy->left) && CopyOperand(copy->right) ? copy : nullptr;
+        }
+
+        if (auto* prefix = dynamic_cast<const ast::PrefixExpression*>(&expr)) {
+            auto copy = std::make_shared<ast::PrefixExpression>(*prefix);
+            return CopyOperand(copy->right) ? copy : nullptr;
+        }
+
+        if (auto* index = dynamic_cast<const ast::IndexOperatorExpression*>(&expr)) {
+            auto copy = std::make_shared<ast::IndexOperatorExpression>(*index);
+            copy->cache = {};
+            return CopyOperand(copy->operand) && CopyOperand(copy->index) && CopyOperand(copy->second_index)
+                ? copy
+                : nullptr;
+        }
+
+        if (auto* list = dynamic_cast<const ast::ListLiteral*>(&expr)) {
+            auto copy = std::make_shared<ast::ListLiteral>(*list);
+            return CopyOperands(copy->elements) ? copy : nullptr;
+        }
+
+        if (auto* literal = dynamic_cast<const ast::IntegerLiteral*>(&expr)) {
+            return std::make_shared<ast::IntegerLiteral>(*literal);
+        }
+
+        if (auto* literal = dynamic_cast<const ast::FloatLiteral*>(&expr)) {
+            return std::make_shared<ast::FloatLiteral>(*literal);
+        }
+
+        if (auto* literal = dynamic_cast<const ast::BooleanLiteral*>(&expr)) {
+            return std::make_shared<ast::BooleanLiteral>(*literal);
+        }
+
+        if (auto* literal = dynamic_cast<const ast::NullTypeLiteral*>(&expr)) {
+            return std::make_shared<ast::NullTypeLiteral>(*literal);
+        }
+
+        if (auto* literal = dynamic_cast<const ast::StringLiteral*>(&expr)) {
+            return std::make_shared<ast::StringLiteral>(*literal);
+        }
+
+        // function literals, if-expressions and hoisted values depend on the scopes of the function
+        return nullptr;
+    }
+
+private:
+    uint32_t offset_;
+    uint32_t function_global_;
+    size_t size_ = 0;
+
+    std::shared_ptr<ast::Identifier> CopyIdentifier(const ast::Identifier& ident) {
+        // a recursive function or the one passing itself somewhere
+        if (ident.binding.locals.empty() && ident.binding.global == function_global_) {
+            return nullptr;
+        }
+
+        auto copy = std::make_shared<ast::Identifier>(ident);
+        copy->cache = {};
+
+        for (uint32_t& slot : copy->binding.locals) {
+            slot += offset_;
+        }
+
+        return copy;
+    }
+
+    /** @brief Replaces the operand with its copy, an absent operand is left as is. */
+    bool CopyOperand(std::shared_ptr<ast::Expression>& operand) {
+        if (operand != nullptr) {
+            operand = Copy(*operand);
+            return operand != nullptr;
+        }
+
+        return true;
+    }
+
+    bool CopyOperands(std::vector<std::shared_ptr<ast::Expression>>& operands) {
+        return std::ranges::all_of(operands, [this](auto& operand) { return CopyOperand(operand); });
+    }
+};
+
+/** @brief Returns the length of the String or the List, 0 for the other values. */
+size_t GetSequenceSize(const Value& value) {
+    if (value.IsOfType<String>()) {
+        return value.Get<String>()->size();
+    }
+
+    if (value.IsOfType<List>()) {
+        return value.Get<List>()->size();
+    }
+
+    return 0;
+}
+
+/** @brief Checks if the operation builds a sequence too big to be a literal, e.g. "a" * 1000000. */
+bool IsTooBigToFold(TokenType oper, const Value& left, const Value& right) {
+    if (oper != TokenType::kAsterisk || left.IsReferenceType() == right.IsReferenceType()) {
+        return false;
+    }
+
+    const Value& sequence = left.IsReferenceType() ? left : right;
+    const Value& times = left.IsReferenceType() ? right : left;
+
+    if (!times.IsOfType<Int>() && !times.IsOfType<Float>()) {
+        return false;
+    }
+
+    double count = times.IsOfType<Int>() ? static_cast<double>(times.Get<Int>()) : times.Get<Float>();
+    return count * static_cast<double>(std::max<size_t>(GetSequenceSize(sequence), 1)) > Optimizer::kMaxFoldedSize;
+}
+
+/** @brief Checks if range() with the arguments builds a small list, so it is worth folding. */
+bool IsSmallRange(const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 3 || !std::ranges::all_of(args, &Value::IsOfType<Int>)) {
+        return false;
+    }
+
+    double start = args.size() == 1 ? 0 : static_cast<double>(args[0].Get<Int>());
+    double end = static_cast<double>(args[args.size() == 1 ? 0 : 1].Get<Int>());
+    double step = args.size() == 3 ? static_cast<double>(args[2].Get<Int>()) : 1;
+
+    return step != 0 && (end - start) / step <= Optimizer::kMaxFoldedSize;
+}
+
+} // namespace
+
+void Optimizer::Optimize(ast::Program& program, const Resolver* resolver) {
+    resolver_ = resolver;
+    frame_size_ = &program.frame_size;
+    constants_.clear();
+    functions_.clear();
+
+    // the operators report errors at the current token, which must not point to a replaced node
+    const Token* current_token = evaluator_.current_token_;
+    program.Accept(*this);
+    evaluator_.current_token_ = current_token;
+}
+
+void Optimizer::Optimize(std::shared_ptr<ast::Expression>& expr) {
+    replacement_ = nullptr;
+    expr->Accept(*this);
+
+    if (replacement_ != nullptr) {
+        expr = std::move(replacement_);
+    }
+}
+
+void Optimizer::RecordConstant(const ast::AssignStatement& stmt) {
+    const ast::Binding& binding = stmt.ident->binding;
+
+    if (!binding.locals.empty() || binding.global == ast::Binding::kNoGlobal
+        || resolver_->GetGlobalWrites(binding.global) != 1) {
+        return;
+    }
+
+    // a Function can't be assigned again, and the literal itself is never modified
+    if (auto func = std::dynamic_pointer_cast<ast::FunctionLiteral>(stmt.expr)) {
+        functions_[binding.global] = std::move(func);
+        return;
+    }
+
+    std::optional<Value> value = GetLiteralValue(*stmt.expr);
+
+    if (value.has_value() && !value->IsReferenceType()) {
+        constants_[binding.global] = std::move(*value);
+    }
+}
+
+std::optional<Value> Optimizer::EvalPureCall(const ast::CallExpression& expr) {
+    auto* ident = dynamic_cast<const ast::Identifier*>(expr.function.get());
+
+    // a parameter or a loop variable may shadow the standard function, those are always local
+    if (ident == nullptr || ident->binding.IsAlwaysLocal() || !kPureFunctions.contains(ident->name)) {
+        return std::nullopt;
+    }
+
+    const stdlib::ValueHandlingFunction* func = evaluator_.std_lib_.FindValueHandlingFunc(ident->name);
+    if (func == nullptr) {
+        return std::nullopt;
+    }
+
+    std::vector<Value> args;
+    args.reserve(expr.arguments.size());
+
+    for (const auto& arg : expr.arguments) {
+        std::optional<Value> value = GetLiteralValue(*arg);
+        if (!value.has_value()) {
+            return std::nullopt;
+        }
+
+        args.push_back(std::move(*value));
+    }
+
+    if (ident->name == "range" && !IsSmallRange(args)) {
+        return std::nullopt;
+    }
+
+    try {
+        return (*func)(args, expr.token, CallStack{});
+    } catch (const lang_exceptions::LangException&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<Value> Optimizer::GetLiteralValue(const ast::Expression& expr) {
+    if (auto* literal = dynamic_cast<const ast::IntegerLiteral*>(&expr)) {
+        return Value{literal->value};
+    }
+
+    if (auto* literal = dynamic_cast<const ast::FloatLiteral*>(&expr)) {
+        return Value{literal->value};
+    }
+
+    if (auto* literal = dynamic_cast<const ast::BooleanLiteral*>(&expr)) {
+        return Value{literal->value};
+    }
+
+    if (dynamic_cast<const ast::NullTypeLiteral*>(&expr) != nullptr) {
+        return Value{};
+    }
+
+    if (auto* literal = dynamic_cast<const ast::StringLiteral*>(&expr)) {
+        return Value{CreateString(literal->value)};
+    }
+
+    if (auto* literal = dynamic_cast<const ast::ListLiteral*>(&expr)) {
+        std::vector<Value> elements;
+        elements.reserve(literal->elements.size());
+
+        for (const auto& element : literal->elements) {
+            std::optional<Value> value = GetLiteralValue(*element);
+            if (!value.has_value()) {
+                return std::nullopt;
+            }
+
+            elements.push_back(std::move(*value));
+        }
+
+        return Value{CreateList(std::move(elements))};
+    }
+
+    return std::nullopt;
+}
+
+std::shared_ptr<ast::Expression> Optimizer::MakeLiteral(const Value& value, const Token& token) {
+    Token literal_token = token;
+    literal_token.literal = value.ToString();
+
+    switch (value.GetType()) {
+        case ValueType::kInt: {
+            literal_token.type = TokenType::kInt;
+            auto literal = std::make_shared<ast::IntegerLiteral>(literal_token);
+            literal->value = value.Get<Int>();
+            return literal;
+        }
+        case ValueType::kFloat: {
+            literal_token.type = TokenType::kFloat;
+            auto literal = std::make_shared<ast::FloatLiteral>(literal_token);
+            literal->value = value.Get<Float>();
+            return literal;
+        }
+        case ValueType::kBool: {
+            literal_token.type = value.Get<Bool>() ? TokenType::kTrue : TokenType::kFalse;
+            auto literal = std::make_shared<ast::BooleanLiteral>(literal_token);
+            literal->value = value.Get<Bool>();
+            return literal;
+        }
+        case ValueType::kNullType:
+            literal_token.type = TokenType::kNil;
+            return std::make_shared<ast::NullTypeLiteral>(literal_token);
+        case ValueType::kString: {
+            if (value.Get<String>()->size() > kMaxFoldedSize) {
+                return nullptr;
+            }
+
+            literal_token.type = TokenType::kStringLiteral;
+            auto literal = std::make_shared<ast::StringLiteral>(literal_token);
+            literal->value = *value.Get<String>();
+            return literal;
+        }
+        case ValueType::kList: {
+            const List& list = value.Get<List>();
+
+            if (list->size() > kMaxFoldedSize) {
+                return nullptr;
+            }
+
+            literal_token.type = TokenType::kLBracket;
+            literal_token.literal = "[";
+            auto literal = std::make_shared<ast::ListLiteral>(literal_token);
+
+            for (const Value& element : list->data()) {
+                std::shared_ptr<ast::Expression> element_literal = MakeLiteral(element, token);
+                if (element_literal == nullptr) {
+                    return nullptr;
+                }
+
+                literal->elements.push_back(std::move(element_literal));
+            }
+
+            return literal;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+void Optimizer::Replace(const std::optional<Value>& value, const Token& token) {
+    if (value.has_value()) {
+        replacement_ = MakeLiteral(*value, token);
+    }
+}
+
+void Optimizer::Visit(ast::Program& program) {
+    for (const auto& stmt : program.GetStatements()) {
+        stmt->Accept(*this);
+
+        // top-level statements are executed once and in order, so the value is known after it
+        if (auto* assign = dynamic_cast<ast::AssignStatement*>(stmt.get()); assign && resolver_) {
+            RecordConstant(*assign);
+        }
+    }
+}
+
+void Optimizer::Visit(ast::BlockStatement& block) {
+    for (const auto& stmt : block.GetStatements()) {
+        stmt->Accept(*this);
+    }
+
+    RemoveDeadStatements(block.GetStatements());
+}
+
+void Optimizer::RemoveDeadStatements(std::vector<std::shared_ptr<ast::Statement>>& statements) {
+    std::vector<std::shared_ptr<ast::Statement>> alive;
+
+    for (size_t i = 0; i < statements.size(); ++i) {
+        std::shared_ptr<ast::Statement> stmt = statements[i];
+
+        if (auto* loop = dynamic_cast<ast::WhileStatement*>(stmt.get())) {
+            std::optional<Value> condition = GetLiteralValue(*loop->condition);
+
+            // the loop only evaluates to nil
+            if (condition.has_value() && !condition->IsTruphy()) {
+                auto nil = std::make_shared<ast::ExpressionStatement>(loop->token);
+                nil->expr = MakeLiteral(Value{}, loop->token);
+                stmt = std::move(nil);
+            }
+        }
+
+        // break and continue keep the value of the previous statement as the value of the block
+        bool is_overwritten = i + 1 < statements.size()
+            && dynamic_cast<ast::BreakStatement*>(statements[i + 1].get()) == nullptr
+            && dynamic_cast<ast::ContinueStatement*>(statements[i + 1].get()) == nullptr;
+
+        auto* expr_stmt = dynamic_cast<ast::ExpressionStatement*>(stmt.get());
+
+        if (is_overwritten && expr_stmt != nullptr && GetLiteralValue(*expr_stmt->expr).has_value()) {
+            continue;
+        }
+
+        alive.push_back(stmt);
+
+        // the rest of the block is unreachable
+        if (dynamic_cast<ast::ReturnStatement*>(stmt.get()) || dynamic_cast<ast::BreakStatement*>(stmt.get())
+            || dynamic_cast<ast::ContinueStatement*>(stmt.get())) {
+            break;
+        }
+    }
+
+    statements = std::move(alive);
+}
+
+void Optimizer::Visit(ast::FunctionLiteral& func) {
+    uint32_t* frame_size = frame_size_;
+    frame_size_ = &func.frame_size;
+
+    func.body->Accept(*this);
+
+    frame_size_ = frame_size;
+}
+
+void Optimizer::Visit(ast::ForStatement& stmt) {
+    Optimize(stmt.range);
+    stmt.body->Accept(*this);
+
+    LoopEffects effects;
+    effects.assigned.insert(stmt.iter->name);
+    effects.AddIteration(*stmt.range);
+    stmt.body->Accept(effects);
+
+    // the range is evaluated once, before the iterations
+    InvariantHoister hoister{effects, *frame_size_};
+    stmt.invariants_begin = *frame_size_;
+    stmt.body->Accept(hoister);
+    stmt.invariants_end = *frame_size_;
+}
+
+void Optimizer::Visit(ast::WhileStatement& stmt) {
+    Optimize(stmt.condition);
+    stmt.body->Accept(*this);
+
+    LoopEffects effects;
+    stmt.condition->Accept(effects);
+    stmt.body->Accept(effects);
+
+    InvariantHoister hoister{effects, *frame_size_};
+    stmt.invariants_begin = *frame_size_;
+    hoister.HoistFrom(stmt.condition);
+    stmt.body->Accept(hoister);
+    stmt.invariants_end = *frame_size_;
+}
+
+void Optimizer::Visit(ast::IfExpression& expr) {
+    std::vector<ast::IfBranch>& alternatives = expr.alternatives;
+
+    for (size_t i = 0; i < alternatives.size();) {
+        if (alternatives[i].condition != nullptr) {
+            Optimize(alternatives[i].condition);
+        }
+
+        alternatives[i].consequence->Accept(*this);
+
+        std::optional<Value> condition = alternatives[i].condition != nullptr
+            ? GetLiteralValue(*alternatives[i].condition)
+            : std::nullopt;
+
+        if (!condition.has_value()) {
+            ++i;
+        } else if (condition->IsTruphy()) {
+            alternatives.erase(alternatives.begin() + i + 1, alternatives.end());
+            break;
+        } else {
+            alternatives.erase(alternatives.begin() + i);
+        }
+    }
+
+    if (alternatives.empty()) {
+        replacement_ = MakeLiteral(Value{}, expr.token);
+    } else if (alternatives.front().condition == nullptr) {
+        // the first branch must have a condition, the else-branch is always taken
+        alternatives.front().condition = MakeLiteral(Value{true}, alternatives.front().token);
+    }
+}
+
+void Optimizer::Visit(ast::InvariantExpression& expr) {
+    Optimize(expr.expr);
+}
+
+void Optimizer::Visit(ast::Identifier& ident) {
+    if (!ident.binding.locals.empty()) {
+        return;
+    }
+
+    if (auto it = constants_.find(ident.binding.global); it != constants_.end()) {
+        Replace(it->second, ident.token);
+    }
+}
+
+void Optimizer::Visit(ast::AssignStatement& stmt) {
+    Optimize(stmt.expr);
+}
+
+void Optimizer::Visit(ast::OperatorAssignStatement& stmt) {
+    Optimize(stmt.expr);
+}
+
+void Optimizer::Visit(ast::ExpressionStatement& stmt) {
+    Optimize(stmt.expr);
+}
+
+void Optimizer::Visit(ast::ReturnStatement& stmt) {
+    if (stmt.expr != nullptr) {
+        Optimize(stmt.expr);
+    }
+}
+
+void Optimizer::Visit(ast::YieldStatement& stmt) {
+    if (stmt.expr != nullptr) {
+        Optimize(stmt.expr);
+    }
+}
+
+void Optimizer::Visit(ast::PrefixExpression& expr) {
+    Optimize(expr.right);
+
+    std::optional<Value> right = GetLiteralValue(*expr.right);
+    if (!right.has_value()) {
+        return;
+    }
+
+    evaluator_.current_token_ = &expr.token;
+
+    try {
+        Replace(evaluator_.HandleUnaryOper(expr.oper, *right), expr.token);
+    } catch (const lang_exceptions::LangException&) {
+        // reported when evaluated
+    }
+}
+
+void Optimizer::Visit(ast::InfixExpression& expr) {
+    Optimize(expr.left);
+    Optimize(expr.right);
+
+    std::optional<Value> left = GetLiteralValue(*expr.left);
+    std::optional<Value> right = GetLiteralValue(*expr.right);
+
+    if (!left.has_value() || !right.has_value() || IsTooBigToFold(expr.oper, *left, *right)) {
+        return;
+    }
+
+    evaluator_.current_token_ = &expr.token;
+
+    try {
+        Replace(evaluator_.HandleBinaryOper(expr.oper, *left, *right), expr.token);
+    } catch (const lang_exceptions::LangException&) {
+        // reported when evaluated
+    }
+}
+
+void Optimizer::Visit(ast::LogicalExpression& expr) {
+    Optimize(expr.left);
+    Optimize(expr.right);
+
+    std::optional<Value> left = GetLiteralValue(*expr.left);
+    if (!left.has_value()) {
+        return;
+    }
+
+    // false decides `and`, true decides `or`
+    if (left->IsTruphy() != (expr.oper == TokenType::kAnd)) {
+        Replace(Value{left->IsTruphy()}, expr.token);
+    } else if (std::optional<Value> right = GetLiteralValue(*expr.right)) {
+        Replace(Value{right->IsTruphy()}, expr.token);
+    }
+}
+
+void Optimizer::Visit(ast::IndexOperatorExpression& expr) {
+    Optimize(expr.operand);
+
+    if (expr.index != nullptr) {
+        Optimize(expr.index);
+    }
+
+    if (expr.second_index != nullptr) {
+        Optimize(expr.second_index);
+    }
+}
+
+void Optimizer::Visit(ast::CallExpression& expr) {
+    for (auto& arg : expr.arguments) {
+        Optimize(arg);
+    }
+
+    if (dynamic_cast<ast::Identifier*>(expr.function.get()) == nullptr) {
+        Optimize(expr.function);
+    }
+
+    Replace(EvalPureCall(expr), expr.token);
+
+    if (replacement_ == nullptr) {
+        replacement_ = Inline(expr);
+    }
+}
+
+void Optimizer::Visit(ast::InlinedCallExpression& expr) {
+    for (auto& arg : expr.arguments) {
+        Optimize(arg);
+    }
+
+    Optimize(expr.body);
+}
+
+std::shared_ptr<ast::Expression> Optimizer::Inline(const ast::CallExpression& expr) {
+    const ast::FunctionLiteral* func = nullptr;
+    uint32_t function_global = ast::Binding::kNoGlobal;
+
+    if (auto* ident = dynamic_cast<const ast::Identifier*>(expr.function.get())) {
+        // an assignment to a standard name fails, the standard function is called anyway
+        auto it = ident->binding.locals.empty() && !evaluator_.std_lib_.Has(ident->name)
+            ? functions_.find(ident->binding.global)
+            : functions_.end();
+
+        if (it != functions_.end()) {
+            func = it->second.get();
+            function_global = it->first;
+        }
+    } else {
+        func = dynamic_cast<const ast::FunctionLiteral*>(expr.function.get());
+    }
+
+    // a wrong number of arguments is reported by the call
+    if (func == nullptr || func->parameters.size() != expr.arguments.size()) {
+        return nullptr;
+    }
+
+    const auto& statements = func->body->GetStatements();
+    auto* ret = statements.size() == 1 ? dynamic_cast<const ast::ReturnStatement*>(statements[0].get()) : nullptr;
+
+    if (ret == nullptr || ret->expr == nullptr) {
+        return nullptr;
+    }
+
+    InlinedBodyCopier copier{*frame_size_, function_global};
+    std::shared_ptr<ast::Expression> body = copier.Copy(*ret->expr);
+
+    if (body == nullptr) {
+        return nullptr;
+    }
+
+    auto inlined = std::make_shared<ast::InlinedCallExpression>(expr.token);
+    inlined->function_name = expr.function_name.value_or("<anonymous function>");
+    inlined->arguments = expr.arguments;
+    inlined->body = std::move(body);
+    inlined->slots_begin = *frame_size_;
+    inlined->slots_end = *frame_size_ + func->frame_size;
+
+    *frame_size_ = inlined->slots_end;
+    return inlined;
+}
+
+void Optimizer::Visit(ast::ListLiteral& list) {
+    for (auto& element : list.elements) {
+        Optimize(element);
+    }
+}
+
+} // namespace itmoscript
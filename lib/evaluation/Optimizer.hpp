@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/AstVisitor.hpp"
+#include "ast/AST.hpp"
+#include "objects/Value.hpp"
+
+namespace itmoscript {
+
+class Evaluator;
+class Resolver;
+
+/**
+ * @class Optimizer
+ * @brief Rewrites the resolved program before the evaluation, replacing the expressions
+ * with known values by literals.
+ *
+ * @details The optimizations are:
+ * 1. Constant folding: prefix, infix and logical expressions of literals are computed.
+ * 2. Constant propagation: a global assigned once, at the top level, with a number, a boolean or nil
+ *    is replaced by its value in all the code after the assignment.
+ *    Strings and lists are not propagated: they are modified in place through the aliases.
+ * 3. Pure standard functions (e.g. len, sqrt, small ranges) called with literals are computed.
+ * 4. Dead code elimination: statements after return, break and continue, branches with false conditions
+ *    and loops with false conditions are removed.
+ * 5. Loop-invariant code motion: the largest expressions of a loop whose values don't change
+ *    between the iterations are replaced with ast::InvariantExpression, which keeps the value
+ *    in a new slot of the frame after the first evaluation.
+ * 6. Inlining: a call of a function which only returns an expression is replaced
+ *    with ast::InlinedCallExpression, if the function is known before the call: it is a literal
+ *    or a global assigned once, at the top level. Recursive functions are not inlined.
+ *
+ * The values are computed by the operators and the standard library of the Evaluator,
+ * so the results are the same as at runtime. An expression which fails (e.g. 1 / 0)
+ * is left as is to report the error when it is actually evaluated.
+ */
+class Optimizer : public ast::AstVisitor {
+public:
+    /** @brief Largest list or string produced by the optimizer, bigger ones are built at runtime. */
+    static constexpr size_t kMaxFoldedSize = 64;
+
+    /** @brief Largest number of nodes in the returned expression of an inlined function. */
+    static constexpr size_t kMaxInlinedSize = 32;
+
+    explicit Optimizer(Evaluator& evaluator)
+        : evaluator_(evaluator) {}
+
+    Optimizer(const Optimizer&) = delete;
+    Optimizer(Optimizer&&) = delete;
+    Optimizer& operator=(const Optimizer&) = delete;
+    Optimizer& operator=(Optimizer&&) = delete;
+    ~Optimizer() = default;
+
+    /**
+     * @brief Optimizes the program, which must be resolved already.
+     * @param resolver Resolver of the program, tells which globals are assigned only once.
+     * If it's nullptr, globals are not propagated: e.g. in the REPL the next program may assign them again.
+     */
+    void Optimize(ast::Program& program, const Resolver* resolver);
+
+private:
+    Evaluator& evaluator_;
+    const Resolver* resolver_ = nullptr;
+
+    /** @brief Number of local slots of the frame being optimized, the hoisted values are added to it. */
+    uint32_t* frame_size_ = nullptr;
+
+    /** @brief Values of the propagated globals by their slots. */
+    std::unordered_map<uint32_t, Value> constants_;
+
+    /** @brief Functions which may be inlined by their global slots. */
+    std::unordered_map<uint32_t, std::shared_ptr<ast::FunctionLiteral>> functions_;
+
+    /** @brief Node to replace the visited expression with, set by the visitor. */
+    std::shared_ptr<ast::Expression> replacement_;
+
+    /** @brief Optimizes the expression, replacing it if its value is known. */
+    void Optimize(std::shared_ptr<ast::Expression>& expr);
+
+    /** @brief Remembers the value or the function of the global if it is a constant for the rest of the program. */
+    void RecordConstant(const ast::AssignStatement& stmt);
+
+    /**
+     * @brief Creates the inlined call if the called function is known and small.
+     * @return nullptr if the call can't be inlined.
+     */
+    std::shared_ptr<ast::Expression> Inline(const ast::CallExpression& expr);
+
+    /** @brief Computes the pure standard function called with literals. */
+    std::optional<Value> EvalPureCall(const ast::CallExpression& expr);
+
+    /** @brief Returns the value of the literal, std::nullopt if the expression is not a literal. */
+    static std::optional<Value> GetLiteralValue(const ast::Expression& expr);
+
+    /**
+     * @brief Creates the literal with the value, placed at the token of the replaced expression.
+     * @return nullptr if the value has no literal (e.g. a Function) or is too big.
+     */
+    static std::shared_ptr<ast::Expression> MakeLiteral(const Value& value, const Token& token);
+
+    /** @brief Sets the replacement to the literal with the value, if there is one. */
+    void Replace(const std::optional<Value>& value, const Token& token);
+
+    /** @brief Removes the unreachable statements and the literals whose values are never used. */
+    void RemoveDeadStatements(std::vector<std::shared_ptr<ast::Statement>>& statements);
+
+    // Visitor implementation
+
+    void Visit(ast::Program&) override;
+    void Visit(ast::ExpressionStatement&) override;
+    void Visit(ast::PrefixExpression&) override;
+    void Visit(ast::InfixExpression&) override;
+    void Visit(ast::LogicalExpression&) override;
+    void Visit(ast::InvariantExpression&) override;
+    void Visit(ast::IndexOperatorExpression&) override;
+
+    void Visit(ast::Identifier&) override;
+    void Visit(ast::IntegerLiteral&) override {}
+    void Visit(ast::BooleanLiteral&) override {}
+    void Visit(ast::NullTypeLiteral&) override {}
+    void Visit(ast::FloatLiteral&) override {}
+    void Visit(ast::StringLiteral&) override {}
+    void Visit(ast::FunctionLiteral&) override;
+    void Visit(ast::ListLiteral&) override;
+
+    void Visit(ast::IfExpression&) override;
+    void Visit(ast::BlockStatement&) override;
+    void Visit(ast::AssignStatement&) override;
+    void Visit(ast::OperatorAssignStatement&) override;
+    void Visit(ast::CallExpression&) override;
+    void Visit(ast::InlinedCallExpression&) override;
+    void Visit(ast::ReturnStatement&) override;
+    void Visit(ast::YieldStatement&) override;
+
+    void Visit(ast::WhileStatement&) override;
+    void Visit(ast::ForStatement&) override;
+    void Visit(ast::BreakStatement&) override {}
+    void Visit(ast::ContinueStatement&) override {}
+};
+
+} // namespace itmoscript
@@ -0,0 +1,98 @@
+#include "OutputSink.hpp"
+
+#include <cstring>
+
+namespace itmoscript {
+
+OutputSink::Scope::Scope(OutputSink& sink, std::istream& input, std::ostream& output)
+    : sink_(sink),
+      input_(input),
+      tied_(input.tie()),
+      stream_(&sink) {
+    sink_.Flush();
+    sink_.target_ = output.rdbuf();
+
+    // reading the input flushes the output first
+    input_.tie(&stream_);
+}
+
+OutputSink::Scope::~Scope() {
+    input_.tie(tied_);
+    sink_.Flush();
+    sink_.target_ = nullptr;
+}
+
+OutputSink::OutputSink(Policy policy, size_t buffer_size)
+    : policy_(policy), buffer_(buffer_size) {}
+
+void OutputSink::SetPolicy(Policy policy) {
+    Flush();
+    policy_ = policy;
+}
+
+std::streamsize OutputSink::xsputn(const char* data, std::streamsize count) {
+    size_t size = static_cast<size_t>(count);
+
+    if (size_ + size > buffer_.size()) {
+        if (!Drain()) {
+            return 0;
+        }
+
+        // a long text is passed on without copying
+        if (size >= buffer_.size()) {
+            if (target_ == nullptr || target_->sputn(data, count) != count) {
+                return 0;
+            }
+
+            size = 0;
+        }
+    }
+
+    std::memcpy(buffer_.data() + size_, data, size);
+    size_ += size;
+
+    if (policy_ == Policy::kNone || (policy_ == Policy::kLine && std::memchr(data, '\n', count) != nullptr)) {
+        if (!Flush()) {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+OutputSink::int_type OutputSink::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+
+    char c = traits_type::to_char_type(ch);
+    return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+int OutputSink::sync() {
+    return Flush() ? 0 : -1;
+}
+
+bool OutputSink::Drain() {
+    if (size_ == 0) {
+        return true;
+    }
+
+    if (target_ == nullptr) {
+        return false;
+    }
+
+    std::streamsize count = static_cast<std::streamsize>(size_);
+    size_ = 0;
+    return target_->sputn(buffer_.data(), count) == count;
+}
+
+bool OutputSink::Flush() {
+    if (!Drain()) {
+        return false;
+    }
+
+    return target_ == nullptr || target_->pubsync() == 0;
+}
+
+} // namespace itmoscript
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace itmoscript {
+
+/**
+ * @class OutputSink
+ * @brief Buffer the output of print()/println() collects in before it reaches the output stream.
+ *
+ * @details The policy decides when the collected text is passed on and the output stream is flushed:
+ * - kLine: after every line, like a terminal. The default.
+ * - kBlock: when the buffer is full and at the end of the evaluation. Fastest for output redirected to a file.
+ * - kNone: after every write.
+ *
+ * Whatever the policy, the output is flushed before the program reads the input, so prompts are visible,
+ * and when the evaluation ends, also by an error.
+ *
+ * @example
+ * ```
+ * OutputSink::Scope scope{sink, std::cin, std::cout};
+ * scope.stream() << "text";
+ * ```
+ */
+class OutputSink : public std::streambuf {
+public:
+    enum class Policy {
+        kLine,
+        kBlock,
+        kNone,
+    };
+
+    static constexpr size_t kDefaultBufferSize = size_t{1} << 16;
+
+    /**
+     * @class Scope
+     * @brief Connects the sink to the output stream for the time of an evaluation.
+     * On destruction the output is flushed and the input is tied back to its previous stream.
+     */
+    class Scope {
+    public:
+        Scope(OutputSink& sink, std::istream& input, std::ostream& output);
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+        /** @brief Stream writing to the sink. */
+        std::ostream& stream() { return stream_; }
+
+    private:
+        OutputSink& sink_;
+        std::istream& input_;
+        std::ostream* tied_;
+        std::ostream stream_;
+    };
+
+    explicit OutputSink(Policy policy = Policy::kLine, size_t buffer_size = kDefaultBufferSize);
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    /** @brief Changes the policy, the text collected so far is flushed. */
+    void SetPolicy(Policy policy);
+    Policy policy() const { return policy_; }
+
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    Policy policy_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+
+    /** @brief Buffer of the output stream, nullptr outside of a Scope. */
+    std::streambuf* target_ = nullptr;
+
+    /** @brief Passes the collected text to the output stream. */
+    bool Drain();
+
+    /** @brief Drains the buffer and flushes the output stream. */
+    bool Flush();
+};
+
+} // namespace itmoscript
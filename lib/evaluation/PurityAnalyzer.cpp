@@ -0,0 +1,158 @@
+#include "PurityAnalyzer.hpp"
+#include "StandardFunctions.hpp"
+
+namespace itmoscript {
+
+bool PurityAnalyzer::Analyze(ast::BlockStatement& body) {
+    pure_ = true;
+    callees_.clear();
+
+    body.Accept(*this);
+    return pure_;
+}
+
+bool PurityAnalyzer::IsLocal(const ast::Identifier& ident) const {
+    const ast::Binding& binding = ident.binding;
+    return binding.IsAlwaysLocal() || (!binding.locals.empty() && !defined_globals_.contains(binding.global));
+}
+
+void PurityAnalyzer::Visit(ast::Program& program) {
+    for (const auto& stmt : program.GetStatements()) {
+        stmt->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::BlockStatement& block) {
+    for (const auto& stmt : block.GetStatements()) {
+        stmt->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::ExpressionStatement& stmt) {
+    stmt.expr->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::PrefixExpression& expr) {
+    expr.right->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::InfixExpression& expr) {
+    expr.left->Accept(*this);
+    expr.right->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::LogicalExpression& expr) {
+    expr.left->Accept(*this);
+    expr.right->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::InvariantExpression& expr) {
+    expr.expr->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::IndexOperatorExpression& expr) {
+    expr.operand->Accept(*this);
+
+    if (expr.index != nullptr) {
+        expr.index->Accept(*this);
+    }
+
+    if (expr.second_index != nullptr) {
+        expr.second_index->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::Identifier& ident) {
+    if (!IsLocal(ident)) {
+        pure_ = false;
+    }
+}
+
+void PurityAnalyzer::Visit(ast::ListLiteral& list) {
+    for (const auto& element : list.elements) {
+        element->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::IfExpression& expr) {
+    for (auto& alternative : expr.alternatives) {
+        if (alternative.condition != nullptr) {
+            alternative.condition->Accept(*this);
+        }
+
+        alternative.consequence->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::AssignStatement& stmt) {
+    stmt.ident->Accept(*this);
+    stmt.expr->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::OperatorAssignStatement& stmt) {
+    stmt.ident->Accept(*this);
+    stmt.expr->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::CallExpression& expr) {
+    for (const auto& arg : expr.arguments) {
+        arg->Accept(*this);
+    }
+
+    auto* ident = dynamic_cast<ast::Identifier*>(expr.function.get());
+
+    // a function held by a local comes from the arguments or from a call, it can't be checked
+    if (ident == nullptr || ident->binding.IsAlwaysLocal()) {
+        pure_ = false;
+        return;
+    }
+
+    // standard names can't be assigned, so the name always refers to the standard function
+    if (std_lib_.Has(ident->name)) {
+        if (!kPureFunctions.contains(ident->name) && !kListModifyingFunctions.contains(ident->name)) {
+            pure_ = false;
+        }
+
+        return;
+    }
+
+    // a name assigned in the body may refer to a local instead
+    if (!ident->binding.locals.empty()) {
+        pure_ = false;
+        return;
+    }
+
+    callees_.push_back(Callee{.name = &ident->name, .global = ident->binding.global});
+}
+
+void PurityAnalyzer::Visit(ast::InlinedCallExpression& expr) {
+    for (const auto& arg : expr.arguments) {
+        arg->Accept(*this);
+    }
+
+    expr.body->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::ReturnStatement& stmt) {
+    if (stmt.expr != nullptr) {
+        stmt.expr->Accept(*this);
+    }
+}
+
+void PurityAnalyzer::Visit(ast::YieldStatement&) {
+    // the call returns a new generator each time, the cached one would be drained by the first consumer
+    pure_ = false;
+}
+
+void PurityAnalyzer::Visit(ast::WhileStatement& stmt) {
+    stmt.condition->Accept(*this);
+    stmt.body->Accept(*this);
+}
+
+void PurityAnalyzer::Visit(ast::ForStatement& stmt) {
+    stmt.iter->Accept(*this);
+    stmt.range->Accept(*this);
+    stmt.body->Accept(*this);
+}
+
+} // namespace itmoscript
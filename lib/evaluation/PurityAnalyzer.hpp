@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ast/AstVisitor.hpp"
+#include "ast/AST.hpp"
+#include "stdlib/StdLib.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class PurityAnalyzer
+ * @brief Checks if the result of a function depends only on its arguments, so the calls may be memoized.
+ *
+ * @details The body of a pure function:
+ * 1. reads and assigns only its own locals, never a global, so it neither sees nor changes the state
+ *    of the program. A local falls back to the global of the same name if the global is defined,
+ *    so the names of the globals assigned at the top level can't be locals of a pure function;
+ * 2. calls only the standard functions without side effects (the list functions are allowed:
+ *    with the arguments and the globals out of reach, they may only modify the lists created by the call)
+ *    and the global functions, which have to be pure too.
+ *
+ * The global callees can't be checked statically: the globals get their values at runtime.
+ * They are collected, and the caller checks the functions they hold.
+ * Nested function literals are skipped: their bodies are executed only by a call.
+ */
+class PurityAnalyzer : public ast::AstVisitor {
+public:
+    /** @brief Global function called by the body by name. */
+    struct Callee {
+        const std::string* name;
+        uint32_t global;
+    };
+
+    /** @param defined_globals Global slots assigned at the top level, see Resolver::defined_globals(). */
+    PurityAnalyzer(const stdlib::StdLib& std_lib, const std::unordered_set<uint32_t>& defined_globals)
+        : std_lib_(std_lib), defined_globals_(defined_globals) {}
+
+    PurityAnalyzer(const PurityAnalyzer&) = delete;
+    PurityAnalyzer(PurityAnalyzer&&) = delete;
+    PurityAnalyzer& operator=(const PurityAnalyzer&) = delete;
+    PurityAnalyzer& operator=(PurityAnalyzer&&) = delete;
+    ~PurityAnalyzer() = default;
+
+    /**
+     * @brief Analyzes the body of the function.
+     * @return false if the body is impure by itself, otherwise it's pure if all the callees() are.
+     */
+    bool Analyze(ast::BlockStatement& body);
+
+    /** @brief Global functions called by the last analyzed body. */
+    const std::vector<Callee>& callees() const { return callees_; }
+
+private:
+    const stdlib::StdLib& std_lib_;
+    const std::unordered_set<uint32_t>& defined_globals_;
+    bool pure_ = true;
+    std::vector<Callee> callees_;
+
+    /** @brief Checks if the identifier always refers to a local of the function. */
+    bool IsLocal(const ast::Identifier& ident) const;
+
+    // Visitor implementation
+
+    void Visit(ast::Program&) override;
+    void Visit(ast::ExpressionStatement&) override;
+    void Visit(ast::PrefixExpression&) override;
+    void Visit(ast::InfixExpression&) override;
+    void Visit(ast::LogicalExpression&) override;
+    void Visit(ast::InvariantExpression&) override;
+    void Visit(ast::IndexOperatorExpression&) override;
+
+    void Visit(ast::Identifier&) override;
+    void Visit(ast::IntegerLiteral&) override {}
+    void Visit(ast::BooleanLiteral&) override {}
+    void Visit(ast::NullTypeLiteral&) override {}
+    void Visit(ast::FloatLiteral&) override {}
+    void Visit(ast::StringLiteral&) override {}
+    void Visit(ast::FunctionLiteral&) override {}
+    void Visit(ast::ListLiteral&) override;
+
+    void Visit(ast::IfExpression&) override;
+    void Visit(ast::BlockStatement&) override;
+    void Visit(ast::AssignStatement&) override;
+    void Visit(ast::OperatorAssignStatement&) override;
+    void Visit(ast::CallExpression&) override;
+    void Visit(ast::InlinedCallExpression&) override;
+    void Visit(ast::ReturnStatement&) override;
+    void Visit(ast::YieldStatement&) override;
+
+    void Visit(ast::WhileStatement&) override;
+    void Visit(ast::ForStatement&) override;
+    void Visit(ast::BreakStatement&) override {}
+    void Visit(ast::ContinueStatement&) override {}
+};
+
+} // namespace itmoscript
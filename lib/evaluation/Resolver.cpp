@@ -0,0 +1,268 @@
+#include "Resolver.hpp"
+
+#include <algorithm>
+
+namespace itmoscript {
+
+void Resolver::Resolve(ast::Program& program) {
+    frames_.clear();
+    global_writes_.clear();
+    program.Accept(*this);
+}
+
+uint32_t Resolver::GetGlobalWrites(uint32_t slot) const {
+    auto it = global_writes_.find(slot);
+    return it != global_writes_.end() ? it->second : 0;
+}
+
+void Resolver::CountWrite(const ast::Binding& binding) {
+    if (binding.global != ast::Binding::kNoGlobal) {
+        ++global_writes_[binding.global];
+    }
+
+    if (binding.locals.empty()) {
+        defined_globals_.insert(binding.global);
+    }
+}
+
+Resolver::Frame& Resolver::frame() {
+    return frames_.back();
+}
+
+uint32_t Resolver::GetGlobalSlot(const std::string& name) {
+    auto [it, inserted] = globals_.try_emplace(name, static_cast<uint32_t>(globals_.size()));
+    return it->second;
+}
+
+ast::Binding Resolver::Bind(const std::string& name) {
+    ast::Binding binding;
+
+    for (auto scope = frame().scopes.rbegin(); scope != frame().scopes.rend(); ++scope) {
+        auto it = scope->names.find(name);
+        if (it == scope->names.end()) {
+            continue;
+        }
+
+        binding.locals.push_back(it->second.slot);
+
+        if (it->second.always_defined) {
+            return binding;
+        }
+    }
+
+    binding.global = GetGlobalSlot(name);
+    return binding;
+}
+
+void Resolver::PushScope() {
+    Scope scope;
+    scope.begin = frame().next_slot;
+    scope.end = frame().next_slot;
+    frame().scopes.push_back(std::move(scope));
+}
+
+void Resolver::PopScope() {
+    frame().next_slot = frame().scopes.back().begin;
+    frame().scopes.pop_back();
+}
+
+void Resolver::Declare(const std::string& name, bool always_defined) {
+    Scope& current = frame().scopes.back();
+
+    if (current.names.contains(name)) {
+        return;
+    }
+
+    // parameters and loop variables shadow the outer names, assignments modify them
+    for (const Scope& scope : frame().scopes) {
+        auto it = scope.names.find(name);
+        if (!always_defined && it != scope.names.end() && it->second.always_defined) {
+            return;
+        }
+    }
+
+    current.names[name] = Local{.slot = current.end, .always_defined = always_defined};
+    ++current.end;
+
+    frame().next_slot = current.end;
+    frame().size = std::max(frame().size, current.end);
+}
+
+void Resolver::DeclareAssignedNames(const ast::BlockStatement& block) {
+    for (const auto& stmt : block.GetStatements()) {
+        if (auto* assign = dynamic_cast<ast::AssignStatement*>(stmt.get())) {
+            Declare(assign->ident->name, false);
+        }
+    }
+}
+
+void Resolver::ResolveStatements(const ast::BlockStatement& block) {
+    for (const auto& stmt : block.GetStatements()) {
+        stmt->Accept(*this);
+    }
+}
+
+void Resolver::Visit(ast::Program& program) {
+    // the top level itself is the global scope, so the frame starts without scopes
+    frames_.emplace_back();
+
+    for (const auto& stmt : program.GetStatements()) {
+        stmt->Accept(*this);
+    }
+
+    program.frame_size = frame().size;
+    frames_.pop_back();
+}
+
+void Resolver::Visit(ast::BlockStatement& block) {
+    PushScope();
+    DeclareAssignedNames(block);
+
+    block.slots_begin = frame().scopes.back().begin;
+    block.slots_end = frame().scopes.back().end;
+
+    ResolveStatements(block);
+    PopScope();
+}
+
+void Resolver::Visit(ast::FunctionLiteral& func) {
+    frames_.emplace_back();
+    PushScope();
+
+    for (const auto& param : func.parameters) {
+        Declare(param->name, true);
+    }
+
+    for (size_t i = 0; i < func.parameters.size(); ++i) {
+        // a repeated parameter is reported when the literal is evaluated
+        func.parameters[i]->binding = Bind(func.parameters[i]->name);
+    }
+
+    DeclareAssignedNames(*func.body);
+
+    func.body->slots_begin = frame().scopes.back().begin;
+    func.body->slots_end = frame().scopes.back().end;
+
+    ResolveStatements(*func.body);
+
+    PopScope();
+    func.frame_size = frame().size;
+    frames_.pop_back();
+}
+
+void Resolver::Visit(ast::ForStatement& stmt) {
+    stmt.range->Accept(*this);
+
+    // every iteration has its own scope with the loop variable, the body is a nested block
+    PushScope();
+    Declare(stmt.iter->name, true);
+    stmt.iter->binding = Bind(stmt.iter->name);
+
+    stmt.body->Accept(*this);
+    PopScope();
+}
+
+void Resolver::Visit(ast::WhileStatement& stmt) {
+    stmt.condition->Accept(*this);
+    stmt.body->Accept(*this);
+}
+
+void Resolver::Visit(ast::IfExpression& expr) {
+    for (auto& alternative : expr.alternatives) {
+        if (alternative.condition != nullptr) {
+            alternative.condition->Accept(*this);
+        }
+
+        alternative.consequence->Accept(*this);
+    }
+}
+
+void Resolver::Visit(ast::Identifier& ident) {
+    ident.binding = Bind(ident.name);
+}
+
+void Resolver::Visit(ast::AssignStatement& stmt) {
+    stmt.expr->Accept(*this);
+    stmt.ident->binding = Bind(stmt.ident->name);
+    CountWrite(stmt.ident->binding);
+}
+
+void Resolver::Visit(ast::OperatorAssignStatement& stmt) {
+    stmt.expr->Accept(*this);
+    stmt.ident->binding = Bind(stmt.ident->name);
+    CountWrite(stmt.ident->binding);
+}
+
+void Resolver::Visit(ast::ExpressionStatement& stmt) {
+    stmt.expr->Accept(*this);
+}
+
+void Resolver::Visit(ast::ReturnStatement& stmt) {
+    if (stmt.expr != nullptr) {
+        stmt.expr->Accept(*this);
+    }
+}
+
+void Resolver::Visit(ast::YieldStatement& stmt) {
+    if (stmt.expr != nullptr) {
+        stmt.expr->Accept(*this);
+    }
+}
+
+void Resolver::Visit(ast::PrefixExpression& expr) {
+    expr.right->Accept(*this);
+}
+
+void Resolver::Visit(ast::InfixExpression& expr) {
+    expr.left->Accept(*this);
+    expr.right->Accept(*this);
+}
+
+void Resolver::Visit(ast::LogicalExpression& expr) {
+    expr.left->Accept(*this);
+    expr.right->Accept(*this);
+}
+
+void Resolver::Visit(ast::InvariantExpression& expr) {
+    expr.expr->Accept(*this);
+
+    // the slot was added by the Optimizer after the previous resolution
+    frame().size = std::max(frame().size, expr.slot + 1);
+}
+
+void Resolver::Visit(ast::IndexOperatorExpression& expr) {
+    expr.operand->Accept(*this);
+
+    if (expr.index != nullptr) {
+        expr.index->Accept(*this);
+    }
+
+    if (expr.second_index != nullptr) {
+        expr.second_index->Accept(*this);
+    }
+}
+
+void Resolver::Visit(ast::CallExpression& expr) {
+    for (auto& arg : expr.arguments) {
+        arg->Accept(*this);
+    }
+
+    expr.function->Accept(*this);
+}
+
+void Resolver::Visit(ast::InlinedCallExpression& expr) {
+    for (auto& arg : expr.arguments) {
+        arg->Accept(*this);
+    }
+
+    // the body was resolved in the frame of the function, the Optimizer moved its slots to this one
+    frame().size = std::max(frame().size, expr.slots_end);
+}
+
+void Resolver::Visit(ast::ListLiteral& list) {
+    for (auto& element : list.elements) {
+        element->Accept(*this);
+    }
+}
+
+} // namespace itmoscript
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ast/AstVisitor.hpp"
+#include "ast/AST.hpp"
+
+namespace itmoscript {
+
+/** @brief Maps global names to their slots in the global Environment. */
+using GlobalSlots = std::unordered_map<std::string, uint32_t>;
+
+/**
+ * @class Resolver
+ * @brief Assigns storage slots to all identifiers of the program, so the evaluation
+ * doesn't need to look names up by string.
+ * 
+ * @details Runs after Parser::ParseProgram() and fills the ast::Binding of every identifier,
+ * the slot ranges of blocks and the frame sizes of functions and of the program.
+ * 
+ * The scoping rules are the ones of the language:
+ * 1. Every function call and the top-level program have their own frame of local slots.
+ *    Names assigned at the top level (outside of any block) are global.
+ * 2. Every non-empty block opens a scope inside the current frame. A name assigned directly
+ *    in the block gets a slot of that scope, which is used only if no outer scope
+ *    defines the name by the time of the assignment.
+ * 3. Function parameters and loop variables are always defined in their scopes.
+ * 4. Functions don't see the locals of the enclosing code, only their own locals and globals.
+ * 
+ * Global slots are kept in the given table, so globals stay the same between several
+ * programs resolved with it (e.g. in the REPL).
+ */
+class Resolver : public ast::AstVisitor {
+public:
+    explicit Resolver(GlobalSlots& globals)
+        : globals_(globals) {}
+
+    Resolver(const Resolver&) = delete;
+    Resolver(Resolver&&) = delete;
+    Resolver& operator=(const Resolver&) = delete;
+    Resolver& operator=(Resolver&&) = delete;
+    ~Resolver() = default;
+
+    /** @brief Resolves all identifiers of the program. Resolving the same program again is a no-op. */
+    void Resolve(ast::Program& program);
+
+    /** @brief Returns the number of the assignments to the global slot in the resolved program. */
+    uint32_t GetGlobalWrites(uint32_t slot) const;
+
+    /**
+     * @brief Returns the global slots assigned at the top level, outside of any block.
+     * Only these assignments define a global, the others write it only if it's defined already.
+     */
+    const std::unordered_set<uint32_t>& defined_globals() const { return defined_globals_; }
+
+private:
+    struct Local {
+        uint32_t slot;
+        bool always_defined;
+    };
+
+    struct Scope {
+        std::unordered_map<std::string, Local> names;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    struct Frame {
+        std::vector<Scope> scopes;
+        uint32_t next_slot = 0;
+        uint32_t size = 0;
+    };
+
+    GlobalSlots& globals_;
+    std::vector<Frame> frames_;
+
+    /** @brief Assignments per global slot. An assignment to a name with a global fallback is counted too. */
+    std::unordered_map<uint32_t, uint32_t> global_writes_;
+
+    std::unordered_set<uint32_t> defined_globals_;
+
+    Frame& frame();
+
+    /** @brief Returns the global slot of the name, registering it if needed. */
+    uint32_t GetGlobalSlot(const std::string& name);
+
+    /** @brief Computes the binding of the name in the current scope chain. */
+    ast::Binding Bind(const std::string& name);
+
+    /** @brief Counts the assignment to the identifier if it may modify a global. */
+    void CountWrite(const ast::Binding& binding);
+
+    /** @brief Opens a scope in the current frame. */
+    void PushScope();
+
+    /** @brief Closes the innermost scope, its slots can be reused by the next scopes. */
+    void PopScope();
+
+    /**
+     * @brief Allocates a slot for the name in the innermost scope.
+     * Does nothing if the name already has a slot there or if an outer scope of the frame
+     * always defines it (so the assignment never defines the name in this scope).
+     */
+    void Declare(const std::string& name, bool always_defined);
+
+    /** @brief Declares all the names assigned directly in the block. */
+    void DeclareAssignedNames(const ast::BlockStatement& block);
+
+    /** @brief Resolves the statements of the block in the current scope. */
+    void ResolveStatements(const ast::BlockStatement& block);
+
+    // Visitor implementation
+
+    void Visit(ast::Program&) override;
+    void Visit(ast::ExpressionStatement&) override;
+    void Visit(ast::PrefixExpression&) override;
+    void Visit(ast::InfixExpression&) override;
+    void Visit(ast::LogicalExpression&) override;
+    void Visit(ast::InvariantExpression&) override;
+    void Visit(ast::IndexOperatorExpression&) override;
+
+    void Visit(ast::Identifier&) override;
+    void Visit(ast::IntegerLiteral&) override {}
+    void Visit(ast::BooleanLiteral&) override {}
+    void Visit(ast::NullTypeLiteral&) override {}
+    void Visit(ast::FloatLiteral&) override {}
+    void Visit(ast::StringLiteral&) override {}
+    void Visit(ast::FunctionLiteral&) override;
+    void Visit(ast::ListLiteral&) override;
+
+    void Visit(ast::IfExpression&) override;
+    void Visit(ast::BlockStatement&) override;
+    void Visit(ast::AssignStatement&) override;
+    void Visit(ast::OperatorAssignStatement&) override;
+    void Visit(ast::CallExpression&) override;
+    void Visit(ast::InlinedCallExpression&) override;
+    void Visit(ast::ReturnStatement&) override;
+    void Visit(ast::YieldStatement&) override;
+
+    void Visit(ast::WhileStatement&) override;
+    void Visit(ast::ForStatement&) override;
+    void Visit(ast::BreakStatement&) override {}
+    void Visit(ast::ContinueStatement&) override {}
+};
+
+} // namespace itmoscript
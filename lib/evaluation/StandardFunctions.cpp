@@ -0,0 +1,28 @@
+#include "StandardFunctions.hpp"
+
+namespace itmoscript {
+
+const std::unordered_set<std::string> kPureFunctions = {
+    "len", "range", "abs", "ceil", "floor", "round", "sqrt", "to_string",
+    "lower", "upper", "split", "join", "replace", "type_of",
+};
+
+const std::unordered_set<std::string> kNumericFunctions = {
+    "len", "abs", "ceil", "floor", "round", "sqrt",
+};
+
+const std::unordered_set<std::string> kValuePreservingFunctions = {
+    "print", "println", "read", "rnd", "parse_num", "stacktrace", "gc", "gc_threshold",
+    "file_read", "file_read_lines", "file_lines", "file_write", "file_append", "file_exists",
+    "file_open", "file_write_handle", "file_flush", "file_close",
+};
+
+const std::unordered_set<std::string> kListModifyingFunctions = {
+    "push", "pop", "insert", "remove", "sort", "set",
+};
+
+const std::unordered_set<std::string> kGeneratorDrainingFunctions = {
+    "len", "join", "sort",
+};
+
+} // namespace itmoscript
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+namespace itmoscript {
+
+/**
+ * @brief Standard functions without side effects, their result depends only on the arguments.
+ * Those in kGeneratorDrainingFunctions are pure only for arguments which are not generators.
+ */
+extern const std::unordered_set<std::string> kPureFunctions;
+
+/** @brief Pure standard functions returning numbers. */
+extern const std::unordered_set<std::string> kNumericFunctions;
+
+/** @brief Standard functions with side effects, which modify no values and call no script functions. */
+extern const std::unordered_set<std::string> kValuePreservingFunctions;
+
+/** @brief Standard functions modifying the list passed to them. */
+extern const std::unordered_set<std::string> kListModifyingFunctions;
+
+/** @brief Standard functions draining a Generator argument: its body, which is script code, runs during the call. */
+extern const std::unordered_set<std::string> kGeneratorDrainingFunctions;
+
+} // namespace itmoscript
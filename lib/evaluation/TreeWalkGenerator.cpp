@@ -0,0 +1,117 @@
+#include "TreeWalkGenerator.hpp"
+#include "Evaluator.hpp"
+
+#include "exceptions/ControlFlowError.hpp"
+
+#include <utility>
+
+namespace itmoscript {
+
+TreeWalkGenerator::TreeWalkGenerator(
+    Evaluator& evaluator,
+    const std::string& name,
+    Function func,
+    std::vector<Value>& args
+)
+    : evaluator_(evaluator),
+      name_(name),
+      function_(std::move(func)),
+      frame_(function_.frame_size()),
+      coroutine_([this] { Run(); }) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        args[i].Thaw();
+        frame_.Set(static_cast<uint32_t>(i), std::move(args[i]));
+    }
+}
+
+std::optional<Value> TreeWalkGenerator::Next() {
+    if (coroutine_.finished()) {
+        return std::nullopt;
+    }
+
+    if (running_) {
+        evaluator_.ThrowRuntimeError<lang_exceptions::ControlFlowError>("generator is already running");
+    }
+
+    evaluator_.CheckCallDepth();
+
+    // the body may drop the last handle to the generator
+    Generator self{this};
+
+    const Token* token = evaluator_.current_token_;
+    bool inside_loop = evaluator_.inside_loop_;
+    Evaluator::ExecResult result = std::move(evaluator_.last_exec_result_);
+    TreeWalkGenerator* consumer = std::exchange(evaluator_.generator_, this);
+    ArgumentPool* arguments = std::exchange(evaluator_.arguments_, &arguments_);
+
+    // the frame keeps its storage on the stack for reuse, the values are swapped in
+    std::swap(evaluator_.env_stack_.Push(0), frame_);
+    evaluator_.call_stack_.push_back(CallFrame{.function_name = &name_, .entry_token = token});
+
+    auto leave = [&] {
+        running_ = false;
+
+        if (!coroutine_.finished()) {
+            std::swap(evaluator_.env_stack_.top(), frame_);
+        }
+
+        evaluator_.env_stack_.Pop();
+        evaluator_.call_stack_.pop_back();
+
+        evaluator_.current_token_ = token;
+        evaluator_.inside_loop_ = inside_loop;
+        evaluator_.last_exec_result_ = std::move(result);
+        evaluator_.generator_ = consumer;
+        evaluator_.arguments_ = arguments;
+    };
+
+    running_ = true;
+
+    try {
+        coroutine_.Resume();
+    } catch (...) {
+        leave();
+        throw;
+    }
+
+    leave();
+    return std::exchange(yielded_, std::nullopt);
+}
+
+void TreeWalkGenerator::Yield(Value value) {
+    value.Thaw();
+    yielded_ = std::move(value);
+
+    const Token* token = evaluator_.current_token_;
+    bool inside_loop = evaluator_.inside_loop_;
+
+    coroutine_.Suspend();
+
+    evaluator_.current_token_ = token;
+    evaluator_.inside_loop_ = inside_loop;
+}
+
+void TreeWalkGenerator::ForEachValue(const std::function<void(const Value&)>& func) const {
+    frame_.ForEachValue(func);
+    arguments_.ForEachValue(func);
+
+    if (yielded_.has_value()) {
+        func(*yielded_);
+    }
+}
+
+void TreeWalkGenerator::ReleaseValues() {
+    // the suspended body still refers to the slots and the buffers, so they are emptied, not destroyed
+    frame_.Clear(0, static_cast<uint32_t>(frame_.size()));
+    arguments_.ClearBorrowed();
+    yielded_.reset();
+}
+
+void TreeWalkGenerator::Run() {
+    // loops of the consumer don't enclose the body
+    evaluator_.inside_loop_ = false;
+    evaluator_.current_token_ = &function_.body()->token;
+    evaluator_.EvalStatements(*function_.body());
+}
+
+} // namespace itmoscript
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "objects/Generator.hpp"
+#include "objects/Function.hpp"
+#include "objects/Value.hpp"
+
+#include "evaluation/ArgumentPool.hpp"
+#include "evaluation/Environment.hpp"
+#include "evaluation/NativeStack.hpp"
+
+namespace itmoscript {
+
+class Evaluator;
+
+/**
+ * @class TreeWalkGenerator
+ * @brief Generator created by a call of a generator function in the tree-walking evaluation.
+ *
+ * @details The body is evaluated by the same Evaluator as the rest of the program, but on its own
+ * Coroutine, so `yield` suspends it together with the C++ frames of the enclosing loops and blocks.
+ * While suspended, the generator keeps the frame of the call: Next() puts it on top of the frame stack
+ * and pushes the call stack entry, so the body sees its locals and errors show where it was resumed from.
+ *
+ * The body borrows argument buffers from its own ArgumentPool: it may be suspended while holding them,
+ * which would break the order the shared pool returns them in.
+ */
+class TreeWalkGenerator : public GeneratorObject {
+public:
+    /** @param args Arguments of the call, moved to the parameter slots. */
+    TreeWalkGenerator(Evaluator& evaluator, const std::string& name, Function func, std::vector<Value>& args);
+
+    /** @throws ControlFlowError if the generator is resumed by its own body. */
+    std::optional<Value> Next() override;
+
+    /** @brief Passes the value to the Next() call and suspends the body. Called by the body only. */
+    void Yield(Value value);
+
+    /** @brief Lists the frame of the call and the borrowed arguments, the values on the coroutine's stack are not seen. */
+    void ForEachValue(const std::function<void(const Value&)>& func) const override;
+    void ReleaseValues() override;
+
+private:
+    Evaluator& evaluator_;
+    std::string name_;
+    Function function_;
+
+    /** @brief Frame of the call, while the body is suspended. */
+    Environment frame_;
+    ArgumentPool arguments_;
+
+    std::optional<Value> yielded_;
+    bool running_ = false;
+
+    /** @brief Declared last: a suspended body is unwound first, while the state it refers to is alive. */
+    Coroutine coroutine_;
+
+    /** @brief Evaluates the body, runs on the coroutine. */
+    void Run();
+};
+
+} // namespace itmoscript
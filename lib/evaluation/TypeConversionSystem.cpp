@@ -7,6 +7,11 @@ bool TypeConversionSystem::CanConvert(ValueType from, ValueType to) const {
     return from == to || converters_.contains(key);
 }
 
+const TypeConversionSystem::Converter* TypeConversionSystem::FindConverter(ValueType from, ValueType to) const {
+    auto it = converters_.find(std::make_pair(from, to));
+    return it != converters_.end() ? &it->second : nullptr;
+}
+
 std::optional<Value> TypeConversionSystem::TryConvert(const Value& v, ValueType target) const {
     if (target == v.GetType()) return v;
 
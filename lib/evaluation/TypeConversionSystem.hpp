@@ -25,9 +25,18 @@ public:
     template<CoreValueType From, CoreValueType To>
     using Convertion = std::function<To(const From&)>;
 
+    /** @brief Type-erased convertion of a Value. */
+    using Converter = std::function<Value(const Value&)>;
+
     /** @brief Checks if a conversion from type to type has been registered. */
     bool CanConvert(ValueType from, ValueType to) const;
 
+    /**
+     * @brief Returns the registered conversion from type to type.
+     * @return nullptr if the types are the same or if there's no such conversion.
+     */
+    const Converter* FindConverter(ValueType from, ValueType to) const;
+
     /** @brief Converts value to the given type if a direct conversion exists. Otherwise, returns nullopt. */
     std::optional<Value> TryConvert(const Value& v, ValueType target) const;
 
@@ -57,8 +66,6 @@ public:
     }
 
 private:
-    using Converter = std::function<Value(const Value&)>;
-    
     std::unordered_map<
         std::pair<ValueType, ValueType>,
         Converter,
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "RuntimeError.hpp"
+
+namespace itmoscript {
+
+namespace lang_exceptions {
+
+class ImpureFunctionError : public RuntimeError {
+public:
+    ImpureFunctionError(Token token, const CallStack& call_stack, std::string message) 
+        : RuntimeError(token, call_stack, std::move(message)) {}
+
+    std::string error_type() const noexcept override {
+        return "ImpureFunctionError";
+    }
+};
+    
+} // namespace lang_exceptions
+    
+} // namespace itmoscript
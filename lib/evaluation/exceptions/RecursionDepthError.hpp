@@ -0,0 +1,28 @@
+#pragma once
+
+#include "RuntimeError.hpp"
+
+#include <format>
+#include <cstddef>
+
+namespace itmoscript {
+
+namespace lang_exceptions {
+
+class RecursionDepthError : public RuntimeError {
+public:
+    RecursionDepthError(Token token, const CallStack& call_stack, size_t depth)
+        : RuntimeError(
+            token,
+            call_stack,
+            std::format("maximum call depth exceeded ({} calls)", depth)
+        ) {}
+
+    std::string error_type() const noexcept override {
+        return "RecursionDepthError";
+    }
+};
+    
+} // namespace lang_exceptions
+    
+} // namespace itmoscript
@@ -16,7 +16,21 @@ public:
     RuntimeError(Token token, const CallStack& call_stack, const std::string& message)
         : LangException(std::move(token), message) 
     {
-        call_stack_ = call_stack;
+        // the frames point to the code being executed, so they are copied right away,
+        // the calls repeated by a recursion are stored once
+        for (const CallFrame& frame : call_stack) {
+            if (!call_stack_.empty()
+                && call_stack_.back().line == frame.entry_token->line
+                && call_stack_.back().function_name == *frame.function_name) {
+                ++call_stack_.back().repeated;
+                continue;
+            }
+
+            call_stack_.push_back(TracebackEntry{
+                .function_name = *frame.function_name,
+                .line = frame.entry_token->line,
+            });
+        }
     }
 
     std::string error_type() const noexcept override {
@@ -26,23 +40,30 @@ public:
     std::string GetCallStackMessage() const {
         std::string result = "Traceback (most recent call last):\n";
 
-        for (const CallFrame& frame : call_stack_) {
+        for (const TracebackEntry& frame : call_stack_) {
             result += *utils::MultiplyStr(" ", kErrorDetailsIndent);
             result += frame.function_name;
-            result += std::format(", on line {}", frame.entry_token.line);
+            result += std::format(", on line {}", frame.line);
             result += '\n';
+
+            if (frame.repeated != 0) {
+                result += *utils::MultiplyStr(" ", kErrorDetailsIndent);
+                result += std::format("[previous line repeated {} more times]\n", frame.repeated);
+            }
         }
 
         return result;
     }
 
-    const CallStack& call_stack() const {
-        return call_stack_;
-    }
-
 private:
+    struct TracebackEntry {
+        std::string function_name;
+        size_t line;
+        size_t repeated = 0;
+    };
+
     std::string stacktrace_message_;
-    CallStack call_stack_;
+    std::vector<TracebackEntry> call_stack_;
 };
     
 } // namespace lang_exceptions
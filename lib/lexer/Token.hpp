@@ -67,6 +67,7 @@ enum class TokenType {
     kFunction,
     kEnd,
     kReturn,
+    kYield,
     kOr,
     kAnd,
     kNot,
@@ -152,6 +153,7 @@ inline const std::map<std::string, TokenType> kKeywords{
     {"end", TokenType::kEnd},
     {"nil", TokenType::kNil},
     {"return", TokenType::kReturn},
+    {"yield", TokenType::kYield},
     {"or", TokenType::kOr},
     {"and", TokenType::kAnd},
     {"not", TokenType::kNot},
@@ -232,6 +234,7 @@ inline const std::map<TokenType, std::string> kTokenTypeNames = {
     {TokenType::kFunction, "FUNCTION"},
     {TokenType::kEnd, "END"},
     {TokenType::kReturn, "RETURN"},
+    {TokenType::kYield, "YIELD"},
     {TokenType::kOr, "OR"},
     {TokenType::kAnd, "AND"},
     {TokenType::kNot, "NOT"},
@@ -0,0 +1,212 @@
+#include "CycleCollector.hpp"
+#include "List.hpp"
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace itmoscript {
+
+namespace {
+
+/** @brief Mark of the objects proved to be reachable, the counts are never negative. */
+constexpr int64_t kReachable = -1;
+
+/** @brief Calls the function with the tracked object the value references, if any. */
+template<typename F>
+void VisitTracked(const Value& value, F& func) {
+    if (value.IsOfType<List>()) {
+        func(*value.Get<List>());
+    } else if (value.IsOfType<Generator>()) {
+        func(*value.Get<Generator>());
+    }
+}
+
+/** @brief Calls the function for every tracked object in the buffer. A slice's buffer also holds the elements around it. */
+template<typename F>
+void ForEachTrackedElement(const std::vector<Value>& buffer, F& func) {
+    for (const Value& element : buffer) {
+        VisitTracked(element, func);
+    }
+}
+
+/** @brief Calls the function for every tracked object the generator holds. */
+template<typename F>
+void ForEachTrackedValue(const GeneratorObject& generator, F& func) {
+    generator.ForEachValue([&func](const Value& value) { VisitTracked(value, func); });
+}
+
+} // namespace
+
+CycleCollector& CycleCollector::Instance() {
+    static CycleCollector collector;
+    return collector;
+}
+
+void CycleCollector::Track(ListObject* list) {
+    list->gc_prev_ = nullptr;
+    list->gc_next_ = head_;
+
+    if (head_ != nullptr) {
+        head_->gc_prev_ = list;
+    }
+
+    head_ = list;
+    ++tracked_count_;
+}
+
+void CycleCollector::Untrack(ListObject* list) {
+    if (list->gc_prev_ != nullptr) {
+        list->gc_prev_->gc_next_ = list->gc_next_;
+    } else {
+        head_ = list->gc_next_;
+    }
+
+    if (list->gc_next_ != nullptr) {
+        list->gc_next_->gc_prev_ = list->gc_prev_;
+    }
+
+    --tracked_count_;
+}
+
+void CycleCollector::Track(GeneratorObject* generator) {
+    generator->gc_prev_ = nullptr;
+    generator->gc_next_ = generators_head_;
+
+    if (generators_head_ != nullptr) {
+        generators_head_->gc_prev_ = generator;
+    }
+
+    generators_head_ = generator;
+}
+
+void CycleCollector::Untrack(GeneratorObject* generator) {
+    if (generator->gc_prev_ != nullptr) {
+        generator->gc_prev_->gc_next_ = generator->gc_next_;
+    } else {
+        generators_head_ = generator->gc_next_;
+    }
+
+    if (generator->gc_next_ != nullptr) {
+        generator->gc_next_->gc_prev_ = generator->gc_prev_;
+    }
+}
+
+void CycleCollector::NotifyAllocation() {
+    ++allocations_;
+
+    if (threshold_ != 0 && !collecting_ && allocations_ >= std::max(threshold_, survivors_)) {
+        Collect();
+    }
+}
+
+size_t CycleCollector::Collect() {
+    collecting_ = true;
+    allocations_ = 0;
+
+    for (ListObject* list = head_; list != nullptr; list = list->gc_next_) {
+        list->gc_refs_ = list->ref_count();
+    }
+
+    for (GeneratorObject* generator = generators_head_; generator != nullptr; generator = generator->gc_next_) {
+        generator->gc_refs_ = generator->ref_count();
+    }
+
+    auto unreference = [](auto& object) { --object.gc_refs_; };
+
+    // copies of a list share the buffer of elements, its references are subtracted once
+    ++epoch_;
+
+    for (ListObject* list = head_; list != nullptr; list = list->gc_next_) {
+        if (list->buffer_ == nullptr || list->buffer_->gc_epoch == epoch_) {
+            continue;
+        }
+
+        list->buffer_->gc_epoch = epoch_;
+        ForEachTrackedElement(list->buffer_->values, unreference);
+    }
+
+    for (GeneratorObject* generator = generators_head_; generator != nullptr; generator = generator->gc_next_) {
+        ForEachTrackedValue(*generator, unreference);
+    }
+
+    std::vector<ListObject*> reachable_lists;
+    std::vector<GeneratorObject*> reachable_generators;
+
+    auto mark = [&](auto& object) {
+        if (object.gc_refs_ == kReachable) {
+            return;
+        }
+
+        object.gc_refs_ = kReachable;
+
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(object)>, ListObject>) {
+            reachable_lists.push_back(&object);
+        } else {
+            reachable_generators.push_back(&object);
+        }
+    };
+
+    // objects without handles at all are temporaries owned by the C++ code, they are roots too;
+    // a running generator is a root as well, Next() holds a handle to it
+    for (ListObject* list = head_; list != nullptr; list = list->gc_next_) {
+        if (list->gc_refs_ > 0 || list->ref_count() == 0) {
+            mark(*list);
+        }
+    }
+
+    for (GeneratorObject* generator = generators_head_; generator != nullptr; generator = generator->gc_next_) {
+        if (generator->gc_refs_ > 0 || generator->ref_count() == 0) {
+            mark(*generator);
+        }
+    }
+
+    while (!reachable_lists.empty() || !reachable_generators.empty()) {
+        if (!reachable_lists.empty()) {
+            ListObject* list = reachable_lists.back();
+            reachable_lists.pop_back();
+
+            if (list->buffer_ != nullptr) {
+                ForEachTrackedElement(list->buffer_->values, mark);
+            }
+        } else {
+            GeneratorObject* generator = reachable_generators.back();
+            reachable_generators.pop_back();
+            ForEachTrackedValue(*generator, mark);
+        }
+    }
+
+    // the handles keep the garbage alive until all the cycles are broken
+    std::vector<List> garbage_lists;
+    std::vector<Generator> garbage_generators;
+
+    for (ListObject* list = head_; list != nullptr; list = list->gc_next_) {
+        if (list->gc_refs_ != kReachable) {
+            garbage_lists.emplace_back(list);
+        }
+    }
+
+    for (GeneratorObject* generator = generators_head_; generator != nullptr; generator = generator->gc_next_) {
+        if (generator->gc_refs_ != kReachable) {
+            garbage_generators.emplace_back(generator);
+        }
+    }
+
+    for (const List& list : garbage_lists) {
+        list->buffer_ = nullptr;
+    }
+
+    for (const Generator& generator : garbage_generators) {
+        generator->ReleaseValues();
+    }
+
+    size_t freed = garbage_lists.size() + garbage_generators.size();
+    garbage_lists.clear();
+    garbage_generators.clear();
+
+    survivors_ = tracked_count_;
+    collecting_ = false;
+    return freed;
+}
+
+} // namespace itmoscript
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace itmoscript {
+
+class ListObject;
+class GeneratorObject;
+
+/**
+ * @class CycleCollector
+ * @brief Frees the lists and generators kept alive only by reference cycles, e.g. after push(a, a).
+ *
+ * @details Reference counting alone never frees a cycle, so every ListObject and GeneratorObject
+ * is tracked here, and a collection finds the objects unreachable from outside the tracked set (trial deletion):
+ * 1. each object gets the count of its references which don't come from other tracked objects;
+ * 2. objects with such references are roots, everything reachable from the roots is alive;
+ * 3. the rest are only referenced by each other, so the values they hold are released.
+ *
+ * Lists and generators are the only objects which can form cycles: a Function references no values,
+ * while a suspended generator holds the values of its call, see GeneratorObject::ForEachValue().
+ *
+ * A reference the collector doesn't see only keeps its object alive. So a cycle through a value
+ * the tree-walking evaluation holds on the native stack of a suspended generator, e.g. the sequence
+ * of a for loop the generator is suspended in, is never freed.
+ *
+ * A collection runs automatically when enough lists were allocated since the previous one.
+ * The threshold grows with the number of the lists survived, so the total cost stays linear.
+ */
+class CycleCollector {
+public:
+    static constexpr size_t kDefaultThreshold = 1000;
+
+    /** @brief Returns the collector of the program. Values are never shared between threads. */
+    static CycleCollector& Instance();
+
+    /**
+     * @brief Frees all the unreachable lists and generators.
+     * @return Number of the freed objects.
+     */
+    size_t Collect();
+
+    /** @brief Counts the allocation of the list and runs a collection if the threshold is reached. */
+    void NotifyAllocation();
+
+    /** @brief Sets the number of allocations between automatic collections, 0 disables them. */
+    void SetThreshold(size_t threshold) { threshold_ = threshold; }
+    size_t threshold() const { return threshold_; }
+
+    /** @brief Returns the number of the lists alive. */
+    size_t tracked_count() const { return tracked_count_; }
+
+private:
+    friend class ListObject;
+    friend class GeneratorObject;
+
+    ListObject* head_ = nullptr;
+    size_t tracked_count_ = 0;
+
+    GeneratorObject* generators_head_ = nullptr;
+
+    size_t threshold_ = kDefaultThreshold;
+    size_t allocations_ = 0;
+    size_t survivors_ = 0;
+    uint32_t epoch_ = 0;
+    bool collecting_ = false;
+
+    CycleCollector() = default;
+
+    void Track(ListObject* list);
+    void Untrack(ListObject* list);
+
+    void Track(GeneratorObject* generator);
+    void Untrack(GeneratorObject* generator);
+};
+
+} // namespace itmoscript
@@ -0,0 +1,83 @@
+#include "File.hpp"
+
+#include <utility>
+
+namespace itmoscript {
+
+namespace {
+
+/** @brief Head of the list of the open files. */
+FileObject* open_files = nullptr;
+
+/** @brief Flushes the files left open when the program exits. */
+struct ExitFlush {
+    ~ExitFlush() { FileObject::FlushAll(); }
+} exit_flush;
+
+} // namespace
+
+FileObject::FileObject(std::string path, Mode mode, size_t buffer_size)
+    : path_(std::move(path)), buffer_(buffer_size) {
+    // the buffer must be set before the file is opened
+    file_.rdbuf()->pubsetbuf(buffer_.empty() ? nullptr : buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_.open(path_, mode == Mode::kAppend ? std::ios::binary | std::ios::app : std::ios::binary | std::ios::trunc);
+
+    if (file_.is_open()) {
+        Track();
+    }
+}
+
+FileObject::~FileObject() {
+    Close();
+}
+
+bool FileObject::Write(std::string_view data) {
+    file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return file_.good();
+}
+
+bool FileObject::Flush() {
+    file_.flush();
+    return file_.good();
+}
+
+bool FileObject::Close() {
+    if (!file_.is_open()) {
+        return true;
+    }
+
+    Untrack();
+    file_.close();
+    return !file_.fail();
+}
+
+void FileObject::FlushAll() {
+    for (FileObject* file = open_files; file != nullptr; file = file->next_) {
+        file->Flush();
+    }
+}
+
+void FileObject::Track() {
+    prev_ = nullptr;
+    next_ = open_files;
+
+    if (open_files != nullptr) {
+        open_files->prev_ = this;
+    }
+
+    open_files = this;
+}
+
+void FileObject::Untrack() {
+    if (prev_ != nullptr) {
+        prev_->next_ = next_;
+    } else {
+        open_files = next_;
+    }
+
+    if (next_ != nullptr) {
+        next_->prev_ = prev_;
+    }
+}
+
+} // namespace itmoscript
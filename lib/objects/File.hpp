@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HeapObject.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class FileObject
+ * @brief Implementation of the File underlying type: a file opened for writing by file_open().
+ *
+ * @details Writes go to a user-space buffer of the chosen size and reach the file when it's full,
+ * on file_flush() or on close, so a loop writing many small strings makes few system calls.
+ * The file is closed by file_close() or when the last handle to it is destroyed: when the variable
+ * holding it goes out of scope or when the program ends. Files still open at the exit
+ * (e.g. kept alive by a reference cycle) are flushed too.
+ */
+class FileObject : public HeapObject {
+public:
+    static constexpr size_t kDefaultBufferSize = size_t{1} << 16;
+
+    enum class Mode {
+        kWrite,  // the file is truncated
+        kAppend, // writes go to the end of the file
+    };
+
+    /** @brief Opens the file, check is_open() for the result. A buffer of size 0 makes writes unbuffered. */
+    FileObject(std::string path, Mode mode, size_t buffer_size = kDefaultBufferSize);
+
+    FileObject(const FileObject&) = delete;
+    FileObject& operator=(const FileObject&) = delete;
+    ~FileObject();
+
+    /** @return false if the data could not be written, e.g. the disk is full. */
+    bool Write(std::string_view data);
+
+    /** @return false if the buffered data could not be written. */
+    bool Flush();
+
+    /** @brief Flushes and closes the file. Closing a closed file does nothing. */
+    bool Close();
+
+    bool is_open() const { return file_.is_open(); }
+    const std::string& path() const { return path_; }
+
+    /** @brief Flushes all the open files. Called at the exit of the program. */
+    static void FlushAll();
+
+    bool operator==(const FileObject& other) const {
+        return this == &other;
+    }
+
+private:
+    std::string path_;
+    std::vector<char> buffer_;
+    std::ofstream file_;
+
+    /** @brief Neighbours in the list of the open files. */
+    FileObject* prev_ = nullptr;
+    FileObject* next_ = nullptr;
+
+    void Track();
+    void Untrack();
+};
+
+using File = Ref<FileObject>; // File type used in the language.
+
+} // namespace itmoscript
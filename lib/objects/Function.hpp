@@ -3,23 +3,70 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
 
 #include "ast/AST.hpp"
 
+#include "HeapObject.hpp"
+
 namespace itmoscript {
 
+class MemoTable;
+
+namespace vm {
+
+struct CompiledFunction;
+
+} // namespace vm
+
+/**
+ * @struct FunctionPrototype
+ * @brief Immutable part of a function literal, shared by all the functions created from it.
+ * The literal is turned into the prototype once, so its evaluation only allocates a FunctionObject.
+ */
+struct FunctionPrototype {
+    std::vector<std::shared_ptr<ast::Identifier>> parameters;
+    std::shared_ptr<ast::BlockStatement> body;
+
+    /** @brief Number of local slots a call of the function needs. */
+    uint32_t frame_size = 0;
+
+    /** @brief A call returns a Generator executing the body, see ast::FunctionLiteral::is_generator. */
+    bool is_generator = false;
+
+    /** @brief Bytecode of the body. Null until the function is first compiled by the VM. */
+    mutable std::shared_ptr<const vm::CompiledFunction> compiled;
+
+    /**
+     * @brief Returns the prototype of the literal, building it at the first call.
+     * The literal must be resolved and optimized already: its body and frame size are not copied again.
+     */
+    static const std::shared_ptr<const FunctionPrototype>& Of(ast::FunctionLiteral& literal) {
+        if (literal.prototype == nullptr) {
+            literal.prototype = std::make_shared<FunctionPrototype>(
+                literal.parameters,
+                literal.body,
+                literal.frame_size,
+                literal.is_generator
+            );
+        }
+
+        return literal.prototype;
+    }
+};
+
 /**
  * @brief Represents a function value in the language.
  * Two Function instances are equal only if they are the exact same object.
  */
-struct FunctionObject {
-    FunctionObject(
-        std::shared_ptr<std::vector<std::shared_ptr<ast::Identifier>>> parameters,
-        std::shared_ptr<ast::BlockStatement> body
-    ) : parameters(std::move(parameters)), body(std::move(body)) {}
+struct FunctionObject : public HeapObject {
+    explicit FunctionObject(std::shared_ptr<const FunctionPrototype> prototype, std::shared_ptr<MemoTable> memo = nullptr)
+        : prototype(std::move(prototype)), memo(std::move(memo)) {}
 
-    std::shared_ptr<std::vector<std::shared_ptr<ast::Identifier>>> parameters;
-    std::shared_ptr<ast::BlockStatement> body;
+    std::shared_ptr<const FunctionPrototype> prototype;
+
+    /** @brief Results of the calls of the function created by memoize(), null for the other functions. */
+    std::shared_ptr<MemoTable> memo;
 
     bool operator==(const FunctionObject& other) const {
         return this == &other;
@@ -28,13 +75,11 @@ struct FunctionObject {
 
 class Function {
 public:
-    explicit Function(std::shared_ptr<FunctionObject> obj_) 
+    explicit Function(Ref<FunctionObject> obj_) 
       : obj(std::move(obj_)) {}
       
-    explicit Function(
-        std::shared_ptr<std::vector<std::shared_ptr<ast::Identifier>>> parameters, 
-        std::shared_ptr<ast::BlockStatement> body) 
-      : obj(std::make_shared<FunctionObject>(std::move(parameters), std::move(body))) {}
+    explicit Function(std::shared_ptr<const FunctionPrototype> prototype, std::shared_ptr<MemoTable> memo = nullptr)
+      : obj(MakeRef<FunctionObject>(std::move(prototype), std::move(memo))) {}
 
     bool operator==(const Function& other) const {
         return obj == other.obj;
@@ -44,16 +89,44 @@ public:
         return !(*this == other);
     }
 
+    const FunctionPrototype& prototype() const {
+        return *obj->prototype;
+    }
+
+    const std::shared_ptr<const FunctionPrototype>& shared_prototype() const {
+        return obj->prototype;
+    }
+
+    const std::shared_ptr<MemoTable>& memo() const {
+        return obj->memo;
+    }
+
     const std::vector<std::shared_ptr<ast::Identifier>>& parameters() const {
-        return *obj->parameters;
+        return obj->prototype->parameters;
+    }
+
+    const std::shared_ptr<ast::BlockStatement>& body() const {
+        return obj->prototype->body;
+    }
+
+    uint32_t frame_size() const {
+        return obj->prototype->frame_size;
+    }
+
+    bool is_generator() const {
+        return obj->prototype->is_generator;
+    }
+
+    const std::shared_ptr<const vm::CompiledFunction>& compiled() const {
+        return obj->prototype->compiled;
     }
 
-    std::shared_ptr<ast::BlockStatement> body() const {
-        return obj->body;
+    void set_compiled(std::shared_ptr<const vm::CompiledFunction> compiled) const {
+        obj->prototype->compiled = std::move(compiled);
     }
 
 private:
-    std::shared_ptr<FunctionObject> obj;
+    Ref<FunctionObject> obj;
 };
 
 } // namespace itmoscript
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <optional>
+#include <functional>
+#include <cstdint>
+
+#include "HeapObject.hpp"
+#include "CycleCollector.hpp"
+
+namespace itmoscript {
+
+class Value;
+
+/**
+ * @class GeneratorObject
+ * @brief Implementation of the Generator underlying type: the suspended call of a generator function.
+ *
+ * @details Calling a function whose body contains `yield` doesn't execute the body. It returns
+ * a generator, and the body runs only when the next value is requested: up to the next `yield`,
+ * which suspends it again. So the values are produced one at a time and never stored together.
+ *
+ * Each engine suspends the body its own way, so the object is created by the engine executing the call.
+ * A generator is iterated once: the values it has yielded are gone.
+ *
+ * A suspended generator holds the values of its call, e.g. a list it got as an argument,
+ * and the list may hold the generator, so generators are tracked by the CycleCollector too.
+ */
+class GeneratorObject : public HeapObject {
+public:
+    GeneratorObject() {
+        CycleCollector::Instance().Track(this);
+    }
+
+    GeneratorObject(const GeneratorObject&) = delete;
+    GeneratorObject& operator=(const GeneratorObject&) = delete;
+
+    virtual ~GeneratorObject() {
+        CycleCollector::Instance().Untrack(this);
+    }
+
+    /**
+     * @brief Resumes the body until its next `yield`.
+     * @return The yielded value, std::nullopt once the body has finished.
+     * @throws RuntimeError raised by the body, the generator is finished then.
+     */
+    virtual std::optional<Value> Next() = 0;
+
+    /**
+     * @brief Calls the function for every value the generator holds. Used by the CycleCollector:
+     * the values not listed here keep what they reference alive. A generator holding no values needs no override.
+     */
+    virtual void ForEachValue(const std::function<void(const Value&)>& /* func */) const {}
+
+    /** @brief Destroys the values listed by ForEachValue(). Called by the CycleCollector on a generator never resumed again. */
+    virtual void ReleaseValues() {}
+
+    bool operator==(const GeneratorObject& other) const {
+        return this == &other;
+    }
+
+private:
+    friend class CycleCollector;
+
+    // links of the collector's list of all the GeneratorObjects
+    GeneratorObject* gc_prev_ = nullptr;
+    GeneratorObject* gc_next_ = nullptr;
+
+    /** @brief References not coming from the tracked objects, computed during a collection. */
+    int64_t gc_refs_ = 0;
+};
+
+using Generator = Ref<GeneratorObject>; // Generator type used in the language.
+
+} // namespace itmoscript
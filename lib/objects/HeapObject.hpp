@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace itmoscript {
+
+template<typename T>
+class Ref;
+
+/**
+ * @class HeapObject
+ * @brief Base of the objects the reference types (String, List, Function) point to.
+ *
+ * @details The reference count is stored in the object itself, so the object and its count
+ * are one allocation and a handle is a single pointer. The count is not atomic:
+ * values are never shared between threads.
+ *
+ * Copying an object doesn't copy its count: the copy is a new object without owners.
+ */
+class HeapObject {
+public:
+    HeapObject() = default;
+    HeapObject(const HeapObject&) {}
+    HeapObject& operator=(const HeapObject&) { return *this; }
+
+    /** @brief Returns the number of handles referencing the object. */
+    uint32_t ref_count() const { return ref_count_; }
+
+private:
+    template<typename T>
+    friend class Ref;
+
+    mutable uint32_t ref_count_ = 0;
+};
+
+/**
+ * @class Ref
+ * @brief Owning handle to a HeapObject, works like std::shared_ptr with the intrusive count.
+ * The object is deleted when the last handle is destroyed.
+ * @tparam T Type derived from HeapObject.
+ */
+template<typename T>
+class Ref {
+public:
+    Ref() = default;
+    Ref(std::nullptr_t) {}
+
+    /** @brief Takes the ownership of the object. */
+    explicit Ref(T* object)
+        : object_(object) {
+        Retain();
+    }
+
+    Ref(const Ref& other)
+        : object_(other.object_) {
+        Retain();
+    }
+
+    Ref(Ref&& other) noexcept
+        : object_(std::exchange(other.object_, nullptr)) {}
+
+    Ref& operator=(Ref other) noexcept {
+        std::swap(object_, other.object_);
+        return *this;
+    }
+
+    ~Ref() {
+        Release();
+    }
+
+    T* get() const { return object_; }
+    T& operator*() const { return *object_; }
+    T* operator->() const { return object_; }
+
+    explicit operator bool() const { return object_ != nullptr; }
+
+    bool operator==(const Ref& other) const = default;
+
+private:
+    T* object_ = nullptr;
+
+    void Retain() const {
+        if (object_ != nullptr) {
+            ++static_cast<const HeapObject*>(object_)->ref_count_;
+        }
+    }
+
+    void Release() const {
+        if (object_ != nullptr && --static_cast<const HeapObject*>(object_)->ref_count_ == 0) {
+            delete object_;
+        }
+    }
+};
+
+/** @brief Creates the object of type T in a single allocation and returns the handle to it. */
+template<typename T, typename ...Args>
+Ref<T> MakeRef(Args&&... args) {
+    return Ref<T>{new T(std::forward<Args>(args)...)};
+}
+
+} // namespace itmoscript
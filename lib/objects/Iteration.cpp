@@ -0,0 +1,36 @@
+#include "Iteration.hpp"
+#include "List.hpp"
+
+namespace itmoscript {
+
+bool IsIterable(const Value& value) {
+    return value.IsOfType<List>() || value.IsOfType<String>() || value.IsOfType<Generator>();
+}
+
+std::optional<Value> GetIterElement(const Value& iterable, size_t index) {
+    if (iterable.IsOfType<Generator>()) {
+        // the handle keeps the generator alive even if its body drops the iterated value
+        Generator generator = iterable.Get<Generator>();
+        return generator->Next();
+    }
+
+    if (iterable.IsOfType<String>()) {
+        const String& str = iterable.Get<String>();
+
+        if (index >= str->size()) {
+            return std::nullopt;
+        }
+
+        return CreateString(std::string(1, (*str)[index]));
+    }
+
+    const List& list = iterable.Get<List>();
+
+    if (index >= list->size()) {
+        return std::nullopt;
+    }
+
+    return list->At(index);
+}
+
+} // namespace itmoscript
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "Value.hpp"
+
+namespace itmoscript {
+
+/**
+ * @brief Iteration protocol of the for loop, shared by both engines.
+ * The loop walks a List or a String by index: the elements of a lazy range are computed
+ * and the characters of a string are copied one by one, nothing is materialized.
+ * The size is checked on each step, so the loop sees the modifications made by its body.
+ * A Generator is resumed on each step instead, the index is ignored.
+ */
+
+/** @brief Checks if the for loop can walk the value: it's a List, a String or a Generator. */
+bool IsIterable(const Value& value);
+
+/**
+ * @brief Returns the element of the iterable on the given position, nullopt after the last one.
+ * The element of a String is a String of a single character.
+ * @throws RuntimeError raised by the body of a Generator.
+ */
+std::optional<Value> GetIterElement(const Value& iterable, size_t index);
+
+} // namespace itmoscript
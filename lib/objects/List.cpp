@@ -3,36 +3,122 @@
 namespace itmoscript {
 
 void ListObject::Insert(size_t pos, const Value& value) {
+    std::vector<Value>& values = MutableData();
+
     if (value.IsReferenceType()) {
-        data_.insert(data_.begin() + pos, value.GetCopy());
+        values.insert(values.begin() + pos, value.GetCopy());
     } else {
-        data_.insert(data_.begin() + pos, value);
+        values.insert(values.begin() + pos, value);
     }
 }
 
 void ListObject::Insert(size_t pos, Value&& value) {
-    data_.insert(data_.begin() + pos, std::move(value));
+    value.Thaw();
+    std::vector<Value>& values = MutableData();
+    values.insert(values.begin() + pos, std::move(value));
 }
 
 void ListObject::Remove(size_t pos) {
-    data_.erase(data_.begin() + pos);
+    std::vector<Value>& values = MutableData();
+    values.erase(values.begin() + pos);
 }
 
 void ListObject::Sort() {
-    std::sort(data_.begin(), data_.end());
+    std::vector<Value>& values = MutableData();
+    std::sort(values.begin(), values.end());
+}
+
+void ListObject::Set(size_t index, Value value) {
+    value.Thaw();
+    MutableData().at(index) = std::move(value);
+}
+
+ListObject ListObject::MakeRange(Int start, Int step, size_t count) {
+    ListObject list;
+
+    if (count != 0) {
+        list.progression_ = Progression{.start = start, .step = step, .count = count};
+    }
+
+    return list;
+}
+
+bool ListObject::operator==(const ListObject& other) const {
+    if (!lazy() && !other.lazy()) {
+        return std::ranges::equal(data(), other.data());
+    }
+
+    if (size() != other.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < size(); ++i) {
+        if (At(i) != other.At(i)) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
-std::vector<Value> ListObject::GetSlice(size_t start, size_t end) const {
-    if (start > end || start >= data_.size()) return {};
+ListObject ListObject::GetSlice(size_t start, size_t end) const {
+    size_t current_size = size();
+
+    if (start > end || start >= current_size) return {};
     
-    if (end > data_.size())
-        end = data_.size();
+    if (end > current_size)
+        end = current_size;
+
+    if (progression_.has_value()) {
+        Value first = progression_->Element(start);
+        return MakeRange(first.Get<Int>(), progression_->step, end - start);
+    }
+
+    ListObject slice{*this};
+    slice.offset_ = (length_ == kWholeBuffer ? 0 : offset_) + start;
+    slice.length_ = end - start;
+    return slice;
+}
+
+void ListObject::Materialize() const {
+    std::vector<Value> values;
+    values.reserve(progression_->count);
+
+    for (size_t i = 0; i < progression_->count; ++i) {
+        values.push_back(progression_->Element(i));
+    }
+
+    buffer_ = MakeRef<Buffer>(std::move(values));
+    progression_.reset();
+}
+
+std::vector<Value>& ListObject::MutableData() {
+    if (progression_.has_value()) {
+        Materialize();
+    }
+
+    if (buffer_ == nullptr) {
+        buffer_ = MakeRef<Buffer>(std::vector<Value>{});
+    } else if (buffer_->ref_count() > 1) {
+        // the elements are shared with a copy of the list
+        std::span<const Value> values = data();
+        buffer_ = MakeRef<Buffer>(std::vector<Value>(values.begin(), values.end()));
+    } else if (length_ != kWholeBuffer) {
+        // the sliced list is gone, the slice owns the buffer alone
+        std::vector<Value>& values = buffer_->values;
+        values.erase(values.begin() + offset_ + length_, values.end());
+        values.erase(values.begin(), values.begin() + offset_);
+    }
 
-    return std::vector<Value>(data_.begin() + start, data_.begin() + end);
+    offset_ = 0;
+    length_ = kWholeBuffer;
+    return buffer_->values;
 }
 
 List CreateList(ListObject val) {
-    return CreateRefValue(val);
+    List list = MakeRef<ListObject>(std::move(val));
+    CycleCollector::Instance().NotifyAllocation();
+    return list;
 }
 
 } // namespace itmoscript
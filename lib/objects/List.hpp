@@ -5,10 +5,15 @@
 #include <cstddef>
 #include <memory>
 #include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <limits>
+#include <optional>
 
 #include <iostream>
 
 #include "Value.hpp"
+#include "CycleCollector.hpp"
 
 namespace itmoscript {
 
@@ -17,18 +22,82 @@ namespace itmoscript {
  * @brief Implementation of the List undelying type.
  * The actual List type is a ReferenceValueType, which means it is
  * a reference to the actual object, which is ListObject.
+ *
+ * @details Copies of the list share its elements until one of them is modified
+ * (copy-on-write), so copying a list is O(1). A slice is a window into the elements
+ * of the sliced list, so slicing is O(1) too. The sharing is invisible to the language:
+ * a copy or a slice still behaves as an independent list.
+ *
+ * A list created by range() is lazy: it stores only the arithmetic progression,
+ * and the size, the elements, the slices and the comparison are computed from it.
+ * The elements are materialized on the first access to data() or the first modification.
  */
-class ListObject {
+class ListObject : public HeapObject {
 public:
-    ListObject() = default;
+    ListObject() {
+        CycleCollector::Instance().Track(this);
+    }
 
     ListObject(std::vector<Value> values)
-        : data_(std::move(values)) {}
+        : buffer_(values.empty() ? nullptr : MakeRef<Buffer>(std::move(values))) {
+        CycleCollector::Instance().Track(this);
+    }
 
-    size_t size() const { return data_.size(); }
-    const std::vector<Value>& data() const { return data_; }
+    ListObject(const ListObject& other)
+        : HeapObject(other), buffer_(other.buffer_), offset_(other.offset_), length_(other.length_),
+          progression_(other.progression_) {
+        CycleCollector::Instance().Track(this);
+    }
+
+    ListObject(ListObject&& other) noexcept
+        : buffer_(std::move(other.buffer_)), offset_(other.offset_), length_(other.length_),
+          progression_(other.progression_) {
+        CycleCollector::Instance().Track(this);
+    }
+
+    ListObject& operator=(const ListObject& other) {
+        buffer_ = other.buffer_;
+        offset_ = other.offset_;
+        length_ = other.length_;
+        progression_ = other.progression_;
+        return *this;
+    }
+
+    ListObject& operator=(ListObject&& other) noexcept {
+        buffer_ = std::move(other.buffer_);
+        offset_ = other.offset_;
+        length_ = other.length_;
+        progression_ = other.progression_;
+        return *this;
+    }
+
+    ~ListObject() {
+        CycleCollector::Instance().Untrack(this);
+    }
+
+    /** @brief Returns the lazy list of count numbers: start, start + step, start + 2 * step... */
+    static ListObject MakeRange(Int start, Int step, size_t count);
+
+    size_t size() const { return progression_.has_value() ? progression_->count : data().size(); }
     bool empty() const { return size() == 0; }
 
+    /** @brief Checks if the elements are not materialized yet, see MakeRange(). */
+    bool lazy() const { return progression_.has_value(); }
+
+    /** @brief Returns the elements, materializing a lazy list. */
+    std::span<const Value> data() const {
+        if (progression_.has_value()) {
+            Materialize();
+        }
+
+        if (buffer_ == nullptr) {
+            return {};
+        }
+
+        std::span<const Value> values = buffer_->values;
+        return length_ == kWholeBuffer ? values : values.subspan(offset_, length_);
+    }
+
     /**
      * @brief Inserts given value before the given position.
      * ReferenceValueTypes are deep-copied when inserted.
@@ -62,22 +131,90 @@ public:
      */
     void Sort();
 
-    Value& At(size_t index) { return data_.at(index); }
-    const Value& At(size_t index) const { return data_.at(index); }
+    /**
+     * @brief Returns the element, an element of a lazy list is computed without materializing it.
+     * @throw std::out_of_range If the index is not less than size().
+     */
+    Value At(size_t index) const {
+        if (index >= size()) {
+            throw std::out_of_range{"ListObject::At"};
+        }
+
+        if (progression_.has_value()) {
+            return progression_->Element(index);
+        }
+
+        return data()[index];
+    }
+
+    /** @brief Replaces the element on the given position. */
+    void Set(size_t index, Value value);
 
     /**
-     * @return Returns copy of the array from index start to index end.
+     * @return Returns the list of the elements from index start to index end.
+     * The slice shares the elements with this list until one of them is modified.
      * 
-     * If start > size(), returns an empty array.
-     * If end > size(), returns array[start : size() - 1].
+     * If start > size(), returns an empty list.
+     * If end > size(), returns list[start : size() - 1].
      */
-    std::vector<Value> GetSlice(size_t start, size_t end) const;
+    ListObject GetSlice(size_t start, size_t end) const;
     
-    bool operator==(const ListObject& other) const = default;
-    bool operator!=(const ListObject& other) const = default;
+    bool operator==(const ListObject& other) const;
 
 private:
-    std::vector<Value> data_;
+    friend class CycleCollector;
+
+    /** @brief Elements of the list, shared by its copies. */
+    struct Buffer : public HeapObject {
+        Buffer(std::vector<Value> values)
+            : values(std::move(values)) {}
+
+        std::vector<Value> values;
+
+        /** @brief Number of the last collection which visited the buffer. */
+        uint32_t gc_epoch = 0;
+    };
+
+    /** @brief Length of the list which is not a slice: it spans the whole buffer, whatever its size. */
+    static constexpr size_t kWholeBuffer = std::numeric_limits<size_t>::max();
+
+    /** @brief Elements of a lazy list. */
+    struct Progression {
+        Int start;
+        Int step;
+        size_t count;
+
+        Value Element(size_t index) const {
+            // the elements are in the bounds of range(), the unsigned arithmetic only avoids the overflow of index * step
+            return static_cast<Int>(static_cast<uint64_t>(start) + index * static_cast<uint64_t>(step));
+        }
+    };
+
+    /** @brief Null while the list is empty. Set by data() of a lazy list, which is logically const. */
+    mutable Ref<Buffer> buffer_;
+
+    // window of the buffer the list consists of
+    size_t offset_ = 0;
+    size_t length_ = kWholeBuffer;
+
+    /** @brief Set while the list is lazy. */
+    mutable std::optional<Progression> progression_;
+
+    /** @brief Stores the elements of a lazy list in the buffer, the list is not lazy anymore. */
+    void Materialize() const;
+
+    /**
+     * @brief Returns the elements for modification, detaching them from the copies of the list.
+     * A slice gets the buffer of its own elements.
+     */
+    std::vector<Value>& MutableData();
+
+    // links of the collector's list of all the ListObjects
+    ListObject* gc_prev_ = nullptr;
+    ListObject* gc_next_ = nullptr;
+
+    /** @brief References not coming from the tracked objects, computed during a collection. */
+    int64_t gc_refs_ = 0;
 };
 
 List CreateList(ListObject val);
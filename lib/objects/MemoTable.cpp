@@ -0,0 +1,107 @@
+#include "MemoTable.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+namespace itmoscript {
+
+bool MemoTable::IsHashable(const Value& value) {
+    switch (value.GetType()) {
+        case ValueType::kNullType:
+        case ValueType::kInt:
+        case ValueType::kFloat:
+        case ValueType::kBool:
+        case ValueType::kString:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool MemoTable::IsHashable(std::span<const Value> values) {
+    for (const Value& value : values) {
+        if (!IsHashable(value)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+MemoTable::Key MemoTable::MakeKey(std::span<const Value> args) {
+    Key key;
+    key.reserve(args.size());
+
+    for (const Value& arg : args) {
+        key.push_back(arg.GetCopy());
+    }
+
+    return key;
+}
+
+std::optional<Value> MemoTable::Find(std::span<const Value> args) {
+    auto it = index_.find(args);
+
+    if (it == index_.end()) {
+        ++misses_;
+        return std::nullopt;
+    }
+
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->result.GetCopy();
+}
+
+void MemoTable::Insert(Key key, const Value& result) {
+    if (capacity_ == 0 || !IsHashable(result) || index_.contains(key)) {
+        return;
+    }
+
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+
+    entries_.push_front(Entry{.key = std::move(key), .result = result.GetCopy()});
+    index_.emplace(entries_.front().key, entries_.begin());
+}
+
+size_t MemoTable::KeyHash::operator()(std::span<const Value> key) const {
+    size_t hash = key.size();
+
+    for (const Value& value : key) {
+        size_t element_hash = 0;
+
+        switch (value.GetType()) {
+            case ValueType::kInt:
+                element_hash = std::hash<Int>{}(value.Get<Int>());
+                break;
+            case ValueType::kFloat: {
+                // 0.0 and -0.0 are equal, so they must have the same hash
+                Float number = value.Get<Float>();
+                element_hash = std::hash<Float>{}(number == 0 ? 0 : number);
+                break;
+            }
+            case ValueType::kBool:
+                element_hash = std::hash<Bool>{}(value.Get<Bool>());
+                break;
+            case ValueType::kString:
+                element_hash = std::hash<std::string>{}(*value.Get<String>());
+                break;
+            default:
+                break;
+        }
+
+        element_hash += static_cast<size_t>(value.GetType());
+        hash ^= element_hash + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+bool MemoTable::KeyEqual::operator()(std::span<const Value> lhs, std::span<const Value> rhs) const {
+    return std::ranges::equal(lhs, rhs);
+}
+
+} // namespace itmoscript
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Value.hpp"
+
+namespace itmoscript {
+
+/**
+ * @class MemoTable
+ * @brief Bounded cache of the results of a memoized function, see the memoize() standard function.
+ *
+ * @details Only the values which can't be modified in place are keys and results: numbers, booleans,
+ * nil and strings. Strings are copied when they enter the table and when they leave it.
+ * When the table is full, the least recently used entry is evicted.
+ */
+class MemoTable {
+public:
+    static constexpr size_t kDefaultCapacity = 65536;
+
+    using Key = std::vector<Value>;
+
+    /** @brief Global function called by the memoized one by name. */
+    struct Callee {
+        std::string name;
+        uint32_t global;
+    };
+
+    explicit MemoTable(size_t capacity = kDefaultCapacity)
+        : capacity_(capacity) {}
+
+    MemoTable(const MemoTable&) = delete;
+    MemoTable& operator=(const MemoTable&) = delete;
+
+    /** @brief Checks if the value may be a key or a result: it's a number, a boolean, nil or a string. */
+    static bool IsHashable(const Value& value);
+    static bool IsHashable(std::span<const Value> values);
+
+    /** @brief Returns the copies of the arguments to store the result with. */
+    static Key MakeKey(std::span<const Value> args);
+
+    /** @brief Returns the copy of the result cached for the arguments, counting a hit or a miss. */
+    std::optional<Value> Find(std::span<const Value> args);
+
+    /**
+     * @brief Caches the result, evicting the least recently used one if the table is full.
+     * A result which is not hashable is not stored: the next call computes it again.
+     */
+    void Insert(Key key, const Value& result);
+
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+    size_t size() const { return entries_.size(); }
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Global functions whose purity is not checked yet. They get their values at runtime,
+     * so the Evaluator checks them before the first lookup, until then the calls are not cached.
+     */
+    std::vector<Callee> unchecked_callees;
+
+private:
+    struct Entry {
+        Key key;
+        Value result;
+    };
+
+    struct KeyHash {
+        size_t operator()(std::span<const Value> key) const;
+    };
+
+    struct KeyEqual {
+        bool operator()(std::span<const Value> lhs, std::span<const Value> rhs) const;
+    };
+
+    size_t capacity_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    /** @brief Entries from the most to the least recently used. */
+    std::list<Entry> entries_;
+
+    /** @brief Entries by their keys, the spans point to the keys stored in the list. */
+    std::unordered_map<std::span<const Value>, std::list<Entry>::iterator, KeyHash, KeyEqual> index_;
+};
+
+/**
+ * @struct PendingMemo
+ * @brief Result of a memoized call to be stored when the call returns.
+ * A tail call returns the same result as the call it replaces, so a call may finish several of them.
+ */
+struct PendingMemo {
+    std::shared_ptr<MemoTable> table;
+    MemoTable::Key key;
+};
+
+} // namespace itmoscript
@@ -1,10 +1,146 @@
 #include "Value.hpp"
 #include "Function.hpp"
 #include "List.hpp"
-#include "utils.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <iterator>
+#include <sstream>
 
 namespace itmoscript {
 
+Value::Value(const Value& other) : int_(0) {
+    CopyPayload(other);
+}
+
+Value::Value(Value&& other) noexcept : int_(0) {
+    MovePayload(std::move(other));
+}
+
+Value& Value::operator=(const Value& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    if (!IsReferenceType()) {
+        CopyPayload(other);
+        return *this;
+    }
+
+    // the other value may be owned by the object being released
+    Value copy{other};
+    DestroyReference();
+    MovePayload(std::move(copy));
+    return *this;
+}
+
+Value& Value::operator=(Value&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    if (!IsReferenceType()) {
+        MovePayload(std::move(other));
+        return *this;
+    }
+
+    Value moved{std::move(other)};
+    DestroyReference();
+    MovePayload(std::move(moved));
+    return *this;
+}
+
+void Value::CopyPayload(const Value& other) {
+    type_ = other.type_;
+
+    switch (type_) {
+        case ValueType::kInt:
+            int_ = other.int_;
+            break;
+        case ValueType::kFloat:
+            float_ = other.float_;
+            break;
+        case ValueType::kBool:
+            bool_ = other.bool_;
+            break;
+        case ValueType::kString:
+            new (&string_) String(other.string_);
+            break;
+        case ValueType::kList:
+            new (&list_) List(other.list_);
+            break;
+        case ValueType::kFunction:
+            new (&function_) Function(other.function_);
+            break;
+        case ValueType::kGenerator:
+            new (&generator_) Generator(other.generator_);
+            break;
+        case ValueType::kFile:
+            new (&file_) File(other.file_);
+            break;
+        default:
+            break;
+    }
+}
+
+void Value::MovePayload(Value&& other) {
+    type_ = other.type_;
+
+    switch (type_) {
+        case ValueType::kInt:
+            int_ = other.int_;
+            break;
+        case ValueType::kFloat:
+            float_ = other.float_;
+            break;
+        case ValueType::kBool:
+            bool_ = other.bool_;
+            break;
+        case ValueType::kString:
+            new (&string_) String(std::move(other.string_));
+            break;
+        case ValueType::kList:
+            new (&list_) List(std::move(other.list_));
+            break;
+        case ValueType::kFunction:
+            new (&function_) Function(std::move(other.function_));
+            break;
+        case ValueType::kGenerator:
+            new (&generator_) Generator(std::move(other.generator_));
+            break;
+        case ValueType::kFile:
+            new (&file_) File(std::move(other.file_));
+            break;
+        default:
+            break;
+    }
+}
+
+void Value::DestroyReference() {
+    switch (type_) {
+        case ValueType::kString:
+            string_.~String();
+            break;
+        case ValueType::kList:
+            list_.~List();
+            break;
+        case ValueType::kFunction:
+            function_.~Function();
+            break;
+        case ValueType::kGenerator:
+            generator_.~Generator();
+            break;
+        case ValueType::kFile:
+            file_.~File();
+            break;
+        default:
+            break;
+    }
+
+    type_ = ValueType::kNullType;
+}
+
 bool Value::IsTruphy() const {
     switch (GetType()) {
         case ValueType::kNullType:
@@ -18,6 +154,8 @@ bool Value::IsTruphy() const {
         case ValueType::kBool:
             return Get<Bool>();
         case ValueType::kFunction:
+        case ValueType::kGenerator:
+        case ValueType::kFile:
             return true;
         case ValueType::kList:
             return Get<List>()->size() != 0;
@@ -38,44 +176,106 @@ std::string Value::ToString() const {
             return '"' + *Get<String>() + '"';
         case ValueType::kBool:
             return Get<Bool>() ? "true" : "false";
+        case ValueType::kGenerator:
+            return "<Generator object>";
+        case ValueType::kFile:
+            return std::format("<File '{}'>", Get<File>()->path());
         case ValueType::kFunction:
-            return std::format(
-                "<Function object>({})",
-                utils::Join<std::shared_ptr<ast::Identifier>, std::string>(
-                    Get<Function>().parameters(), 
-                    ", ", 
-                    [](const std::shared_ptr<ast::Identifier>& ident) { return ident->name; }
-                )
-            );
-        case ValueType::kList:
-            return std::format(
-                "[{}]",
-                utils::Join<Value, std::string>(
-                    Get<List>()->data(), 
-                    ", ", 
-                    [this](const Value& value) -> std::string {
-                        return value.ToString();
-                    }
-                )
-            );
+        case ValueType::kList: {
+            std::ostringstream stream;
+            Serialize(stream);
+            return std::move(stream).str();
+        }
         default:
             return kUnknownTypeName;
     }
 }
 
+void Value::Serialize(std::ostream& stream) const {
+    switch (GetType()) {
+        case ValueType::kInt: {
+            char buffer[24];
+            auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), Get<Int>());
+            stream.write(buffer, end - buffer);
+            break;
+        }
+        case ValueType::kFloat: {
+            // the same shortest representation as std::format("{}"), at most 24 characters long
+            char buffer[32];
+            auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), Get<Float>());
+            stream.write(buffer, end - buffer);
+            break;
+        }
+        case ValueType::kString: {
+            const std::string& str = *Get<String>();
+            stream.put('"');
+            stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+            stream.put('"');
+            break;
+        }
+        case ValueType::kFunction: {
+            stream << "<Function object>(";
+            bool first = true;
+
+            for (const auto& ident : Get<Function>().parameters()) {
+                if (!first) {
+                    stream << ", ";
+                }
+
+                stream << ident->name;
+                first = false;
+            }
+
+            stream.put(')');
+            break;
+        }
+        case ValueType::kList: {
+            stream.put('[');
+            bool first = true;
+
+            for (const Value& value : Get<List>()->data()) {
+                if (!first) {
+                    stream << ", ";
+                }
+
+                value.Serialize(stream);
+                first = false;
+            }
+
+            stream.put(']');
+            break;
+        }
+        default:
+            stream << ToString();
+            break;
+    }
+}
+
 bool Value::operator==(const Value& other) const {
-    if (GetType() == ValueType::kList) {
-        return other.GetType() == ValueType::kList
-            && Get<List>()->data() == other.Get<List>()->data();
-    } else if (GetType() == ValueType::kString) {
-        return other.GetType() == ValueType::kString
-            && *Get<String>() == *other.Get<String>();
-    } else if (GetType() == ValueType::kFunction) {
-        return other.GetType() == ValueType::kFunction
-            && Get<Function>() == other.Get<Function>();
+    if (type_ != other.type_) {
+        return false;
+    }
+
+    switch (type_) {
+        case ValueType::kInt:
+            return int_ == other.int_;
+        case ValueType::kFloat:
+            return float_ == other.float_;
+        case ValueType::kBool:
+            return bool_ == other.bool_;
+        case ValueType::kString:
+            return *string_ == *other.string_;
+        case ValueType::kList:
+            return *list_ == *other.list_;
+        case ValueType::kFunction:
+            return function_ == other.function_;
+        case ValueType::kGenerator:
+            return generator_ == other.generator_;
+        case ValueType::kFile:
+            return file_ == other.file_;
+        default:
+            return true;
     }
-    
-    return GetType() == other.GetType() && data_ == other.data_;
 }
 
 const std::string& Value::GetTypeName() const {
@@ -105,23 +305,24 @@ bool Value::operator<(const Value& other) const {
         case ValueType::kBool:
             return Get<Bool>() < other.Get<Bool>();
         case ValueType::kFunction:
+        case ValueType::kGenerator:
+        case ValueType::kFile:
             return false;
-        case ValueType::kList:
-            return Get<List>()->data() < other.Get<List>()->data();
+        case ValueType::kList: {
+            std::span<const Value> left = Get<List>()->data();
+            std::span<const Value> right = other.Get<List>()->data();
+            return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+        }
         default:
             return false;
     }
 }
 
-bool Value::IsReferenceType() const {
-    return kReferenceTypes.contains(GetType());
-}
-
 Value Value::GetCopy() const {
     if (IsReferenceType()) {
         switch (GetType()) {
             case ValueType::kList:
-                return CreateList(Get<List>()->data());
+                return CreateList(*Get<List>());
             case ValueType::kString:
                 return CreateString(*Get<String>());
         }
@@ -130,47 +331,15 @@ Value Value::GetCopy() const {
     return *this;
 }
 
-std::ostream& operator<<(std::ostream& stream, const Value& value) {
-    return stream << value.ToString();
-}
-
-ValueType Value::GetType() const {
-    if (IsOfType<Int>()) {
-        return ValueType::kInt;
-    } else if (IsOfType<Float>()) {
-        return ValueType::kFloat;
-    } else if (IsOfType<String>()) {
-        return ValueType::kString;
-    } else if (IsOfType<Bool>()) {
-        return ValueType::kBool;
-    } else if (IsOfType<Function>()) {
-        return ValueType::kFunction;
-    } else if (IsOfType<List>()) {
-        return ValueType::kList;
+void Value::Thaw() {
+    if (type_ == ValueType::kString && string_->frozen()) {
+        string_ = CreateString(*string_);
     }
-
-    return ValueType::kNullType;
 }
 
-bool Value::IsOfType(ValueType type) const {
-    switch (type) {
-        case ValueType::kNullType:
-            return std::holds_alternative<NullType>(data_);
-        case ValueType::kInt:
-            return std::holds_alternative<Int>(data_);
-        case ValueType::kFloat:
-            return std::holds_alternative<Float>(data_);
-        case ValueType::kString:
-            return std::holds_alternative<String>(data_);
-        case ValueType::kBool:
-            return std::holds_alternative<Bool>(data_);
-        case ValueType::kFunction:
-            return std::holds_alternative<Function>(data_);
-        case ValueType::kList:
-            return std::holds_alternative<List>(data_);
-        default:
-            return false;
-    }
+std::ostream& operator<<(std::ostream& stream, const Value& value) {
+    value.Serialize(stream);
+    return stream;
 }
 
 const std::string& GetTypeName(ValueType type) {
@@ -7,10 +7,14 @@
 #include <ostream>
 #include <type_traits>
 #include <concepts>
+#include <utility>
 
 #include "ast/AST.hpp"
 
+#include "HeapObject.hpp"
 #include "Function.hpp"
+#include "Generator.hpp"
+#include "File.hpp"
 
 namespace itmoscript {
 
@@ -20,8 +24,49 @@ using Float = double;            // Floating-point type used in the language.
 using Bool = bool;               // Bool type used in the language.
 
 class ListObject;
-using List = std::shared_ptr<ListObject>; // List type used in the language.
-using String = std::shared_ptr<std::string>; // String type used in the language.
+
+/**
+ * @class StringObject
+ * @brief Implementation of the String underlying type.
+ * It is the std::string itself, so the String handle dereferences right to the text,
+ * and short strings are stored inline in the object.
+ *
+ * @details A frozen string is a constant shared by the evaluations of string literals.
+ * The mark is never copied: a copy of a constant is an ordinary string.
+ */
+class StringObject : public HeapObject, public std::string {
+public:
+    using std::string::string;
+    using std::string::operator=;
+
+    StringObject(std::string str)
+        : std::string(std::move(str)) {}
+
+    StringObject(const StringObject& other)
+        : HeapObject(other), std::string(other) {}
+
+    StringObject(StringObject&& other) noexcept
+        : std::string(std::move(other)) {}
+
+    StringObject& operator=(const StringObject& other) {
+        std::string::operator=(other);
+        return *this;
+    }
+
+    StringObject& operator=(StringObject&& other) noexcept {
+        std::string::operator=(std::move(other));
+        return *this;
+    }
+
+    bool frozen() const { return frozen_; }
+    void Freeze() { frozen_ = true; }
+
+private:
+    bool frozen_ = false;
+};
+
+using List = Ref<ListObject>; // List type used in the language.
+using String = Ref<StringObject>; // String type used in the language.
 
 /**
  * @brief Concept to constrain core language types for Value class.
@@ -34,11 +79,13 @@ concept CoreValueType =
     std::same_as<T, String> ||
     std::same_as<T, Bool> ||
     std::same_as<T, Function> ||
+    std::same_as<T, Generator> ||
+    std::same_as<T, File> ||
     std::same_as<T, List>;
 
 /**
  * @brief Concept to contrain types that are not copied but rather passed by reference.
- * Current reference value types are: List, String, Function.
+ * Current reference value types are: List, String, Function, Generator, File.
  * 
  * If a ReferenceValueType is inserted into an array, it's getting copied.
  */
@@ -46,7 +93,9 @@ template<typename T>
 concept ReferenceValueType =
     std::same_as<T, List> ||
     std::same_as<T, String> ||
-    std::same_as<T, Function>;
+    std::same_as<T, Function> ||
+    std::same_as<T, Generator> ||
+    std::same_as<T, File>;
 
 /**
  * @brief Concept to constrain supported numeric types for Value class.
@@ -62,14 +111,16 @@ concept NumericValueType =
  * Integer value assigned to the enum constants are the type priority used
  * in comparison of 2 Values of different types (Ints and Floats are compared separately).
  * */
-enum class ValueType {
+enum class ValueType : uint8_t {
     kInt = 1,
     kFloat = 2,
     kBool = 3,
     kString = 4,
     kList = 5,
     kFunction = 6,
-    kNullType = 7,
+    kGenerator = 7,
+    kFile = 8,
+    kNullType = 9,
 };
 
 inline const std::string kUnknownTypeName = "<UnknownType>";
@@ -82,12 +133,18 @@ struct ValueTypePairHash {
     }
 };
 
+template<CoreValueType T>
+constexpr ValueType GetType();
+
 /**
  * @class Value
  * @brief Represents a dynamically-typed value in the ItmoScript language.
  * 
- * Can hold any of the supported types (NullType, Int, Float, String, Bool, Function).
+ * Can hold any of the supported types (NullType, Int, Float, String, Bool, Function, List, Generator, File).
  * Provides type-safe access and utilities for type checking and conversion.
+ *
+ * @details The value is a tagged union: the type tag is stored next to the payload,
+ * so type checks are a single comparison and Int, Float, Bool and nil are stored inline.
  */
 class Value {
 public:
@@ -98,19 +155,36 @@ public:
      * @tparam T Must satisfy CoreValueType concept.
      * @param val The value to store.
      */
-    template<CoreValueType T>
-    Value(const T& val)
-        : data_(val) {}
+    template<typename T>
+        requires CoreValueType<std::remove_cvref_t<T>>
+    Value(T&& val) : int_(0) {
+        Construct(std::forward<T>(val));
+    }
 
     /**
      * @brief Constructs a Value with NullType.
      */
-    Value() = default;
+    Value() : int_(0) {}
+
+    Value(const Value& other);
+    Value(Value&& other) noexcept;
+    Value& operator=(const Value& other);
+    Value& operator=(Value&& other) noexcept;
+
+    ~Value() {
+        if (IsReferenceType()) {
+            DestroyReference();
+        }
+    }
 
     /** @brief Returns the ValueType enum corresponding to the stored type. */
-    ValueType GetType() const;
+    ValueType GetType() const {
+        return type_;
+    }
 
-    bool IsOfType(ValueType type) const;
+    bool IsOfType(ValueType type) const {
+        return type_ == type;
+    }
     
     /**
      * @brief Checks if the stored value is of type T.
@@ -118,7 +192,7 @@ public:
      */
     template<CoreValueType T>
     bool IsOfType() const {
-        return std::holds_alternative<T>(data_);
+        return type_ == itmoscript::GetType<T>();
     }
 
     /**
@@ -136,19 +210,22 @@ public:
      */
     template<CoreValueType T>
     const T& Get() const {
-        return std::get<T>(data_);
+        if (!IsOfType<T>()) {
+            throw std::bad_variant_access{};
+        }
+
+        return Payload<T>();
     }
 
     template<CoreValueType T>
     T& Get() {
-        return std::get<T>(data_);
+        return const_cast<T&>(std::as_const(*this).Get<T>());
     }
 
     /** @tparam T Must satisfy CoreValueType. */
     template<CoreValueType T>
     Value& operator=(T value) {
-        data_ = std::move(value);
-        return *this;
+        return *this = Value{std::move(value)};
     }
 
     /**
@@ -158,9 +235,12 @@ public:
     std::string ToString() const;
 
     /**
-     * @brief Puts string representation of the stored value to the stream.
-     * Directly uses ToString().
+     * @brief Writes the same text as ToString() to the stream.
+     * Nested values are written one by one, without building their strings first.
      */
+    void Serialize(std::ostream& stream) const;
+
+    /** @brief Puts string representation of the stored value to the stream, see Serialize(). */
     friend std::ostream& operator<<(std::ostream& stream, const Value& value);
 
     /**
@@ -186,7 +266,7 @@ public:
      * 2. Int and Float - just a number comparison
      * 3. String - compared lexicographically (using std::string::operator<)
      * 4. Bool - false < true
-     * 5. Functions are incomparable, so the operator simply returns false. Don't sort functions.
+     * 5. Functions and generators are incomparable, so the operator simply returns false. Don't sort them.
      * 6. Lists are compared using std::vector::operator<
      */
     bool operator<(const Value& other) const;
@@ -195,7 +275,10 @@ public:
      * @brief Checks if the current type is a reference type.
      * See ReferenceValueType for more info.
      */
-    bool IsReferenceType() const;
+    bool IsReferenceType() const {
+        // reference types have adjacent tags
+        return type_ >= ValueType::kString && type_ <= ValueType::kFile;
+    }
 
     /**
      * @brief Returns copy of the value.
@@ -204,20 +287,84 @@ public:
      */
     Value GetCopy() const;
 
+    /**
+     * @brief Replaces a frozen String constant with its copy, other values are left as is.
+     * Values are thawed before they are stored to a variable or a list, where they can be modified in place.
+     */
+    void Thaw();
+
 private:
-    using Type = std::variant<
-        NullType,
-        Int,
-        Float,
-        String,
-        Bool,
-        Function,
-        List
-    >;
-
-    Type data_ = NullType{};
+    ValueType type_ = ValueType::kNullType;
+
+    union {
+        Int int_;
+        Float float_;
+        Bool bool_;
+        String string_;
+        List list_;
+        Function function_;
+        Generator generator_;
+        File file_;
+    };
+
+    static constexpr NullType kNullPayload{};
+
+    template<typename T>
+    void Construct(T&& val) {
+        using U = std::remove_cvref_t<T>;
+
+        if constexpr (std::same_as<U, NullType>) {
+            type_ = ValueType::kNullType;
+        } else if constexpr (std::same_as<U, Bool>) {
+            type_ = ValueType::kBool;
+            bool_ = val;
+        } else if constexpr (std::same_as<U, String>) {
+            type_ = ValueType::kString;
+            new (&string_) String(std::forward<T>(val));
+        } else if constexpr (std::same_as<U, List>) {
+            type_ = ValueType::kList;
+            new (&list_) List(std::forward<T>(val));
+        } else if constexpr (std::same_as<U, Function>) {
+            type_ = ValueType::kFunction;
+            new (&function_) Function(std::forward<T>(val));
+        } else if constexpr (std::same_as<U, Generator>) {
+            type_ = ValueType::kGenerator;
+            new (&generator_) Generator(std::forward<T>(val));
+        } else if constexpr (std::same_as<U, File>) {
+            type_ = ValueType::kFile;
+            new (&file_) File(std::forward<T>(val));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            type_ = ValueType::kFloat;
+            float_ = val;
+        } else {
+            type_ = ValueType::kInt;
+            int_ = static_cast<Int>(val);
+        }
+    }
+
+    template<CoreValueType T>
+    const T& Payload() const {
+        if constexpr (std::same_as<T, NullType>) return kNullPayload;
+        else if constexpr (std::same_as<T, Int>) return int_;
+        else if constexpr (std::same_as<T, Float>) return float_;
+        else if constexpr (std::same_as<T, Bool>) return bool_;
+        else if constexpr (std::same_as<T, String>) return string_;
+        else if constexpr (std::same_as<T, List>) return list_;
+        else if constexpr (std::same_as<T, Function>) return function_;
+        else if constexpr (std::same_as<T, Generator>) return generator_;
+        else if constexpr (std::same_as<T, File>) return file_;
+    }
+
+    /** @brief Constructs the payload of the other value of the same type in place. */
+    void CopyPayload(const Value& other);
+    void MovePayload(Value&& other);
+
+    void DestroyReference();
 };
 
+// the payload is a single word: a number or a handle
+static_assert(sizeof(Value) == 16);
+
 /** @brief Mapping from ValueType enum to string names for debugging/logging. */
 inline const std::map<ValueType, std::string> kValueTypeNames = {
     {ValueType::kNullType, "NullType"},
@@ -227,13 +374,8 @@ inline const std::map<ValueType, std::string> kValueTypeNames = {
     {ValueType::kBool, "Bool"},
     {ValueType::kFunction, "Function"},
     {ValueType::kList, "List"},
-};
-
-/** @brief Set containing all reference types. ReferenceValueType for more info. */
-inline const std::set<ValueType> kReferenceTypes = {
-    ValueType::kString,
-    ValueType::kFunction,
-    ValueType::kList,
+    {ValueType::kGenerator, "Generator"},
+    {ValueType::kFile, "File"},
 };
 
 /** 
@@ -243,12 +385,14 @@ inline const std::set<ValueType> kReferenceTypes = {
 const std::string& GetTypeName(ValueType type);
 
 template<CoreValueType T>
-ValueType GetType() {
+constexpr ValueType GetType() {
     if constexpr (std::is_same_v<T, Int>) return ValueType::kInt;
     if constexpr (std::is_same_v<T, Float>) return ValueType::kFloat;
     if constexpr (std::is_same_v<T, Bool>) return ValueType::kBool;
     if constexpr (std::is_same_v<T, Function>) return ValueType::kFunction;
     if constexpr (std::is_same_v<T, List>) return ValueType::kList;
+    if constexpr (std::is_same_v<T, Generator>) return ValueType::kGenerator;
+    if constexpr (std::is_same_v<T, File>) return ValueType::kFile;
     if constexpr (std::is_same_v<T, String>) return ValueType::kString;
     if constexpr (std::is_same_v<T, NullType>) return ValueType::kNullType;
 }
@@ -258,17 +402,8 @@ const std::string& GetTypeName() {
     return GetTypeName(GetType<T>());
 }
 
-/**
- * @brief Creates a shared_ptr to the given InnerType.
- * The given value gets moved to the constructor of the given type.
- */
-template<typename InnerType>
-std::shared_ptr<InnerType> CreateRefValue(InnerType& val) {
-    return std::make_shared<InnerType>(std::move(val));
-}
-
 static String CreateString(std::string val) {
-    return CreateRefValue(val);
+    return MakeRef<StringObject>(std::move(val));
 }
 
 } // namespace itmoscript
@@ -4,6 +4,7 @@
 
 #include <format>
 #include <string_view>
+#include <utility>
 
 namespace itmoscript {
 
@@ -46,8 +47,13 @@ Parser::Parser(Lexer& lexer)
     infix_parse_funcs_[TokenType::kLessOrEqual] = infix_parser;
     infix_parse_funcs_[TokenType::kGreater] = infix_parser;
     infix_parse_funcs_[TokenType::kGreaterOrEqual] = infix_parser;
-    infix_parse_funcs_[TokenType::kAnd] = infix_parser;
-    infix_parse_funcs_[TokenType::kOr] = infix_parser;
+
+    auto logical_parser = [this](std::shared_ptr<ast::Expression> left) {
+        return ParseLogicalExpression(std::move(left));
+    };
+
+    infix_parse_funcs_[TokenType::kAnd] = logical_parser;
+    infix_parse_funcs_[TokenType::kOr] = logical_parser;
     infix_parse_funcs_[TokenType::kLParen] = [this](std::shared_ptr<ast::Expression> function) {
         Token token = function->token;
         auto expr = ParseCallExpression(std::move(function));
@@ -94,6 +100,8 @@ std::shared_ptr<ast::Statement> Parser::ParseStatement() {
         }
     } else if (IsCurrentToken(TokenType::kReturn)) {
         return ParseReturnStatement();
+    } else if (IsCurrentToken(TokenType::kYield)) {
+        return ParseYieldStatement();
     } else if (IsCurrentToken(TokenType::kWhile)) {
         return ParseWhileStatement();
     } else if (IsCurrentToken(TokenType::kFor)) {
@@ -136,6 +144,27 @@ std::shared_ptr<ast::ReturnStatement> Parser::ParseReturnStatement() {
     auto statement = MakeNode<ast::ReturnStatement>();
     AdvanceToken();
 
+    if (!IsCurrentToken(TokenType::kEOF) && !IsCurrentToken(TokenType::kNewLine)) {
+        statement->expr = ParseExpression();
+
+        if (current_function_ != nullptr && !value_return_.has_value()) {
+            value_return_ = statement->token;
+        }
+    }
+
+    return statement;
+}
+
+std::shared_ptr<ast::YieldStatement> Parser::ParseYieldStatement() {
+    if (current_function_ == nullptr) {
+        ThrowError("'yield' outside of a function");
+    }
+
+    current_function_->is_generator = true;
+
+    auto statement = MakeNode<ast::YieldStatement>();
+    AdvanceToken();
+
     if (!IsCurrentToken(TokenType::kEOF) && !IsCurrentToken(TokenType::kNewLine)) {
         statement->expr = ParseExpression();
     }
@@ -342,14 +371,23 @@ std::shared_ptr<ast::PrefixExpression> Parser::ParsePrefixExpression() {
 
 std::shared_ptr<ast::InfixExpression> Parser::ParseInfixExpression(std::shared_ptr<ast::Expression> left) {
     auto infix_expr = MakeNode<ast::InfixExpression>();
-    infix_expr->oper = current_token_.type;
-    infix_expr->left = std::move(left);
+    ParseInfixOperands(*infix_expr, std::move(left));
+    return infix_expr;
+}
+
+std::shared_ptr<ast::LogicalExpression> Parser::ParseLogicalExpression(std::shared_ptr<ast::Expression> left) {
+    auto logical_expr = MakeNode<ast::LogicalExpression>();
+    ParseInfixOperands(*logical_expr, std::move(left));
+    return logical_expr;
+}
+
+void Parser::ParseInfixOperands(ast::InfixExpression& expr, std::shared_ptr<ast::Expression> left) {
+    expr.oper = current_token_.type;
+    expr.left = std::move(left);
 
     Precedence precedence = GetCurrentPrecedence();
     AdvanceToken();
-    infix_expr->right = ParseExpression(precedence);
-
-    return infix_expr;
+    expr.right = ParseExpression(precedence);
 }
 
 std::shared_ptr<ast::Expression> Parser::ParseGroupedExpression() {
@@ -422,9 +460,24 @@ std::shared_ptr<ast::FunctionLiteral> Parser::ParseFunctionLiteral() {
     auto function_lit = MakeNode<ast::FunctionLiteral>();
     Consume(TokenType::kLParen);
 
+    ast::FunctionLiteral* outer_function = std::exchange(current_function_, function_lit.get());
+    std::optional<Token> outer_return = std::exchange(value_return_, std::nullopt);
+
     function_lit->parameters = ParseFunctionParameters();
     function_lit->body = ParseBlockStatement();
 
+    // the values a generator produces are yielded, the end of the iteration can't carry one
+    if (function_lit->is_generator && value_return_.has_value()) {
+        throw lang_exceptions::ParsingError{
+            value_return_->line,
+            value_return_->column,
+            "'return' with a value in a generator"
+        };
+    }
+
+    current_function_ = outer_function;
+    value_return_ = std::move(outer_return);
+
     Consume(TokenType::kFunction);
     return function_lit;
 }
@@ -571,6 +624,13 @@ std::vector<std::shared_ptr<ast::Identifier>> Parser::ParseFunctionParameters()
         Consume(TokenType::kIdentifier);
 
         ident = ParseIdentifier();
+
+        for (const std::shared_ptr<ast::Identifier>& param : identifiers) {
+            if (param->name == ident->name) {
+                ThrowError(std::format("parameter {} is duplicate", ident->name));
+            }
+        }
+
         identifiers.push_back(std::move(ident));
     }
         
@@ -110,6 +110,12 @@ private:
     Token current_token_;
     Token peek_token_;
 
+    /** @brief Function literal being parsed, nullptr at the top level. A `yield` makes it a generator. */
+    ast::FunctionLiteral* current_function_ = nullptr;
+
+    /** @brief Token of the first `return` with a value in the current function, a generator can't have one. */
+    std::optional<Token> value_return_;
+
     /** @brief Reads next token from the lexer. */
     void AdvanceToken();
 
@@ -183,6 +189,10 @@ private:
 
     std::shared_ptr<ast::PrefixExpression> ParsePrefixExpression();
     std::shared_ptr<ast::InfixExpression> ParseInfixExpression(std::shared_ptr<ast::Expression> left);
+    std::shared_ptr<ast::LogicalExpression> ParseLogicalExpression(std::shared_ptr<ast::Expression> left);
+
+    /** @brief Parses the operator and the right operand of the binary expression. */
+    void ParseInfixOperands(ast::InfixExpression& expr, std::shared_ptr<ast::Expression> left);
 
     std::shared_ptr<ast::Identifier> ParseIdentifier();
     std::shared_ptr<ast::IntegerLiteral> ParseIntegerLiteral();
@@ -200,6 +210,7 @@ private:
     std::shared_ptr<ast::AssignStatement> ParseAssignStatement();
     std::shared_ptr<ast::OperatorAssignStatement> ParseOperatorAssignStatement();
     std::shared_ptr<ast::ReturnStatement> ParseReturnStatement();
+    std::shared_ptr<ast::YieldStatement> ParseYieldStatement();
     std::shared_ptr<ast::ExpressionStatement> ParseExpressionStatement();
     std::shared_ptr<ast::BreakStatement> ParseBreakStatement();
     std::shared_ptr<ast::ContinueStatement> ParseContinueStatement();
@@ -6,9 +6,12 @@
 namespace itmoscript {
 
 void REPL::Start(std::istream& input, std::ostream& output) {
-    if (mode_ == ReplMode::kEval) {
+    if (mode_ == ReplMode::kEval || mode_ == ReplMode::kOptimizer) {
         evaluator_.EnableStandardOperators();
         evaluator_.EnableStd();
+
+        // evaluated lines share the globals, so only the printed programs propagate them
+        evaluator_.EnableOptimizer(mode_ == ReplMode::kOptimizer);
     }
 
     while (true) { 
@@ -22,6 +25,8 @@ void REPL::Start(std::istream& input, std::ostream& output) {
                 EvalLexer(output);
             } else if (mode_ == ReplMode::kParser) {
                 EvalParser(output);
+            } else if (mode_ == ReplMode::kOptimizer) {
+                EvalOptimizer(output);
             } else if (mode_ == ReplMode::kEval) {
                 Eval(input, output);
             }
@@ -56,13 +61,29 @@ void REPL::EvalParser(std::ostream& output) {
     output << '\n';
 }
 
+void REPL::EvalOptimizer(std::ostream& output) {
+    Lexer lexer{current_line_};
+    Parser parser{lexer};
+    ast::Program program = parser.ParseProgram();
+
+    evaluator_.Optimize(program);
+
+    output << program.String();
+    output << '\n';
+}
+
 void REPL::Eval(std::istream& input, std::ostream& output) {
     Lexer lexer{current_line_};
     Parser parser{lexer};
     ast::Program program = parser.ParseProgram();
 
     std::ostringstream out;
-    evaluator_.Evaluate(program, input, out);
+
+    if (execution_mode_ == vm::ExecutionMode::kTreeWalk) {
+        evaluator_.Evaluate(program, input, out);
+    } else {
+        machine_.Evaluate(program, input, out);
+    }
     
     std::string printed = out.str();
     if (printed.empty()) {
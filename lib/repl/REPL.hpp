@@ -3,6 +3,7 @@
 #include "lexer/Lexer.hpp"
 #include "parser/Parser.hpp"
 #include "evaluation/Evaluator.hpp"
+#include "vm/VirtualMachine.hpp"
 
 #include <string>
 #include <iostream>
@@ -15,24 +16,30 @@ inline const std::string kReplPrompt = ">>> ";
 enum class ReplMode {
     kLexer,
     kParser,
+    kOptimizer,
     kEval
 };
 
 class REPL {
 public:
-    REPL(ReplMode mode = ReplMode::kEval)
-        : mode_(mode) {}
+    REPL(ReplMode mode = ReplMode::kEval, vm::ExecutionMode execution_mode = vm::ExecutionMode::kBytecode)
+        : mode_(mode), execution_mode_(execution_mode) {}
 
     void Start(std::istream& input, std::ostream& output);
 
+    void SetMaxCallDepth(size_t depth) { evaluator_.SetMaxCallDepth(depth); }
+
 private:
     ReplMode mode_;
+    vm::ExecutionMode execution_mode_;
     std::string current_line_;
 
     Evaluator evaluator_;
+    vm::VirtualMachine machine_{evaluator_};
 
     void EvalLexer(std::ostream& output);
     void EvalParser(std::ostream& output);
+    void EvalOptimizer(std::ostream& output);
     void Eval(std::istream& input, std::ostream& output);
 
     void PrintToken(std::ostream& output, const Token& token);
@@ -39,6 +39,21 @@ bool StdLib::HasValueHandlingFunc(const std::string& name) const {
     return functions_.contains(name);
 }
 
+const ValueHandlingFunction* StdLib::FindValueHandlingFunc(const std::string& name) const {
+    auto it = functions_.find(name);
+    return it != functions_.end() ? &it->second : nullptr;
+}
+
+const OutStreamHandlingFunction* StdLib::FindOutStreamHandlingFunc(const std::string& name) const {
+    auto it = out_stream_functions_.find(name);
+    return it != out_stream_functions_.end() ? &it->second : nullptr;
+}
+
+const InStreamHandlingFunction* StdLib::FindInStreamHandlingFunc(const std::string& name) const {
+    auto it = in_stream_functions_.find(name);
+    return it != in_stream_functions_.end() ? &it->second : nullptr;
+}
+
 void StdLib::Register(const std::string& name, ValueHandlingFunction func) {
     functions_[name] = std::move(func);
 }
@@ -54,7 +69,7 @@ void StdLib::RegisterInStreamHandlingFunc(const std::string& name, InStreamHandl
 Value StdLib::Call(
     const std::string& name, 
     std::vector<Value>& args,
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
     if (!functions_.contains(name)) {
@@ -67,7 +82,7 @@ Value StdLib::CallOutStreamHandlingFunc(
     std::ostream& stream,
     const std::string& name, 
     std::vector<Value>& args, 
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
     if (!out_stream_functions_.contains(name)) {
@@ -80,7 +95,7 @@ Value StdLib::CallInStreamHandlingFunc(
     std::istream& stream, 
     const std::string & name, 
     std::vector<Value>& args, 
-    Token from, 
+    const Token& from, 
     const CallStack & call_stack
 ) {
     if (!in_stream_functions_.contains(name)) {
@@ -90,13 +105,13 @@ Value StdLib::CallInStreamHandlingFunc(
 }
 
 void ThrowArgumentTypeError(
-    Token from, 
+    const Token& from, 
     const CallStack &call_stack, 
     size_t idx, 
     ValueType given_type, 
     const std::string &expected
 ) {
-    ThrowError<lang_exceptions::ArgumentTypeError>(std::move(from), call_stack, idx, given_type, expected);
+    ThrowError<lang_exceptions::ArgumentTypeError>(from, call_stack, idx, given_type, expected);
 }
 
 } // namespace stdlib
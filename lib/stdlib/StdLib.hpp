@@ -15,9 +15,9 @@ namespace itmoscript {
 
 namespace stdlib {
 
-using ValueHandlingFunction = std::function<Value(std::vector<Value>&, Token, const CallStack&)>;
-using OutStreamHandlingFunction = std::function<Value(std::ostream&, std::vector<Value>&, Token, const CallStack&)>;
-using InStreamHandlingFunction = std::function<Value(std::istream&, std::vector<Value>&, Token, const CallStack&)>;
+using ValueHandlingFunction = std::function<Value(std::vector<Value>&, const Token&, const CallStack&)>;
+using OutStreamHandlingFunction = std::function<Value(std::ostream&, std::vector<Value>&, const Token&, const CallStack&)>;
+using InStreamHandlingFunction = std::function<Value(std::istream&, std::vector<Value>&, const Token&, const CallStack&)>;
 
 class StdLib {
 public:
@@ -30,11 +30,16 @@ public:
     bool HasInStreamHandlingFunc(const std::string& name) const;
 
     bool Has(const std::string& name) const;
+
+    /** @brief Returns the function registered with the name, nullptr if there's no such function. */
+    const ValueHandlingFunction* FindValueHandlingFunc(const std::string& name) const;
+    const OutStreamHandlingFunction* FindOutStreamHandlingFunc(const std::string& name) const;
+    const InStreamHandlingFunction* FindInStreamHandlingFunc(const std::string& name) const;
     
     Value Call( 
         const std::string& name, 
         std::vector<Value>& args,
-        Token from, 
+        const Token& from, 
         const CallStack& call_stack
     );
 
@@ -42,7 +47,7 @@ public:
         std::ostream& stream,
         const std::string& name, 
         std::vector<Value>& args,
-        Token from, 
+        const Token& from, 
         const CallStack& call_stack
     );
 
@@ -50,7 +55,7 @@ public:
         std::istream& stream,
         const std::string& name, 
         std::vector<Value>& args,
-        Token from, 
+        const Token& from, 
         const CallStack& call_stack
     );
 
@@ -74,10 +79,10 @@ private:
  * If the amount of arguments passed to the returned lambda is not equal to arg_num,
  * ParametersCountError will be thrown by the wrapper.
  */
-template<typename F> requires std::invocable<F, std::vector<Value>&, Token, const CallStack&>
+template<typename F> requires std::invocable<F, std::vector<Value>&, const Token&, const CallStack&>
 auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
     return [name, fn, arg_num](std::vector<Value>& args,
-                         Token from,
+                         const Token& from,
                          const CallStack& stack) -> Value {
         if (args.size() != arg_num) {
             throw lang_exceptions::ParametersCountError{from, stack, name, arg_num, args.size()};
@@ -87,11 +92,11 @@ auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
     };
 }
 
-template<typename F> requires std::invocable<F, std::ostream&, std::vector<Value>&, Token, const CallStack&>
+template<typename F> requires std::invocable<F, std::ostream&, std::vector<Value>&, const Token&, const CallStack&>
 auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
     return [name, fn, arg_num](std::ostream& stream,
                          std::vector<Value>& args,
-                         Token from,
+                         const Token& from,
                          const CallStack& stack) -> Value {
         if (args.size() != arg_num) {
             throw lang_exceptions::ParametersCountError{from, stack, name, arg_num, args.size()};
@@ -101,11 +106,11 @@ auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
     };
 }
 
-template<typename F> requires std::invocable<F, std::istream&, std::vector<Value>&, Token, const CallStack&>
+template<typename F> requires std::invocable<F, std::istream&, std::vector<Value>&, const Token&, const CallStack&>
 auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
     return [name, fn, arg_num](std::istream& stream,
                          std::vector<Value>& args,
-                         Token from,
+                         const Token& from,
                          const CallStack& stack) -> Value {
         if (args.size() != arg_num) {
             throw lang_exceptions::ParametersCountError{from, stack, name, arg_num, args.size()};
@@ -116,12 +121,12 @@ auto MakeBuiltin(const std::string& name, F fn, size_t arg_num) {
 }
 
 template<typename ErrorType, typename... Args>
-void ThrowError(Token from, const CallStack& call_stack, Args&&... args) {
-    throw ErrorType{std::move(from), call_stack, std::forward<Args>(args)...};
+void ThrowError(const Token& from, const CallStack& call_stack, Args&&... args) {
+    throw ErrorType{from, call_stack, std::forward<Args>(args)...};
 }
 
 void ThrowArgumentTypeError(
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack, 
     size_t idx, 
     ValueType given_type, 
@@ -132,11 +137,11 @@ template<typename T>
 void AssertType(
     const Value& val,
     size_t idx, 
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
     if (!val.IsOfType<T>()) {
-        ThrowArgumentTypeError(std::move(from), call_stack, idx, val.GetType(), GetTypeName<T>());
+        ThrowArgumentTypeError(from, call_stack, idx, val.GetType(), GetTypeName<T>());
     }
 }
     
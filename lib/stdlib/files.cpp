@@ -2,63 +2,211 @@
 
 #include "StdLib.hpp"
 #include "objects/List.hpp"
+#include "objects/Generator.hpp"
+#include "objects/File.hpp"
 
 #include "exceptions/FileAccessError.hpp"
+#include "exceptions/InvalidArgumentError.hpp"
 
 #include <fstream>
-#include <sstream>
 #include <filesystem>
+#include <format>
+#include <optional>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ITMOSCRIPT_HAS_MMAP
+#endif
 
 namespace itmoscript {
 
 namespace stdlib {
 
 namespace files {
-    
+
+namespace {
+
+/**
+ * @brief Reads the whole file with a single copy of the text.
+ * A regular file is mapped to memory and copied from the mapping into the string,
+ * other files (pipes, devices) are read by chunks.
+ * @return std::nullopt if the file can't be opened or read.
+ */
+std::optional<std::string> ReadWholeFile(const std::string& filename) {
+#ifdef ITMOSCRIPT_HAS_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> result;
+    struct stat info;
+
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        auto size = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            result.emplace(static_cast<const char*>(mapping), size);
+            munmap(mapping, size);
+        }
+    }
+
+    if (!result.has_value()) {
+        constexpr size_t kChunkSize = size_t{1} << 16;
+        result.emplace();
+
+        while (true) {
+            size_t size = result->size();
+            result->resize(size + kChunkSize);
+            ssize_t count = read(fd, result->data() + size, kChunkSize);
+
+            if (count < 0) {
+                result.reset();
+                break;
+            }
+
+            result->resize(size + static_cast<size_t>(count));
+
+            if (count == 0) {
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return result;
+#else
+    std::ifstream file{filename, std::ios::binary | std::ios::ate};
+
+    if (!file.good()) {
+        return std::nullopt;
+    }
+
+    std::string result(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(result.data(), static_cast<std::streamsize>(result.size()));
+    result.resize(static_cast<size_t>(file.gcount()));
+    return result;
+#endif
+}
+
+/**
+ * @class FileLinesGenerator
+ * @brief Generator of the lines of a file, see file_lines(). Only the current line is held in memory.
+ */
+class FileLinesGenerator : public GeneratorObject {
+public:
+    explicit FileLinesGenerator(const std::string& filename)
+        : buffer_(kBufferSize) {
+        // the buffer must be set before the file is opened
+        file_.rdbuf()->pubsetbuf(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        file_.open(filename);
+    }
+
+    bool is_open() const { return file_.is_open(); }
+
+    std::optional<Value> Next() override {
+        std::string line;
+
+        if (!file_.is_open() || !std::getline(file_, line)) {
+            file_.close();
+            return std::nullopt;
+        }
+
+        return CreateString(std::move(line));
+    }
+
+private:
+    static constexpr size_t kBufferSize = size_t{1} << 16;
+
+    std::vector<char> buffer_;
+    std::ifstream file_;
+};
+
+/** @brief Checks that the argument is an open File. */
+FileObject& GetOpenFile(const Value& arg, const Token& from, const CallStack& call_stack) {
+    AssertType<File>(arg, 0, from, call_stack);
+    FileObject& file = *arg.Get<File>();
+
+    if (!file.is_open()) {
+        ThrowError<lang_exceptions::InvalidArgumentError>(
+            from,
+            call_stack,
+            0uz,
+            std::format("file '{}' is closed", file.path())
+        );
+    }
+
+    return file;
+}
+
+} // namespace
+
 void RegisterAll(StdLib& lib) {
     lib.Register("file_read", MakeBuiltin("file_read", FileRead, 1));
     lib.Register("file_read_lines", MakeBuiltin("file_read_lines", FileReadLines, 1));
+    lib.Register("file_lines", MakeBuiltin("file_lines", FileLines, 1));
     lib.Register("file_write", MakeBuiltin("file_write", FileWrite, 2));
     lib.Register("file_append", MakeBuiltin("file_append", FileAppend, 2));
     lib.Register("file_exists", MakeBuiltin("file_exists", FileExists, 1));
+    lib.Register("file_open", FileOpen);
+    lib.Register("file_write_handle", MakeBuiltin("file_write_handle", FileWriteHandle, 2));
+    lib.Register("file_flush", MakeBuiltin("file_flush", FileFlush, 1));
+    lib.Register("file_close", MakeBuiltin("file_close", FileClose, 1));
 }
 
-Value FileRead(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value FileRead(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
 
     const std::string& filename = *args[0].Get<String>();
-    std::ifstream file{filename};
+    std::optional<std::string> text = ReadWholeFile(filename);
 
-    if (!file.good()) {
+    if (!text.has_value()) {
         ThrowError<lang_exceptions::FileAccessError>(from, call_stack, filename);
     }
 
-    std::ostringstream buf;
-    buf << file.rdbuf();
-    return CreateString(buf.str());
+    return CreateString(std::move(*text));
 }
 
-Value FileReadLines(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value FileReadLines(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
 
     const std::string& filename = *args[0].Get<String>();
-    std::ifstream file{filename};
+    FileLinesGenerator lines{filename};
 
-    if (!file.good()) {
+    if (!lines.is_open()) {
         ThrowError<lang_exceptions::FileAccessError>(from, call_stack, filename);
     }
 
-    std::string line;
     std::vector<Value> result;
 
-    while (std::getline(file, line)) {
-        result.push_back(CreateString(std::move(line)));
+    while (std::optional<Value> line = lines.Next()) {
+        result.push_back(std::move(*line));
     }
 
     return CreateList(std::move(result));
 }
 
-Value FileWrite(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value FileLines(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    AssertType<String>(args[0], 0, from, call_stack);
+
+    const std::string& filename = *args[0].Get<String>();
+    Generator lines{new FileLinesGenerator(filename)};
+
+    if (!static_cast<FileLinesGenerator&>(*lines).is_open()) {
+        ThrowError<lang_exceptions::FileAccessError>(from, call_stack, filename);
+    }
+
+    return lines;
+}
+
+Value FileWrite(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
 
     const std::string& filename = *args[0].Get<String>();
@@ -77,7 +225,7 @@ Value FileWrite(const std::vector<Value>& args, Token from, const CallStack& cal
     return NullType{};
 }
 
-Value FileAppend(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value FileAppend(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
 
     const std::string& filename = *args[0].Get<String>();
@@ -96,9 +244,94 @@ Value FileAppend(const std::vector<Value>& args, Token from, const CallStack& ca
     return NullType{};
 }
 
-Value FileExists(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value FileExists(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    AssertType<String>(args[0], 0, from, call_stack);
+    const std::string& filename = *args[0].Get<String>();
+    return std::filesystem::exists(filename);
+}
+
+Value FileOpen(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    if (args.size() < 2 || args.size() > 3) {
+        throw lang_exceptions::ParametersCountError{from, call_stack, "file_open", 2, args.size()};
+    }
+
     AssertType<String>(args[0], 0, from, call_stack);
-    return std::filesystem::exists(*args[0].Get<String>());
+    AssertType<String>(args[1], 1, from, call_stack);
+
+    const std::string& filename = *args[0].Get<String>();
+    const std::string& mode = *args[1].Get<String>();
+
+    if (mode != "w" && mode != "a") {
+        ThrowError<lang_exceptions::InvalidArgumentError>(
+            from,
+            call_stack,
+            1uz,
+            std::format("unknown file mode '{}', expected \"w\" or \"a\"", mode)
+        );
+    }
+
+    size_t buffer_size = FileObject::kDefaultBufferSize;
+
+    if (args.size() == 3) {
+        AssertType<Int>(args[2], 2, from, call_stack);
+
+        if (args[2].Get<Int>() < 0) {
+            ThrowError<lang_exceptions::InvalidArgumentError>(
+                from,
+                call_stack,
+                2uz,
+                "buffer size in file_open() can't be negative"
+            );
+        }
+
+        buffer_size = static_cast<size_t>(args[2].Get<Int>());
+    }
+
+    File file{new FileObject(filename, mode == "a" ? FileObject::Mode::kAppend : FileObject::Mode::kWrite, buffer_size)};
+
+    if (!file->is_open()) {
+        ThrowError<lang_exceptions::FileAccessError>(from, call_stack, filename);
+    }
+
+    return file;
+}
+
+Value FileWriteHandle(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    FileObject& file = GetOpenFile(args[0], from, call_stack);
+    bool written;
+
+    if (args[1].IsOfType<String>()) {
+        written = file.Write(*args[1].Get<String>());
+    } else {
+        written = file.Write(args[1].ToString());
+    }
+
+    if (!written) {
+        ThrowError<lang_exceptions::FileAccessError>(from, call_stack, file.path());
+    }
+
+    return NullType{};
+}
+
+Value FileFlush(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    FileObject& file = GetOpenFile(args[0], from, call_stack);
+
+    if (!file.Flush()) {
+        ThrowError<lang_exceptions::FileAccessError>(from, call_stack, file.path());
+    }
+
+    return NullType{};
+}
+
+Value FileClose(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    AssertType<File>(args[0], 0, from, call_stack);
+    FileObject& file = *args[0].Get<File>();
+
+    if (!file.Close()) {
+        ThrowError<lang_exceptions::FileAccessError>(from, call_stack, file.path());
+    }
+
+    return NullType{};
 }
 
 } // namespace files
@@ -13,11 +13,16 @@ namespace files {
 
 void RegisterAll(StdLib& lib);
 
-Value FileRead(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value FileReadLines(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value FileWrite(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value FileAppend(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value FileExists(const std::vector<Value>& args, Token from, const CallStack& call_stack);
+Value FileRead(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileReadLines(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileLines(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileWrite(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileAppend(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileExists(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileOpen(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileWriteHandle(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileFlush(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value FileClose(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
     
 } // namespace files
 
@@ -25,11 +25,23 @@ void RegisterAll(StdLib& lib) {
     lib.Register("set", MakeBuiltin("set", Set, 3));
 }
 
-Value Len(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Len(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     const Value& arg = args[0];
 
-    if (!arg.IsOfType<List>() && !arg.IsOfType<String>()) {
-        ThrowArgumentTypeError(std::move(from), call_stack, 0, arg.GetType(), "List or String");
+    if (!arg.IsOfType<List>() && !arg.IsOfType<String>() && !arg.IsOfType<Generator>()) {
+        ThrowArgumentTypeError(from, call_stack, 0, arg.GetType(), "List, String or Generator");
+    }
+
+    // the generator is drained, its values are counted without being stored
+    if (arg.IsOfType<Generator>()) {
+        Generator generator = arg.Get<Generator>();
+        Int count = 0;
+
+        while (generator->Next().has_value()) {
+            ++count;
+        }
+
+        return count;
     }
 
     if (arg.IsOfType<List>()) {
@@ -39,7 +51,7 @@ Value Len(const std::vector<Value>& args, Token from, const CallStack& call_stac
     }
 }
 
-Value Range(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Range(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     if (args.size() == 0 || args.size() > 3) {
         throw lang_exceptions::ParametersCountError{from, call_stack, "range", 1, args.size()};
     }
@@ -65,41 +77,38 @@ Value Range(const std::vector<Value>& args, Token from, const CallStack& call_st
 
     if (step == 0) {
         ThrowError<lang_exceptions::InvalidArgumentError>(
-            std::move(from),
+            from,
             call_stack,
             2uz,
             "step in range() can't be zero"
         );
     }
 
-    std::vector<Value> result;
-    result.reserve(std::abs(end - start) / std::abs(step));
+    // the differences are computed in unsigned numbers, where they can't overflow
+    uint64_t count = 0;
 
-    if (step > 0) {
-        for (int64_t i = 0; start + i * step < end; ++i) {
-            result.push_back(Value{start + i * step});
-        }
-    } else {
-        for (int64_t i = 0; start + i * step > end; ++i) {
-            result.push_back(Value{start + i * step});
-        }
+    if (step > 0 && start < end) {
+        count = (static_cast<uint64_t>(end) - static_cast<uint64_t>(start) - 1) / static_cast<uint64_t>(step) + 1;
+    } else if (step < 0 && start > end) {
+        count = (static_cast<uint64_t>(start) - static_cast<uint64_t>(end) - 1) / (0 - static_cast<uint64_t>(step)) + 1;
     }
 
-    return CreateList(result);
+    // the numbers are computed when they are accessed, so a loop over a range runs in constant memory
+    return CreateList(ListObject::MakeRange(start, step, count));
 }
 
-Value Push(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Push(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     List& list = args[0].Get<List>();
     list->Insert(list->size(), std::move(args[1]));
     return list;
 }
 
-Value Pop(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Pop(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<List>(args[0], 0, from, call_stack);
     List& list = args[0].Get<List>();
 
     if (list->size() == 0) {
-        ThrowError<lang_exceptions::EmptyListPopError>(std::move(from), call_stack);
+        ThrowError<lang_exceptions::EmptyListPopError>(from, call_stack);
     }
 
     Value removed = list->At(list->size() - 1);
@@ -107,7 +116,7 @@ Value Pop(std::vector<Value>& args, Token from, const CallStack& call_stack) {
     return removed;
 }
 
-Value Insert(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Insert(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<List>(args[0], 0, from, call_stack);
     AssertType<Int>(args[1], 1, from, call_stack);
 
@@ -116,7 +125,7 @@ Value Insert(std::vector<Value>& args, Token from, const CallStack& call_stack)
 
     if (index < 0 || index > list->size()) {
         ThrowError<lang_exceptions::IndexOutOfRangeError>(
-            std::move(from), call_stack, index, list->size()
+            from, call_stack, index, list->size()
         );
     }
 
@@ -124,7 +133,7 @@ Value Insert(std::vector<Value>& args, Token from, const CallStack& call_stack)
     return list;
 }
 
-Value Remove(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Remove(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<List>(args[0], 0, from, call_stack);
     AssertType<Int>(args[1], 1, from, call_stack);
 
@@ -133,7 +142,7 @@ Value Remove(std::vector<Value>& args, Token from, const CallStack& call_stack)
 
     if (index < 0 || index >= list->size()) {
         ThrowError<lang_exceptions::IndexOutOfRangeError>(
-            std::move(from), call_stack, index, list->size()
+            from, call_stack, index, list->size()
         );
     }
 
@@ -141,14 +150,26 @@ Value Remove(std::vector<Value>& args, Token from, const CallStack& call_stack)
     return list;
 }
 
-Value Sort(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Sort(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    // the values of a generator are collected into a new list
+    if (args[0].IsOfType<Generator>()) {
+        Generator generator = args[0].Get<Generator>();
+        std::vector<Value> elements;
+
+        while (std::optional<Value> element = generator->Next()) {
+            elements.push_back(std::move(*element));
+        }
+
+        args[0] = CreateList(std::move(elements));
+    }
+
     AssertType<List>(args[0], 0, from, call_stack);
     List& list = args[0].Get<List>();
     list->Sort();
     return list;
 }
 
-Value Set(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Set(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<List>(args[0], 0, from, call_stack);
     AssertType<Int>(args[1], 1, from, call_stack);
 
@@ -157,11 +178,11 @@ Value Set(std::vector<Value>& args, Token from, const CallStack& call_stack) {
 
     if (index < 0 || index >= list->size()) {
         ThrowError<lang_exceptions::IndexOutOfRangeError>(
-            std::move(from), call_stack, index, list->size()
+            from, call_stack, index, list->size()
         );
     }
 
-    list->At(index) = args[2].GetCopy();
+    list->Set(index, args[2].GetCopy());
     return list;
 }
 
@@ -11,15 +11,15 @@ namespace lists {
 
 void RegisterAll(StdLib& lib);
 
-Value Len(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-
-Value Range(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Push(std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Pop(std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Insert(std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Remove(std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Sort(std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Set(std::vector<Value>& args, Token from, const CallStack& call_stack);
+Value Len(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+
+Value Range(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Push(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Pop(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Insert(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Remove(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Sort(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Set(std::vector<Value>& args, const Token& from, const CallStack& call_stack);
 
 } // namespace lists
     
@@ -26,13 +26,13 @@ void RegisterAll(StdLib& lib) {
     lib.Register("to_string", MakeBuiltin("to_string", ToString, 1));
 }
 
-void AssertIntOrFloat(const Value& val, size_t idx, Token from, const CallStack& call_stack) {
+void AssertIntOrFloat(const Value& val, size_t idx, const Token& from, const CallStack& call_stack) {
     if (!val.IsOfType<Int>() && !val.IsOfType<Float>()) {
-        ThrowArgumentTypeError(std::move(from), call_stack, idx, val.GetType(), "Int or Float");
+        ThrowArgumentTypeError(from, call_stack, idx, val.GetType(), "Int or Float");
     }
 }
 
-Value Abs(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Abs(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
 
     if (args[0].IsOfType<Int>()) {
@@ -42,7 +42,7 @@ Value Abs(const std::vector<Value>& args, Token from, const CallStack& call_stac
     return std::abs(args[0].Get<Float>());
 }
 
-Value Ceil(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Ceil(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
     if (args[0].IsOfType<Int>()) {
         return args[0].Get<Int>();
@@ -51,7 +51,7 @@ Value Ceil(const std::vector<Value>& args, Token from, const CallStack& call_sta
     return std::ceil(args[0].Get<Float>());
 }
 
-Value Floor(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Floor(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
     if (args[0].IsOfType<Int>()) {
         return args[0].Get<Int>();
@@ -60,7 +60,7 @@ Value Floor(const std::vector<Value>& args, Token from, const CallStack& call_st
     return std::floor(args[0].Get<Float>());
 }
 
-Value Round(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Round(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
     if (args[0].IsOfType<Int>()) {
         return args[0].Get<Int>();
@@ -69,7 +69,7 @@ Value Round(const std::vector<Value>& args, Token from, const CallStack& call_st
     return std::round(args[0].Get<Float>());
 }
 
-Value Sqrt(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Sqrt(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
     if (args[0].IsOfType<Int>()) {
         if (args[0].Get<Int>() < 0) {
@@ -86,7 +86,7 @@ Value Sqrt(const std::vector<Value>& args, Token from, const CallStack& call_sta
     return std::sqrt(args[0].Get<Float>());
 }
 
-Value Rnd(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Rnd(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<Int>(args[0], 0, from, call_stack);
     Int n = args[0].Get<Int>();
 
@@ -104,7 +104,7 @@ Value Rnd(const std::vector<Value>& args, Token from, const CallStack& call_stac
     return idist(rgen);
 }
 
-Value ParseNum(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value ParseNum(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
     auto try_float = utils::ParseNumber<Float>(*args[0].Get<String>());
 
@@ -124,7 +124,7 @@ Value ParseNum(const std::vector<Value>& args, Token from, const CallStack& call
     return NullType{};
 }
 
-Value ToString(const std::vector<Value> &args, Token from, const CallStack& call_stack) {
+Value ToString(const std::vector<Value> &args, const Token& from, const CallStack& call_stack) {
     AssertIntOrFloat(args[0], 0, from, call_stack);
     if (args[0].IsOfType<Int>()) {
         return CreateString(std::to_string(args[0].Get<Int>()));
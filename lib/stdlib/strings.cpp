@@ -19,7 +19,7 @@ void RegisterAll(StdLib& lib) {
     lib.Register("replace", MakeBuiltin("replace", Replace, 3));
 }
 
-Value Lower(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Lower(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
     const String& original = args[0].Get<String>();
     std::string lowered;
@@ -35,7 +35,7 @@ Value Lower(const std::vector<Value>& args, Token from, const CallStack& call_st
     return CreateString(lowered);
 }
 
-Value Upper(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Upper(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
     const String& original = args[0].Get<String>();
     std::string uppered;
@@ -51,7 +51,7 @@ Value Upper(const std::vector<Value>& args, Token from, const CallStack& call_st
     return CreateString(uppered);
 }
 
-Value Split(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Split(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
     AssertType<String>(args[1], 1, from, call_stack);
 
@@ -76,22 +76,46 @@ Value Split(const std::vector<Value>& args, Token from, const CallStack& call_st
     return CreateList(std::move(result));
 }
 
-Value Join(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
-    AssertType<List>(args[0], 0, from, call_stack);
+Value Join(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    if (!args[0].IsOfType<List>() && !args[0].IsOfType<Generator>()) {
+        ThrowArgumentTypeError(from, call_stack, 0, args[0].GetType(), "List or Generator");
+    }
+
     AssertType<String>(args[1], 1, from, call_stack);
 
+    auto to_string = [](const Value& val) {
+        return val.IsOfType<String>() ? *val.Get<String>() : val.ToString();
+    };
+
+    // the values of a generator are appended as they are yielded
+    if (args[0].IsOfType<Generator>()) {
+        Generator generator = args[0].Get<Generator>();
+        const std::string& glue = *args[1].Get<String>();
+        std::string result;
+        bool first = true;
+
+        while (std::optional<Value> element = generator->Next()) {
+            if (!first) {
+                result += glue;
+            }
+
+            result += to_string(*element);
+            first = false;
+        }
+
+        return CreateString(std::move(result));
+    }
+
     std::string result = utils::Join<Value, std::string>(
         args[0].Get<List>()->data(),
         *args[1].Get<String>(),
-        [](const Value& val) {
-            return val.IsOfType<String>() ? *val.Get<String>() : val.ToString();
-        }
+        to_string
     );
 
     return CreateString(std::move(result));
 }
 
-Value Replace(std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Replace(std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     AssertType<String>(args[0], 0, from, call_stack);
     AssertType<String>(args[1], 1, from, call_stack);
     AssertType<String>(args[2], 2, from, call_stack);
@@ -2,9 +2,13 @@
 
 #include "StdLib.hpp"
 #include "objects/List.hpp"
+#include "objects/CycleCollector.hpp"
+#include "objects/MemoTable.hpp"
 #include "utils.hpp"
 #include "LangException.hpp"
 
+#include "exceptions/InvalidArgumentError.hpp"
+
 namespace itmoscript {
 
 namespace stdlib {
@@ -17,32 +21,43 @@ void RegisterAll(StdLib& lib) {
     lib.RegisterInStreamHandlingFunc("read", MakeBuiltin("read", Read, 0));
     lib.Register("stacktrace", MakeBuiltin("stacktrace", Stacktrace, 0));
     lib.Register("type_of", MakeBuiltin("type_of", TypeOf, 1));
+    lib.Register("gc", MakeBuiltin("gc", Gc, 0));
+    lib.Register("gc_threshold", MakeBuiltin("gc_threshold", GcThreshold, 1));
+    lib.Register("memo_stats", MakeBuiltin("memo_stats", MemoStats, 1));
 }
 
 Value Print(
     std::ostream& os, 
     const std::vector<Value>& args, 
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
-    os << (args[0].IsOfType<String>() ? *args[0].Get<String>() : args[0].ToString());
+    if (args[0].IsOfType<String>()) {
+        os << *args[0].Get<String>();
+    } else {
+        args[0].Serialize(os);
+    }
+
     return NullType{};
 }
 
 Value PrintLn(
     std::ostream& os, 
     const std::vector<Value>& args, 
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
-    os << (args[0].IsOfType<String>() ? *args[0].Get<String>() : args[0].ToString()) << std::endl;
+    Print(os, args, from, call_stack);
+
+    // the line is flushed by the output sink if its policy says so
+    os.put('\n');
     return NullType{};
 }
 
 Value Read(
     std::istream& is, 
     const std::vector<Value>& args, 
-    Token from, 
+    const Token& from, 
     const CallStack& call_stack
 ) {
     std::string input;
@@ -50,24 +65,68 @@ Value Read(
     return CreateString(std::move(input));
 }
 
-Value Stacktrace(const std::vector<Value>& args, Token from, const CallStack& call_stack) {
+Value Stacktrace(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
     std::vector<Value> result;
     result.reserve(call_stack.size());
 
     for (const CallFrame& frame : call_stack) {
         std::vector<Value> pair(2);
-        pair[0] = CreateString(frame.function_name);
-        pair[1] = static_cast<Int>(frame.entry_token.line);
+        pair[0] = CreateString(*frame.function_name);
+        pair[1] = static_cast<Int>(frame.entry_token->line);
         result.push_back(CreateList(std::move(pair)));
     }
 
     return CreateList(std::move(result));
 }
 
-Value TypeOf(const std::vector<Value>& args, Token from, const CallStack &call_stack) {
+Value TypeOf(const std::vector<Value>& args, const Token& from, const CallStack &call_stack) {
     return CreateString(args[0].GetTypeName());
 }
 
+Value Gc(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    return static_cast<Int>(CycleCollector::Instance().Collect());
+}
+
+Value GcThreshold(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    AssertType<Int>(args[0], 0, from, call_stack);
+
+    if (args[0].Get<Int>() < 0) {
+        ThrowError<lang_exceptions::InvalidArgumentError>(
+            from,
+            call_stack,
+            0uz,
+            "threshold in gc_threshold() can't be negative"
+        );
+    }
+
+    CycleCollector& collector = CycleCollector::Instance();
+    auto previous = static_cast<Int>(collector.threshold());
+    collector.SetThreshold(args[0].Get<Int>());
+
+    return previous;
+}
+
+Value MemoStats(const std::vector<Value>& args, const Token& from, const CallStack& call_stack) {
+    AssertType<Function>(args[0], 0, from, call_stack);
+
+    const std::shared_ptr<MemoTable>& memo = args[0].Get<Function>().memo();
+
+    if (memo == nullptr) {
+        ThrowError<lang_exceptions::InvalidArgumentError>(
+            from,
+            call_stack,
+            0uz,
+            "function passed to memo_stats() is not memoized"
+        );
+    }
+
+    return CreateList(std::vector<Value>{
+        static_cast<Int>(memo->hits()),
+        static_cast<Int>(memo->misses()),
+        static_cast<Int>(memo->size()),
+    });
+}
+
 } // namespace lists
     
 } // namespace stdlib
@@ -15,11 +15,20 @@ namespace sys {
 
 void RegisterAll(StdLib& lib);
 
-Value Print(std::ostream& os, const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value PrintLn(std::ostream& os, const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Read(std::istream& is, const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value Stacktrace(const std::vector<Value>& args, Token from, const CallStack& call_stack);
-Value TypeOf(const std::vector<Value>& args, Token from, const CallStack& call_stack);
+Value Print(std::ostream& os, const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value PrintLn(std::ostream& os, const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Read(std::istream& is, const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value Stacktrace(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+Value TypeOf(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+
+/** @brief Collects the lists kept alive only by reference cycles, returns their number. */
+Value Gc(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+
+/** @brief Sets the number of list allocations between automatic collections, returns the previous one. */
+Value GcThreshold(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
+
+/** @brief Returns [hits, misses, size] of the cache of the function created by memoize(). */
+Value MemoStats(const std::vector<Value>& args, const Token& from, const CallStack& call_stack);
     
 } // namespace math
 
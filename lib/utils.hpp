@@ -10,6 +10,7 @@
 #include <concepts>
 #include <sstream>
 #include <functional>
+#include <span>
 
 namespace itmoscript {
 
@@ -45,7 +46,7 @@ std::expected<T, std::errc> ParseNumber(std::string_view str) {
 }
 
 template<typename T>
-std::optional<std::vector<T>> MultiplyVec(const std::vector<T>& vec, double times) {
+std::optional<std::vector<T>> MultiplyVec(std::span<const T> vec, double times) {
     if (times < 0) return std::nullopt;
 
     size_t whole_part = static_cast<size_t>(times);
@@ -67,7 +68,7 @@ std::optional<std::vector<T>> MultiplyVec(const std::vector<T>& vec, double time
 }
 
 template<typename T, typename Out = T>
-std::string Join(const std::vector<T>& objects, const std::string& glue, const std::function<Out(const T&)>& getter) {
+std::string Join(std::span<const T> objects, const std::string& glue, const std::function<Out(const T&)>& getter) {
     std::ostringstream result;
     for (size_t i = 0; i < objects.size(); ++i) {
         result << std::invoke(getter, objects[i]);
@@ -0,0 +1,89 @@
+#include "Chunk.hpp"
+
+#include <format>
+
+namespace itmoscript {
+
+namespace vm {
+
+std::string Chunk::Disassemble() const {
+    std::string result;
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instr = code[i];
+        result += std::format("{:>4} {:<24}", i, kOpCodeNames.at(instr.op));
+
+        switch (instr.op) {
+            case OpCode::kConstant:
+            case OpCode::kCopyConstant:
+            case OpCode::kControlFlowError:
+                result += std::format("{} ({})", instr.operand, constants[instr.operand].ToString());
+                break;
+            case OpCode::kLoadName:
+            case OpCode::kAssign:
+            case OpCode::kAssignCopy:
+                result += std::format("{} ({})", instr.operand, variables[instr.operand].name);
+                break;
+            case OpCode::kStandardOverrideError:
+                result += std::format("{} ({})", instr.operand, names[instr.operand]);
+                break;
+            case OpCode::kPopScope:
+                result += std::format(
+                    "{} ([{}, {}))",
+                    instr.operand,
+                    scopes[instr.operand].begin,
+                    scopes[instr.operand].end
+                );
+                break;
+            case OpCode::kLoadInvariant:
+            case OpCode::kStoreInvariant:
+                result += std::format(
+                    "{} (slot {}, end {})",
+                    instr.operand,
+                    invariants[instr.operand].slot,
+                    invariants[instr.operand].end
+                );
+                break;
+            case OpCode::kUnaryOp:
+            case OpCode::kBinaryOp:
+                result += kTokenTypeNames.at(static_cast<TokenType>(instr.operand));
+                break;
+            case OpCode::kCall:
+            case OpCode::kCallBuiltin:
+            case OpCode::kTailCall:
+            case OpCode::kEnterInline:
+                result += std::format(
+                    "{} ({}, {} args)",
+                    instr.operand,
+                    call_sites[instr.operand].function_name,
+                    call_sites[instr.operand].args_count
+                );
+                break;
+            case OpCode::kLoadLocal:
+            case OpCode::kStoreLocal:
+            case OpCode::kSlice:
+            case OpCode::kBuildList:
+            case OpCode::kMakeFunction:
+            case OpCode::kJump:
+            case OpCode::kJumpIfFalse:
+            case OpCode::kJumpIfTrue:
+            case OpCode::kIterNext:
+                result += std::to_string(instr.operand);
+                break;
+            default:
+                break;
+        }
+
+        while (!result.empty() && result.back() == ' ') {
+            result.pop_back();
+        }
+
+        result += '\n';
+    }
+
+    return result;
+}
+
+} // namespace vm
+
+} // namespace itmoscript
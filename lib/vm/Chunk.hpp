@@ -0,0 +1,113 @@
+#pragma once
+
+#include "OpCode.hpp"
+#include "ast/AST.hpp"
+#include "lexer/Token.hpp"
+#include "objects/Value.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace itmoscript {
+
+namespace vm {
+
+struct CompiledFunction;
+
+/**
+ * @struct Instruction
+ * @brief A single VM instruction: the opcode and its operand.
+ * @see OpCode for the meaning of the operand.
+ */
+struct Instruction {
+    OpCode op;
+    uint32_t operand = 0;
+};
+
+/** @brief Kinds of the standard library functions, mirroring the StdLib registries. */
+enum class BuiltinKind {
+    kValueHandling,
+    kOutStreamHandling,
+    kInStreamHandling,
+};
+
+/**
+ * @struct CallSite
+ * @brief Static information about a call expression, referenced by the call instructions.
+ */
+struct CallSite {
+    std::string function_name; // name for the stacktrace, "<anonymous function>" if unnamed
+    std::string callee;        // printed callee expression, used in UncallableObjectCallError
+    uint32_t args_count = 0;
+    uint32_t name = 0;         // index in Chunk::names, only for kCallBuiltin
+    BuiltinKind builtin_kind = BuiltinKind::kValueHandling;
+};
+
+/**
+ * @struct Variable
+ * @brief Identifier whose slot is known only at runtime, referenced by kLoadName and kAssign*.
+ */
+struct Variable {
+    std::string name;
+    ast::Binding binding;
+};
+
+/** @brief Local slots [begin, end) of a block scope, referenced by kPopScope. */
+struct SlotRange {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+};
+
+/**
+ * @struct InvariantSite
+ * @brief Compiled ast::InvariantExpression, referenced by kLoadInvariant and kStoreInvariant.
+ */
+struct InvariantSite {
+    uint32_t slot = 0;
+    uint32_t end = 0; // offset of the instruction after the computation
+    std::vector<ast::Binding> inputs;
+};
+
+/**
+ * @struct Chunk
+ * @brief Compiled bytecode of a single function (or of the top-level program)
+ * together with all the tables its instructions refer to.
+ */
+struct Chunk {
+    std::vector<Instruction> code;
+
+    /** @brief Index in tokens for every instruction, used to report errors. */
+    std::vector<uint32_t> positions;
+    std::vector<Token> tokens;
+
+    std::vector<Value> constants;
+    std::vector<std::string> names;
+    std::vector<Variable> variables;
+    std::vector<SlotRange> scopes;
+    std::vector<InvariantSite> invariants;
+    std::vector<CallSite> call_sites;
+    /** @brief Prototypes of the function literals, compiled together with the chunk. */
+    std::vector<std::shared_ptr<const FunctionPrototype>> functions;
+
+    /** @brief Returns human-readable listing of the chunk, one instruction per line. */
+    std::string Disassemble() const;
+};
+
+/**
+ * @struct CompiledFunction
+ * @brief Function body compiled to bytecode, kept in its FunctionPrototype.
+ * The AST parts stay in the prototype, so the functions created by the VM
+ * remain usable by the tree-walking Evaluator.
+ */
+struct CompiledFunction {
+    /** @brief Number of local slots of the function frame. */
+    uint32_t frame_size = 0;
+
+    Chunk chunk;
+};
+
+} // namespace vm
+
+} // namespace itmoscript
@@ -0,0 +1,705 @@
+#include "Compiler.hpp"
+
+#include "objects/List.hpp"
+
+#include <bit>
+
+namespace itmoscript {
+
+namespace vm {
+
+namespace {
+
+/** @brief Returns the value of a number, boolean or nil literal. */
+Value GetLiteralValue(const ast::Expression& expr) {
+    if (auto* literal = dynamic_cast<const ast::IntegerLiteral*>(&expr)) {
+        return literal->value;
+    }
+
+    if (auto* literal = dynamic_cast<const ast::FloatLiteral*>(&expr)) {
+        return literal->value;
+    }
+
+    if (auto* literal = dynamic_cast<const ast::BooleanLiteral*>(&expr)) {
+        return literal->value;
+    }
+
+    return NullType{};
+}
+
+} // namespace
+
+std::shared_ptr<const CompiledFunction> Compiler::CompileProgram(ast::Program& program) {
+    auto script = std::make_shared<CompiledFunction>();
+    chunk_ = &script->chunk;
+    stack_depth_ = 0;
+    scopes_.clear();
+    inside_function_ = false;
+    loops_.clear();
+
+    SetPosition(program.token);
+    program.Accept(*this);
+    Emit(OpCode::kHalt);
+
+    chunk_ = nullptr;
+    return script;
+}
+
+std::shared_ptr<const CompiledFunction> Compiler::CompileFunction(const Function& func) {
+    return CompileFunctionBody(func.prototype());
+}
+
+std::shared_ptr<CompiledFunction> Compiler::CompileFunctionBody(const FunctionPrototype& prototype) {
+    auto function = std::make_shared<CompiledFunction>();
+    function->frame_size = prototype.frame_size;
+
+    Chunk* prev_chunk = chunk_;
+    uint32_t prev_position = position_;
+    size_t prev_stack_depth = stack_depth_;
+    std::vector<uint32_t> prev_scopes = std::move(scopes_);
+    bool prev_inside_function = inside_function_;
+    std::vector<LoopContext> prev_loops = std::move(loops_);
+
+    chunk_ = &function->chunk;
+    stack_depth_ = 0;
+    scopes_.clear();
+    inside_function_ = true;
+    loops_.clear();
+
+    SetPosition(prototype.body->token);
+
+    // the body is executed in the function scope, which already holds the parameters,
+    // its slots are destroyed together with the frame
+    CompileStatements(*prototype.body, false);
+
+    Emit(OpCode::kConstant, AddConstant(NullType{}));
+    Emit(OpCode::kReturn);
+
+    chunk_ = prev_chunk;
+    position_ = prev_position;
+    stack_depth_ = prev_stack_depth;
+    scopes_ = std::move(prev_scopes);
+    inside_function_ = prev_inside_function;
+    loops_ = std::move(prev_loops);
+
+    return function;
+}
+
+size_t Compiler::Emit(OpCode op, uint32_t operand) {
+    switch (op) {
+        case OpCode::kConstant:
+        case OpCode::kCopyConstant:
+        case OpCode::kDup:
+        case OpCode::kLoadLocal:
+        case OpCode::kLoadName:
+        case OpCode::kMakeFunction:
+        case OpCode::kIterPrepare:
+        case OpCode::kIterNext:
+            ++stack_depth_;
+            break;
+        case OpCode::kPop:
+        case OpCode::kStoreLocal:
+        case OpCode::kAssign:
+        case OpCode::kAssignCopy:
+        case OpCode::kBinaryOp:
+        case OpCode::kIndex:
+        case OpCode::kReturn:
+        case OpCode::kYield:
+        case OpCode::kJumpIfFalse:
+        case OpCode::kJumpIfTrue:
+        case OpCode::kSetResult:
+            --stack_depth_;
+            break;
+        case OpCode::kSlice:
+            stack_depth_ -= std::popcount(operand);
+            break;
+        case OpCode::kBuildList:
+            stack_depth_ = stack_depth_ - operand + 1;
+            break;
+        case OpCode::kCall:
+            stack_depth_ -= chunk_->call_sites[operand].args_count;
+            break;
+        case OpCode::kTailCall:
+            stack_depth_ -= chunk_->call_sites[operand].args_count + 1;
+            break;
+        case OpCode::kCallBuiltin:
+            stack_depth_ = stack_depth_ - chunk_->call_sites[operand].args_count + 1;
+            break;
+        default:
+            break;
+    }
+
+    chunk_->code.push_back(Instruction{.op = op, .operand = operand});
+    chunk_->positions.push_back(position_);
+    return chunk_->code.size() - 1;
+}
+
+size_t Compiler::EmitJump(OpCode op) {
+    return Emit(op, 0);
+}
+
+void Compiler::PatchJump(size_t jump) {
+    chunk_->code[jump].operand = CurrentOffset();
+}
+
+uint32_t Compiler::CurrentOffset() const {
+    return static_cast<uint32_t>(chunk_->code.size());
+}
+
+uint32_t Compiler::AddConstant(Value value) {
+    chunk_->constants.push_back(std::move(value));
+    return static_cast<uint32_t>(chunk_->constants.size() - 1);
+}
+
+uint32_t Compiler::AddName(const std::string& name) {
+    for (size_t i = 0; i < chunk_->names.size(); ++i) {
+        if (chunk_->names[i] == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    chunk_->names.push_back(name);
+    return static_cast<uint32_t>(chunk_->names.size() - 1);
+}
+
+uint32_t Compiler::AddVariable(const ast::Identifier& ident) {
+    chunk_->variables.push_back(Variable{.name = ident.name, .binding = ident.binding});
+    return static_cast<uint32_t>(chunk_->variables.size() - 1);
+}
+
+void Compiler::PushScope(uint32_t slots_begin, uint32_t slots_end) {
+    if (slots_begin == slots_end) {
+        return;
+    }
+
+    chunk_->scopes.push_back(SlotRange{.begin = slots_begin, .end = slots_end});
+    scopes_.push_back(static_cast<uint32_t>(chunk_->scopes.size() - 1));
+}
+
+void Compiler::PopScope(uint32_t slots_begin, uint32_t slots_end) {
+    if (slots_begin == slots_end) {
+        return;
+    }
+
+    Emit(OpCode::kPopScope, scopes_.back());
+    scopes_.pop_back();
+}
+
+void Compiler::SetPosition(const Token& token) {
+    chunk_->tokens.push_back(token);
+    position_ = static_cast<uint32_t>(chunk_->tokens.size() - 1);
+}
+
+void Compiler::CompileExpression(ast::Expression& expr) {
+    uint32_t prev_position = position_;
+    SetPosition(expr.token);
+    expr.Accept(*this);
+    position_ = prev_position;
+}
+
+void Compiler::CompileStatement(ast::Statement& stmt, bool keep_value) {
+    uint32_t prev_position = position_;
+    bool prev_keep_value = keep_value_;
+    size_t depth = stack_depth_;
+
+    SetPosition(stmt.token);
+    keep_value_ = keep_value;
+    stmt.Accept(*this);
+
+    // statements leaving the control flow (return, break, continue) push nothing,
+    // but the code after them is unreachable anyway
+    stack_depth_ = depth + (keep_value ? 1 : 0);
+    keep_value_ = prev_keep_value;
+    position_ = prev_position;
+}
+
+void Compiler::CompileBlock(ast::BlockStatement& block, bool keep_value) {
+    if (block.GetStatements().empty()) {
+        if (keep_value) {
+            Emit(OpCode::kConstant, AddConstant(NullType{}));
+        }
+        return;
+    }
+
+    PushScope(block.slots_begin, block.slots_end);
+    CompileStatements(block, keep_value);
+    PopScope(block.slots_begin, block.slots_end);
+}
+
+void Compiler::CompileStatements(const ast::BlockStatement& block, bool keep_value) {
+    const auto& statements = block.GetStatements();
+
+    for (size_t i = 0; i < statements.size(); ++i) {
+        CompileStatement(*statements[i], keep_value && i == statements.size() - 1);
+    }
+}
+
+void Compiler::PushStatementValue() {
+    if (keep_value_) {
+        Emit(OpCode::kConstant, AddConstant(NullType{}));
+    }
+}
+
+void Compiler::EmitLoopExit(size_t stack_depth, size_t scope_depth) {
+    size_t depth = stack_depth_;
+
+    while (stack_depth_ > stack_depth) {
+        Emit(OpCode::kPop);
+    }
+
+    for (size_t i = scopes_.size(); i > scope_depth; --i) {
+        Emit(OpCode::kPopScope, scopes_[i - 1]);
+    }
+
+    stack_depth_ = depth;
+}
+
+void Compiler::EmitClearInvariants(uint32_t invariants_begin, uint32_t invariants_end) {
+    if (invariants_begin == invariants_end) {
+        return;
+    }
+
+    chunk_->scopes.push_back(SlotRange{.begin = invariants_begin, .end = invariants_end});
+    Emit(OpCode::kPopScope, static_cast<uint32_t>(chunk_->scopes.size() - 1));
+}
+
+void Compiler::Visit(ast::Program& program) {
+    for (const auto& stmt : program.GetStatements()) {
+        CompileStatement(*stmt, true);
+        Emit(OpCode::kSetResult);
+    }
+}
+
+void Compiler::Visit(ast::ExpressionStatement& stmt) {
+    if (auto* if_expr = dynamic_cast<ast::IfExpression*>(stmt.expr.get())) {
+        uint32_t prev_position = position_;
+        SetPosition(if_expr->token);
+        CompileIf(*if_expr, keep_value_);
+        position_ = prev_position;
+        return;
+    }
+
+    CompileExpression(*stmt.expr);
+
+    if (!keep_value_) {
+        Emit(OpCode::kPop);
+    }
+}
+
+void Compiler::Visit(ast::IntegerLiteral& node) {
+    Emit(OpCode::kConstant, AddConstant(node.value));
+}
+
+void Compiler::Visit(ast::BooleanLiteral& node) {
+    Emit(OpCode::kConstant, AddConstant(node.value));
+}
+
+void Compiler::Visit(ast::NullTypeLiteral& node) {
+    Emit(OpCode::kConstant, AddConstant(NullType{}));
+}
+
+void Compiler::Visit(ast::FloatLiteral& node) {
+    Emit(OpCode::kConstant, AddConstant(node.value));
+}
+
+void Compiler::Visit(ast::StringLiteral& node) {
+    // every evaluation loads the same frozen String, it's copied only when stored (see Value::Thaw())
+    String string = CreateString(node.value);
+    string->Freeze();
+    Emit(OpCode::kConstant, AddConstant(std::move(string)));
+}
+
+void Compiler::Visit(ast::Identifier& node) {
+    if (node.binding.IsAlwaysLocal()) {
+        Emit(OpCode::kLoadLocal, node.binding.locals.back());
+    } else {
+        Emit(OpCode::kLoadName, AddVariable(node));
+    }
+}
+
+void Compiler::Visit(ast::AssignStatement& stmt) {
+    if (std_lib_.Has(stmt.ident->name)) {
+        Emit(OpCode::kStandardOverrideError, AddName(stmt.ident->name));
+        return;
+    }
+
+    CompileExpression(*stmt.expr);
+
+    if (keep_value_) {
+        Emit(OpCode::kDup);
+    }
+
+    if (dynamic_cast<ast::Identifier*>(stmt.expr.get())) {
+        Emit(OpCode::kAssign, AddVariable(*stmt.ident));
+    } else {
+        Emit(OpCode::kAssignCopy, AddVariable(*stmt.ident));
+    }
+}
+
+void Compiler::Visit(ast::OperatorAssignStatement& stmt) {
+    if (std_lib_.Has(stmt.ident->name)) {
+        Emit(OpCode::kStandardOverrideError, AddName(stmt.ident->name));
+        return;
+    }
+
+    // the right side is evaluated before the identifier is resolved
+    CompileExpression(*stmt.expr);
+    stmt.ident->Accept(*this);
+    Emit(OpCode::kSwap);
+    Emit(OpCode::kBinaryOp, static_cast<uint32_t>(kCompoundAssignOperators.at(stmt.oper)));
+
+    if (keep_value_) {
+        Emit(OpCode::kDup);
+    }
+
+    Emit(OpCode::kAssign, AddVariable(*stmt.ident));
+}
+
+bool Compiler::IsBuiltinCall(const ast::CallExpression& expr) const {
+    // a parameter or a loop variable may shadow the standard function
+    return expr.function_name
+        && std_lib_.Has(*expr.function_name)
+        && !static_cast<const ast::Identifier&>(*expr.function).binding.IsAlwaysLocal();
+}
+
+void Compiler::Visit(ast::CallExpression& expr) {
+    if (!IsBuiltinCall(expr)) {
+        CompileScriptCall(expr, OpCode::kCall);
+        return;
+    }
+
+    for (auto& arg : expr.arguments) {
+        CompileExpression(*arg);
+    }
+
+    CallSite site{
+        .function_name = *expr.function_name,
+        .callee = expr.function->String(),
+        .args_count = static_cast<uint32_t>(expr.arguments.size()),
+        .name = AddName(*expr.function_name),
+    };
+
+    if (std_lib_.HasOutStreamHandlingFunc(*expr.function_name)) {
+        site.builtin_kind = BuiltinKind::kOutStreamHandling;
+    } else if (std_lib_.HasInStreamHandlingFunc(*expr.function_name)) {
+        site.builtin_kind = BuiltinKind::kInStreamHandling;
+    } else {
+        site.builtin_kind = BuiltinKind::kValueHandling;
+    }
+
+    chunk_->call_sites.push_back(std::move(site));
+    Emit(OpCode::kCallBuiltin, static_cast<uint32_t>(chunk_->call_sites.size() - 1));
+}
+
+void Compiler::CompileScriptCall(ast::CallExpression& expr, OpCode op) {
+    for (auto& arg : expr.arguments) {
+        CompileExpression(*arg);
+    }
+
+    CompileExpression(*expr.function);
+
+    chunk_->call_sites.push_back(CallSite{
+        .function_name = expr.function_name.value_or("<anonymous function>"),
+        .callee = expr.function->String(),
+        .args_count = static_cast<uint32_t>(expr.arguments.size()),
+    });
+
+    Emit(op, static_cast<uint32_t>(chunk_->call_sites.size() - 1));
+}
+
+void Compiler::Visit(ast::InlinedCallExpression& expr) {
+    for (size_t i = 0; i < expr.arguments.size(); ++i) {
+        CompileExpression(*expr.arguments[i]);
+        Emit(OpCode::kStoreLocal, expr.slots_begin + static_cast<uint32_t>(i));
+    }
+
+    chunk_->call_sites.push_back(CallSite{
+        .function_name = expr.function_name,
+        .args_count = static_cast<uint32_t>(expr.arguments.size()),
+    });
+
+    Emit(OpCode::kEnterInline, static_cast<uint32_t>(chunk_->call_sites.size() - 1));
+    CompileExpression(*expr.body);
+    Emit(OpCode::kLeaveInline);
+
+    chunk_->scopes.push_back(SlotRange{.begin = expr.slots_begin, .end = expr.slots_end});
+    Emit(OpCode::kPopScope, static_cast<uint32_t>(chunk_->scopes.size() - 1));
+}
+
+void Compiler::Visit(ast::ReturnStatement& stmt) {
+    if (!inside_function_) {
+        Emit(
+            OpCode::kControlFlowError,
+            AddConstant(CreateString("unexpected 'return' outside of a function"))
+        );
+        return;
+    }
+
+    // the called function takes the frame of this one and returns to its caller
+    if (auto* call = dynamic_cast<ast::CallExpression*>(stmt.expr.get()); call && !IsBuiltinCall(*call)) {
+        uint32_t prev_position = position_;
+        SetPosition(call->token);
+        CompileScriptCall(*call, OpCode::kTailCall);
+        position_ = prev_position;
+        return;
+    }
+
+    if (stmt.expr != nullptr) {
+        CompileExpression(*stmt.expr);
+    } else {
+        Emit(OpCode::kConstant, AddConstant(NullType{}));
+    }
+
+    Emit(OpCode::kReturn);
+}
+
+void Compiler::Visit(ast::YieldStatement& stmt) {
+    // the parser accepts yield only inside a function
+    if (stmt.expr != nullptr) {
+        CompileExpression(*stmt.expr);
+    } else {
+        Emit(OpCode::kConstant, AddConstant(NullType{}));
+    }
+
+    Emit(OpCode::kYield);
+}
+
+void Compiler::Visit(ast::WhileStatement& stmt) {
+    EmitClearInvariants(stmt.invariants_begin, stmt.invariants_end);
+    uint32_t loop_start = CurrentOffset();
+
+    CompileExpression(*stmt.condition);
+    size_t exit_jump = EmitJump(OpCode::kJumpIfFalse);
+
+    loops_.push_back(LoopContext{
+        .stack_depth = stack_depth_,
+        .scope_depth = scopes_.size(),
+    });
+    CompileBlock(*stmt.body, false);
+
+    for (size_t jump : loops_.back().continue_jumps) {
+        chunk_->code[jump].operand = loop_start;
+    }
+
+    Emit(OpCode::kJump, loop_start);
+    PatchJump(exit_jump);
+
+    for (size_t jump : loops_.back().break_jumps) {
+        PatchJump(jump);
+    }
+
+    loops_.pop_back();
+    PushStatementValue();
+}
+
+void Compiler::Visit(ast::ForStatement& stmt) {
+    EmitClearInvariants(stmt.invariants_begin, stmt.invariants_end);
+    CompileExpression(*stmt.range);
+    Emit(OpCode::kIterPrepare);
+
+    uint32_t loop_start = CurrentOffset();
+    size_t exit_jump = EmitJump(OpCode::kIterNext);
+
+    // the iteration variable is overwritten by every iteration and cleared after the loop,
+    // the body is a nested scope cleared after every iteration
+    uint32_t iter_slot = stmt.iter->binding.locals.back();
+    PushScope(iter_slot, iter_slot + 1);
+    Emit(OpCode::kStoreLocal, iter_slot);
+
+    loops_.push_back(LoopContext{
+        .stack_depth = stack_depth_,
+        .scope_depth = scopes_.size(),
+    });
+    CompileBlock(*stmt.body, false);
+
+    for (size_t jump : loops_.back().continue_jumps) {
+        chunk_->code[jump].operand = loop_start;
+    }
+
+    Emit(OpCode::kJump, loop_start);
+    PatchJump(exit_jump);
+
+    for (size_t jump : loops_.back().break_jumps) {
+        PatchJump(jump);
+    }
+
+    loops_.pop_back();
+
+    PopScope(iter_slot, iter_slot + 1);
+    Emit(OpCode::kPop);
+    Emit(OpCode::kPop);
+    PushStatementValue();
+}
+
+void Compiler::Visit(ast::BreakStatement& stmt) {
+    if (loops_.empty()) {
+        Emit(
+            OpCode::kControlFlowError,
+            AddConstant(CreateString("unexpected 'break' outside of a loop"))
+        );
+        return;
+    }
+
+    LoopContext& loop = loops_.back();
+    EmitLoopExit(loop.stack_depth, loop.scope_depth);
+    loop.break_jumps.push_back(EmitJump(OpCode::kJump));
+}
+
+void Compiler::Visit(ast::ContinueStatement& stmt) {
+    if (loops_.empty()) {
+        Emit(
+            OpCode::kControlFlowError,
+            AddConstant(CreateString("unexpected 'continue' outside of a loop"))
+        );
+        return;
+    }
+
+    LoopContext& loop = loops_.back();
+    EmitLoopExit(loop.stack_depth, loop.scope_depth);
+    loop.continue_jumps.push_back(EmitJump(OpCode::kJump));
+}
+
+void Compiler::Visit(ast::ListLiteral& list_literal) {
+    if (list_literal.HasConstantElements()) {
+        std::vector<Value> elements;
+        elements.reserve(list_literal.elements.size());
+
+        for (const auto& expr : list_literal.elements) {
+            elements.push_back(GetLiteralValue(*expr));
+        }
+
+        // the copy shares the elements with the constant until the first write
+        Emit(OpCode::kCopyConstant, AddConstant(CreateList(std::move(elements))));
+        return;
+    }
+
+    for (auto& expr : list_literal.elements) {
+        CompileExpression(*expr);
+    }
+
+    Emit(OpCode::kBuildList, static_cast<uint32_t>(list_literal.elements.size()));
+}
+
+void Compiler::Visit(ast::FunctionLiteral& func) {
+    const std::shared_ptr<const FunctionPrototype>& prototype = FunctionPrototype::Of(func);
+
+    if (prototype->compiled == nullptr) {
+        prototype->compiled = CompileFunctionBody(*prototype);
+    }
+
+    chunk_->functions.push_back(prototype);
+    Emit(OpCode::kMakeFunction, static_cast<uint32_t>(chunk_->functions.size() - 1));
+}
+
+void Compiler::Visit(ast::IfExpression& expr) {
+    CompileIf(expr, true);
+}
+
+void Compiler::CompileIf(ast::IfExpression& expr, bool keep_value) {
+    std::vector<size_t> end_jumps;
+    size_t depth = stack_depth_;
+    bool has_else = false;
+
+    for (const auto& alternative : expr.alternatives) {
+        if (alternative.condition == nullptr) { // else-branch, guaranteed to be last
+            CompileBlock(*alternative.consequence, keep_value);
+            stack_depth_ = depth + (keep_value ? 1 : 0);
+            has_else = true;
+            break;
+        }
+
+        CompileExpression(*alternative.condition);
+        size_t next_jump = EmitJump(OpCode::kJumpIfFalse);
+
+        CompileBlock(*alternative.consequence, keep_value);
+        end_jumps.push_back(EmitJump(OpCode::kJump));
+        stack_depth_ = depth;
+
+        PatchJump(next_jump);
+    }
+
+    if (!has_else && keep_value) {
+        Emit(OpCode::kConstant, AddConstant(NullType{}));
+    }
+
+    for (size_t jump : end_jumps) {
+        PatchJump(jump);
+    }
+
+    stack_depth_ = depth + (keep_value ? 1 : 0);
+}
+
+void Compiler::Visit(ast::BlockStatement& block) {
+    CompileBlock(block, keep_value_);
+}
+
+void Compiler::Visit(ast::PrefixExpression& node) {
+    CompileExpression(*node.right);
+    Emit(OpCode::kUnaryOp, static_cast<uint32_t>(node.oper));
+}
+
+void Compiler::Visit(ast::InfixExpression& node) {
+    CompileExpression(*node.left);
+    CompileExpression(*node.right);
+    Emit(OpCode::kBinaryOp, static_cast<uint32_t>(node.oper));
+}
+
+void Compiler::Visit(ast::LogicalExpression& node) {
+    // false decides `and`, true decides `or`
+    bool is_and = node.oper == TokenType::kAnd;
+    OpCode decided_jump = is_and ? OpCode::kJumpIfFalse : OpCode::kJumpIfTrue;
+    size_t depth = stack_depth_;
+
+    CompileExpression(*node.left);
+    size_t left_jump = EmitJump(decided_jump);
+    CompileExpression(*node.right);
+    size_t right_jump = EmitJump(decided_jump);
+
+    Emit(OpCode::kConstant, AddConstant(is_and));
+    size_t end_jump = EmitJump(OpCode::kJump);
+    stack_depth_ = depth;
+
+    PatchJump(left_jump);
+    PatchJump(right_jump);
+    Emit(OpCode::kConstant, AddConstant(!is_and));
+    PatchJump(end_jump);
+}
+
+void Compiler::Visit(ast::InvariantExpression& expr) {
+    chunk_->invariants.push_back(InvariantSite{.slot = expr.slot, .inputs = expr.inputs});
+    uint32_t site = static_cast<uint32_t>(chunk_->invariants.size() - 1);
+
+    Emit(OpCode::kLoadInvariant, site);
+    CompileExpression(*expr.expr);
+    Emit(OpCode::kStoreInvariant, site);
+
+    chunk_->invariants[site].end = CurrentOffset();
+}
+
+void Compiler::Visit(ast::IndexOperatorExpression& expr) {
+    CompileExpression(*expr.operand);
+
+    if (!expr.is_slice) {
+        CompileExpression(*expr.index);
+        Emit(OpCode::kIndex);
+        return;
+    }
+
+    uint32_t flags = 0;
+
+    if (expr.index != nullptr) {
+        CompileExpression(*expr.index);
+        flags |= kSliceHasStart;
+    }
+
+    if (expr.second_index != nullptr) {
+        CompileExpression(*expr.second_index);
+        flags |= kSliceHasEnd;
+    }
+
+    Emit(OpCode::kSlice, flags);
+}
+
+} // namespace vm
+
+} // namespace itmoscript
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Chunk.hpp"
+
+#include "ast/AST.hpp"
+#include "ast/AstVisitor.hpp"
+#include "objects/Function.hpp"
+#include "stdlib/StdLib.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace itmoscript {
+
+namespace vm {
+
+/**
+ * @class Compiler
+ * @brief Translates the AST into bytecode for the VirtualMachine.
+ *
+ * @details Implements the AstVisitor interface. Every expression leaves exactly one value
+ * on the stack, statements leave nothing unless their value is requested (the last statement
+ * of a block used as an if-expression, or a top-level statement whose value becomes
+ * the last evaluated value).
+ *
+ * The compiler mirrors the scoping rules of the Evaluator. The slots of identifiers are
+ * assigned by the Resolver beforehand: identifiers which always refer to a single local slot
+ * are accessed directly, leaving a scope clears its slots.
+ */
+class Compiler : public ast::AstVisitor {
+public:
+    /**
+     * @brief Constructs the compiler.
+     * @param std_lib Standard library the code will be executed with. Used to tell
+     * calls of the standard functions apart from the user-defined ones.
+     */
+    explicit Compiler(const stdlib::StdLib& std_lib)
+        : std_lib_(std_lib) {}
+
+    Compiler(const Compiler&) = delete;
+    Compiler(Compiler&&) = delete;
+    Compiler& operator=(const Compiler&) = delete;
+    Compiler& operator=(Compiler&&) = delete;
+    ~Compiler() = default;
+
+    /**
+     * @brief Compiles the whole program into a top-level function.
+     * The value of every top-level statement is stored as the last evaluated value.
+     */
+    std::shared_ptr<const CompiledFunction> CompileProgram(ast::Program& program);
+
+    /**
+     * @brief Compiles the body of the function into a standalone function.
+     * Used for Function objects created by the tree-walking Evaluator.
+     */
+    std::shared_ptr<const CompiledFunction> CompileFunction(const Function& func);
+
+private:
+    /**
+     * @brief State of the loop being compiled, used to patch break and continue jumps.
+     * Depths are used to clean up the scopes and the stack when jumping out of the body.
+     */
+    struct LoopContext {
+        size_t stack_depth;
+        size_t scope_depth;
+        std::vector<size_t> break_jumps;
+        std::vector<size_t> continue_jumps;
+    };
+
+    const stdlib::StdLib& std_lib_;
+
+    Chunk* chunk_ = nullptr;
+    uint32_t position_ = 0;
+
+    size_t stack_depth_ = 0;
+
+    /** @brief Indices in Chunk::scopes of the open scopes having local slots. */
+    std::vector<uint32_t> scopes_;
+    bool keep_value_ = false;
+    bool inside_function_ = false;
+
+    std::vector<LoopContext> loops_;
+
+    /** @brief Appends the instruction at the current position. @return Its index. */
+    size_t Emit(OpCode op, uint32_t operand = 0);
+
+    /** @brief Emits a jump with an unknown target. @return Index of the jump to patch later. */
+    size_t EmitJump(OpCode op);
+
+    /** @brief Sets the target of the jump to the next emitted instruction. */
+    void PatchJump(size_t jump);
+
+    /** @brief Returns the index of the next emitted instruction. */
+    uint32_t CurrentOffset() const;
+
+    uint32_t AddConstant(Value value);
+    uint32_t AddName(const std::string& name);
+    uint32_t AddVariable(const ast::Identifier& ident);
+
+    /** @brief Opens a scope with the given local slots, if there are any. */
+    void PushScope(uint32_t slots_begin, uint32_t slots_end);
+
+    /** @brief Closes the scope opened by PushScope(), clearing its slots. */
+    void PopScope(uint32_t slots_begin, uint32_t slots_end);
+
+    /** @brief Stores the token of the node and makes it the position of emitted instructions. */
+    void SetPosition(const Token& token);
+
+    /** @brief Compiles the expression. Exactly one value is left on the stack. */
+    void CompileExpression(ast::Expression& expr);
+
+    /**
+     * @brief Compiles the statement.
+     * @param keep_value If true, the value of the statement is left on the stack.
+     */
+    void CompileStatement(ast::Statement& stmt, bool keep_value);
+
+    /** @brief Compiles the block in its own scope. */
+    void CompileBlock(ast::BlockStatement& block, bool keep_value);
+
+    /** @brief Compiles statements of the block in the current scope. */
+    void CompileStatements(const ast::BlockStatement& block, bool keep_value);
+
+    void CompileIf(ast::IfExpression& expr, bool keep_value);
+
+    /** @brief Checks if the call is made directly to a standard function. */
+    bool IsBuiltinCall(const ast::CallExpression& expr) const;
+
+    /**
+     * @brief Compiles the call of a script function.
+     * @param op kCall, or kTailCall for `return f(...)`, which leaves no value.
+     */
+    void CompileScriptCall(ast::CallExpression& expr, OpCode op);
+
+    /** @brief Emits the pushing of the value of the statement, if it was requested. */
+    void PushStatementValue();
+
+    /** @brief Emits the clearing of the slots of the values hoisted from the loop, if it has any. */
+    void EmitClearInvariants(uint32_t invariants_begin, uint32_t invariants_end);
+
+    /** @brief Emits cleanup of stack values and scopes down to the given depths. */
+    void EmitLoopExit(size_t stack_depth, size_t scope_depth);
+
+    std::shared_ptr<CompiledFunction> CompileFunctionBody(const FunctionPrototype& prototype);
+
+    // Visitor implementation
+
+    void Visit(ast::Program&) override;
+    void Visit(ast::ExpressionStatement&) override;
+    void Visit(ast::PrefixExpression&) override;
+    void Visit(ast::InfixExpression&) override;
+    void Visit(ast::LogicalExpression&) override;
+    void Visit(ast::InvariantExpression&) override;
+    void Visit(ast::IndexOperatorExpression&) override;
+
+    void Visit(ast::Identifier&) override;
+    void Visit(ast::IntegerLiteral&) override;
+    void Visit(ast::BooleanLiteral&) override;
+    void Visit(ast::NullTypeLiteral&) override;
+    void Visit(ast::FloatLiteral&) override;
+    void Visit(ast::StringLiteral&) override;
+    void Visit(ast::FunctionLiteral&) override;
+    void Visit(ast::ListLiteral&) override;
+
+    void Visit(ast::IfExpression&) override;
+    void Visit(ast::BlockStatement&) override;
+    void Visit(ast::AssignStatement&) override;
+    void Visit(ast::OperatorAssignStatement&) override;
+    void Visit(ast::CallExpression&) override;
+    void Visit(ast::InlinedCallExpression&) override;
+    void Visit(ast::ReturnStatement&) override;
+    void Visit(ast::YieldStatement&) override;
+
+    void Visit(ast::WhileStatement&) override;
+    void Visit(ast::ForStatement&) override;
+    void Visit(ast::BreakStatement&) override;
+    void Visit(ast::ContinueStatement&) override;
+};
+
+} // namespace vm
+
+} // namespace itmoscript
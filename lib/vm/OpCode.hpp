@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace itmoscript {
+
+namespace vm {
+
+/**
+ * @enum OpCode
+ * @brief Instructions of the stack virtual machine.
+ *
+ * Every instruction has a single 32-bit operand. Its meaning depends on the opcode
+ * and is described next to each of them. Stack effects are given as (before -- after).
+ */
+enum class OpCode : uint8_t {
+    kConstant,      // push constants[operand]                        ( -- value)
+    kCopyConstant,  // push a fresh copy of constants[operand]        ( -- list)
+    kPop,           //                                                (value -- )
+    kDup,           //                                                (value -- value value)
+    kSwap,          //                                                (a b -- b a)
+
+    kLoadLocal,     // push the local slot operand, which is always defined ( -- value)
+    kStoreLocal,    // set the local slot operand                     (value -- )
+    kLoadName,      // push the value of variables[operand]           ( -- value)
+    kAssign,        // assign variables[operand] (AssignIdentifier)   (value -- )
+    kAssignCopy,    // assign variables[operand] with deep copy semantics (value -- )
+
+    kPopScope,      // leave a block scope, clearing the local slots scopes[operand]
+
+    kLoadInvariant,  // push the value kept by invariants[operand] and jump to its end, if any ( -- [value])
+    kStoreInvariant, // keep the value in invariants[operand] if it's allowed (value -- value)
+
+    kUnaryOp,       // operand is a TokenType                         (right -- result)
+    kBinaryOp,      // operand is a TokenType                         (left right -- result)
+    kIndex,         //                                                (operand index -- value)
+    kSlice,         // operand is a combination of kSliceHas* flags   (operand [start] [end] -- value)
+    kBuildList,     // operand is the number of elements              (elements... -- list)
+    kMakeFunction,  // create a Function from functions[operand]      ( -- function)
+
+    kCall,          // call_sites[operand] describes the call         (args... function -- result)
+    kCallBuiltin,   // call_sites[operand] names a standard function  (args... -- result)
+    kTailCall,      // call_sites[operand] in place of the current function (args... function -- )
+    kReturn,        // leave the current function                     (result -- )
+    kYield,         // suspend the current generator                  (value -- )
+    kEnterInline,   // push the frame of call_sites[operand] to the call stack, the code of the call follows
+    kLeaveInline,   // pop the frame pushed by kEnterInline
+
+    kJump,          // jump to operand
+    kJumpIfFalse,   // jump to operand if the value is not truthy     (value -- )
+    kJumpIfTrue,    // jump to operand if the value is truthy         (value -- )
+
+    kIterPrepare,   // check that the range is iterable               (range -- range index)
+    kIterNext,      // push the next element or jump to operand       (range index -- range index [element])
+
+    kSetResult,     // store the value as the last evaluated value    (value -- )
+
+    kControlFlowError,       // throw ControlFlowError with message constants[operand]
+    kStandardOverrideError,  // throw StandardOverrideError for names[operand]
+
+    kHalt,
+};
+
+/** @brief Flags of the kSlice operand, telling which bounds are on the stack. */
+inline constexpr uint32_t kSliceHasStart = 1;
+inline constexpr uint32_t kSliceHasEnd = 2;
+
+/** @brief Maps opcodes to their human-readable names. Used by the disassembler. */
+inline const std::map<OpCode, std::string> kOpCodeNames = {
+    {OpCode::kConstant, "CONSTANT"},
+    {OpCode::kCopyConstant, "COPY_CONSTANT"},
+    {OpCode::kPop, "POP"},
+    {OpCode::kDup, "DUP"},
+    {OpCode::kSwap, "SWAP"},
+    {OpCode::kLoadLocal, "LOAD_LOCAL"},
+    {OpCode::kStoreLocal, "STORE_LOCAL"},
+    {OpCode::kLoadName, "LOAD_NAME"},
+    {OpCode::kAssign, "ASSIGN"},
+    {OpCode::kAssignCopy, "ASSIGN_COPY"},
+    {OpCode::kPopScope, "POP_SCOPE"},
+    {OpCode::kLoadInvariant, "LOAD_INVARIANT"},
+    {OpCode::kStoreInvariant, "STORE_INVARIANT"},
+    {OpCode::kUnaryOp, "UNARY_OP"},
+    {OpCode::kBinaryOp, "BINARY_OP"},
+    {OpCode::kIndex, "INDEX"},
+    {OpCode::kSlice, "SLICE"},
+    {OpCode::kBuildList, "BUILD_LIST"},
+    {OpCode::kMakeFunction, "MAKE_FUNCTION"},
+    {OpCode::kCall, "CALL"},
+    {OpCode::kCallBuiltin, "CALL_BUILTIN"},
+    {OpCode::kTailCall, "TAIL_CALL"},
+    {OpCode::kReturn, "RETURN"},
+    {OpCode::kYield, "YIELD"},
+    {OpCode::kEnterInline, "ENTER_INLINE"},
+    {OpCode::kLeaveInline, "LEAVE_INLINE"},
+    {OpCode::kJump, "JUMP"},
+    {OpCode::kJumpIfFalse, "JUMP_IF_FALSE"},
+    {OpCode::kJumpIfTrue, "JUMP_IF_TRUE"},
+    {OpCode::kIterPrepare, "ITER_PREPARE"},
+    {OpCode::kIterNext, "ITER_NEXT"},
+    {OpCode::kSetResult, "SET_RESULT"},
+    {OpCode::kControlFlowError, "CONTROL_FLOW_ERROR"},
+    {OpCode::kStandardOverrideError, "STANDARD_OVERRIDE_ERROR"},
+    {OpCode::kHalt, "HALT"},
+};
+
+} // namespace vm
+
+} // namespace itmoscript
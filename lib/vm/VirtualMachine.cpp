@@ -0,0 +1,589 @@
+#include "VirtualMachine.hpp"
+
+#include "objects/List.hpp"
+#include "objects/Iteration.hpp"
+
+#include "evaluation/exceptions/OperatorTypeError.hpp"
+#include "evaluation/exceptions/ParametersCountError.hpp"
+#include "evaluation/exceptions/ControlFlowError.hpp"
+#include "evaluation/exceptions/UnsupportedTypeError.hpp"
+#include "evaluation/exceptions/UncallableObjectCallError.hpp"
+#include "evaluation/exceptions/StandardOverrideError.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace itmoscript {
+
+namespace vm {
+
+void VirtualMachine::Evaluate(ast::Program& root, std::istream& input, std::ostream& output) {
+    OutputSink::Scope output_scope{evaluator_.output_sink_, input, output};
+    evaluator_.input_ = &input;
+    evaluator_.output_ = &output_scope.stream();
+    evaluator_.call_stack_.clear();
+    evaluator_.PrepareProgram(root);
+
+    // the script is kept until the next evaluation, as the current token points to its tokens
+    script_ = compiler_.CompileProgram(root);
+
+    stack_.clear();
+    frames_.clear();
+    frames_.push_back(Frame{.function = script_, .env_depth = evaluator_.env_stack_.size()});
+
+    evaluator_.last_exec_result_.value = NullType{};
+    evaluator_.last_exec_result_.control = Evaluator::ControlFlowState::kNormal;
+
+    Run();
+    frames_.clear();
+}
+
+Value VirtualMachine::Pop() {
+    Value value = std::move(stack_.back());
+    stack_.pop_back();
+    return value;
+}
+
+void VirtualMachine::Run(size_t depth) {
+    while (true) {
+        Frame& frame = frames_.back();
+        const Chunk& chunk = frame.function->chunk;
+        const Instruction instr = chunk.code[frame.ip];
+
+        evaluator_.current_token_ = &chunk.tokens[chunk.positions[frame.ip]];
+        ++frame.ip;
+
+        switch (instr.op) {
+            case OpCode::kConstant:
+                stack_.push_back(chunk.constants[instr.operand]);
+                break;
+
+            case OpCode::kCopyConstant:
+                stack_.push_back(chunk.constants[instr.operand].GetCopy());
+                break;
+
+            case OpCode::kPop:
+                stack_.pop_back();
+                break;
+
+            case OpCode::kDup:
+                stack_.push_back(stack_.back());
+                break;
+
+            case OpCode::kSwap:
+                std::swap(stack_[stack_.size() - 1], stack_[stack_.size() - 2]);
+                break;
+
+            case OpCode::kLoadLocal:
+                stack_.push_back(evaluator_.env().Get(instr.operand));
+                break;
+
+            case OpCode::kStoreLocal: {
+                Value value = Pop();
+                value.Thaw();
+                evaluator_.env().Set(instr.operand, std::move(value));
+                break;
+            }
+
+            case OpCode::kLoadName: {
+                const Variable& var = chunk.variables[instr.operand];
+                stack_.push_back(evaluator_.ResolveIdentifier(var.name, var.binding, *evaluator_.current_token_));
+                break;
+            }
+
+            case OpCode::kAssign: {
+                const Variable& var = chunk.variables[instr.operand];
+                evaluator_.AssignIdentifier(var.name, var.binding, Pop());
+                break;
+            }
+
+            case OpCode::kAssignCopy: {
+                const Variable& var = chunk.variables[instr.operand];
+                evaluator_.AssignIdentifierWithCopy(var.name, var.binding, Pop());
+                break;
+            }
+
+            case OpCode::kPopScope:
+                evaluator_.env().Clear(chunk.scopes[instr.operand].begin, chunk.scopes[instr.operand].end);
+                break;
+
+            case OpCode::kLoadInvariant: {
+                const InvariantSite& site = chunk.invariants[instr.operand];
+
+                if (const Value* kept = evaluator_.env().Find(site.slot)) {
+                    stack_.push_back(*kept);
+                    frame.ip = site.end;
+                }
+
+                break;
+            }
+
+            case OpCode::kStoreInvariant: {
+                const InvariantSite& site = chunk.invariants[instr.operand];
+
+                if (evaluator_.CanKeepInvariant(stack_.back(), site.inputs)) {
+                    evaluator_.env().Set(site.slot, stack_.back());
+                }
+
+                break;
+            }
+
+            case OpCode::kUnaryOp: {
+                TokenType oper = static_cast<TokenType>(instr.operand);
+
+                if (auto result = evaluator_.HandleUnaryOper(oper, stack_.back())) {
+                    stack_.back() = std::move(*result);
+                } else {
+                    evaluator_.ThrowRuntimeError<lang_exceptions::OperatorTypeError>(
+                        kTokenTypeNames.at(oper),
+                        stack_.back().GetType()
+                    );
+                }
+
+                break;
+            }
+
+            case OpCode::kBinaryOp: {
+                TokenType oper = static_cast<TokenType>(instr.operand);
+                Value right = Pop();
+
+                if (auto result = evaluator_.HandleBinaryOper(oper, stack_.back(), right)) {
+                    stack_.back() = std::move(*result);
+                } else {
+                    evaluator_.ThrowRuntimeError<lang_exceptions::OperatorTypeError>(
+                        kTokenTypeNames.at(oper),
+                        stack_.back().GetType(),
+                        right.GetType()
+                    );
+                }
+
+                break;
+            }
+
+            case OpCode::kIndex: {
+                Value index = Pop();
+                stack_.back() = evaluator_.GetByIndex(stack_.back(), index);
+                break;
+            }
+
+            case OpCode::kSlice: {
+                Value end_bound = (instr.operand & kSliceHasEnd) ? Pop() : Value{};
+                Value start_bound = (instr.operand & kSliceHasStart) ? Pop() : Value{};
+
+                evaluator_.CheckIndexOperandType(stack_.back());
+
+                size_t start = 0;
+                size_t end = std::numeric_limits<size_t>::max();
+
+                if (instr.operand & kSliceHasStart) {
+                    start = evaluator_.GetSliceBound(start_bound);
+                }
+
+                if (instr.operand & kSliceHasEnd) {
+                    end = evaluator_.GetSliceBound(end_bound);
+                }
+
+                stack_.back() = evaluator_.GetSlice(stack_.back(), start, end);
+                break;
+            }
+
+            case OpCode::kBuildList: {
+                std::vector<Value> elements(
+                    std::make_move_iterator(stack_.end() - instr.operand),
+                    std::make_move_iterator(stack_.end())
+                );
+
+                for (Value& element : elements) {
+                    element.Thaw();
+                }
+
+                stack_.resize(stack_.size() - instr.operand);
+                stack_.push_back(CreateList(std::move(elements)));
+                break;
+            }
+
+            case OpCode::kMakeFunction: {
+                stack_.push_back(Function{chunk.functions[instr.operand]});
+                break;
+            }
+
+            case OpCode::kCall:
+                CallValue(chunk.call_sites[instr.operand], Pop());
+                break;
+
+            case OpCode::kCallBuiltin:
+                CallBuiltin(chunk, chunk.call_sites[instr.operand]);
+                break;
+
+            case OpCode::kTailCall:
+                TailCallValue(chunk.call_sites[instr.operand], Pop());
+
+                if (frames_.size() == depth) {
+                    return;
+                }
+
+                break;
+
+            case OpCode::kReturn:
+                Return(Pop());
+
+                if (frames_.size() == depth) {
+                    return;
+                }
+
+                break;
+
+            case OpCode::kYield:
+                Yield(Pop());
+
+                if (frames_.size() == depth) {
+                    return;
+                }
+
+                break;
+
+            case OpCode::kEnterInline:
+                evaluator_.call_stack_.push_back(CallFrame{
+                    .function_name = &chunk.call_sites[instr.operand].function_name,
+                    .entry_token = evaluator_.current_token_,
+                });
+                break;
+
+            case OpCode::kLeaveInline:
+                evaluator_.call_stack_.pop_back();
+                break;
+
+            case OpCode::kJump:
+                frame.ip = instr.operand;
+                break;
+
+            case OpCode::kJumpIfFalse:
+                if (!Pop().IsTruphy()) {
+                    frame.ip = instr.operand;
+                }
+                break;
+
+            case OpCode::kJumpIfTrue:
+                if (Pop().IsTruphy()) {
+                    frame.ip = instr.operand;
+                }
+                break;
+
+            case OpCode::kIterPrepare:
+                if (!IsIterable(stack_.back())) {
+                    evaluator_.ThrowRuntimeError<lang_exceptions::UnsupportedTypeError>(
+                        "range in the for loop is not of type List, String or Generator"
+                    );
+                }
+
+                stack_.push_back(Int{0});
+                break;
+
+            case OpCode::kIterNext: {
+                Int index = stack_.back().Get<Int>();
+                std::optional<Value> element = GetIterElement(stack_[stack_.size() - 2], index);
+
+                // resuming a generator pushes frames, so the reference may be invalid
+                if (!element.has_value()) {
+                    frames_.back().ip = instr.operand;
+                    break;
+                }
+
+                stack_.back() = index + 1;
+                stack_.push_back(std::move(*element));
+                break;
+            }
+
+            case OpCode::kSetResult:
+                evaluator_.last_exec_result_.value = Pop();
+                break;
+
+            case OpCode::kControlFlowError:
+                evaluator_.ThrowRuntimeError<lang_exceptions::ControlFlowError>(
+                    *chunk.constants[instr.operand].Get<String>()
+                );
+                break;
+
+            case OpCode::kStandardOverrideError:
+                evaluator_.ThrowRuntimeError<lang_exceptions::StandardOverrideError>(
+                    chunk.names[instr.operand]
+                );
+                break;
+
+            case OpCode::kHalt:
+                return;
+        }
+    }
+}
+
+const Function& VirtualMachine::PrepareCallee(const CallSite& site, const Value& callee) {
+    if (callee.GetType() != ValueType::kFunction) {
+        evaluator_.ThrowRuntimeError<lang_exceptions::UncallableObjectCallError>(site.callee);
+    }
+
+    const Function& func = callee.Get<Function>();
+
+    if (site.args_count != func.parameters().size()) {
+        evaluator_.ThrowRuntimeError<lang_exceptions::ParametersCountError>(
+            site.function_name,
+            func.parameters().size(),
+            site.args_count
+        );
+    }
+
+    if (func.compiled() == nullptr) {
+        func.set_compiled(compiler_.CompileFunction(func));
+    }
+
+    return func;
+}
+
+void VirtualMachine::CallValue(const CallSite& site, const Value& callee) {
+    const Function& func = PrepareCallee(site, callee);
+
+    if (func.is_generator()) {
+        Value generator = MakeGenerator(site, func);
+        stack_.push_back(std::move(generator));
+        return;
+    }
+
+    size_t args_begin = stack_.size() - site.args_count;
+    std::vector<PendingMemo> pending_memos;
+
+    if (func.memo() != nullptr) {
+        auto args = std::span{stack_}.subspan(args_begin);
+
+        if (std::optional<Value> result = evaluator_.FindMemoized(func, args, pending_memos)) {
+            stack_.resize(args_begin);
+            stack_.push_back(std::move(*result));
+            return;
+        }
+    }
+
+    evaluator_.CheckCallDepth();
+    size_t env_depth = evaluator_.env_stack_.size();
+
+    evaluator_.call_stack_.push_back(CallFrame{
+        .function_name = &site.function_name,
+        .entry_token = evaluator_.current_token_,
+    });
+
+    // parameters occupy the first slots of the frame
+    Environment& frame = evaluator_.env_stack_.Push(func.frame_size());
+
+    for (size_t i = 0; i < site.args_count; ++i) {
+        stack_[args_begin + i].Thaw();
+        frame.Set(static_cast<uint32_t>(i), std::move(stack_[args_begin + i]));
+    }
+
+    stack_.resize(args_begin);
+
+    frames_.push_back(Frame{
+        .function = func.compiled(),
+        .stack_base = args_begin,
+        .env_depth = env_depth,
+        .pending_memos = std::move(pending_memos),
+    });
+}
+
+void VirtualMachine::TailCallValue(const CallSite& site, const Value& callee) {
+    const Function& func = PrepareCallee(site, callee);
+
+    if (func.is_generator()) {
+        Return(MakeGenerator(site, func));
+        return;
+    }
+
+    Frame& frame = frames_.back();
+    size_t args_begin = stack_.size() - site.args_count;
+
+    if (func.memo() != nullptr) {
+        auto args = std::span{stack_}.subspan(args_begin);
+
+        if (std::optional<Value> result = evaluator_.FindMemoized(func, args, frame.pending_memos)) {
+            Return(std::move(*result));
+            return;
+        }
+    }
+
+    // the site and the entry token of the call stay in the code of the calling function
+    frame.tail_caller = std::move(frame.function);
+    evaluator_.call_stack_.back() = CallFrame{
+        .function_name = &site.function_name,
+        .entry_token = evaluator_.current_token_,
+    };
+
+    evaluator_.env_stack_.Truncate(frame.env_depth);
+    Environment& env = evaluator_.env_stack_.Push(func.frame_size());
+
+    for (size_t i = 0; i < site.args_count; ++i) {
+        stack_[args_begin + i].Thaw();
+        env.Set(static_cast<uint32_t>(i), std::move(stack_[args_begin + i]));
+    }
+
+    stack_.resize(frame.stack_base);
+    frame.function = func.compiled();
+    frame.ip = 0;
+}
+
+void VirtualMachine::CallBuiltin(const Chunk& chunk, const CallSite& site) {
+    const std::string& name = chunk.names[site.name];
+
+    ArgumentPool::Lease args = evaluator_.arguments_->Acquire();
+    args->assign(
+        std::make_move_iterator(stack_.end() - site.args_count),
+        std::make_move_iterator(stack_.end())
+    );
+
+    stack_.resize(stack_.size() - site.args_count);
+
+    const Token& token = *evaluator_.current_token_;
+    const CallStack& call_stack = evaluator_.call_stack_;
+    stdlib::StdLib& std_lib = evaluator_.std_lib_;
+
+    switch (site.builtin_kind) {
+        case BuiltinKind::kOutStreamHandling:
+            stack_.push_back(std_lib.CallOutStreamHandlingFunc(*evaluator_.output_, name, *args, token, call_stack));
+            break;
+        case BuiltinKind::kInStreamHandling:
+            stack_.push_back(std_lib.CallInStreamHandlingFunc(*evaluator_.input_, name, *args, token, call_stack));
+            break;
+        case BuiltinKind::kValueHandling:
+            stack_.push_back(std_lib.Call(name, *args, token, call_stack));
+            break;
+    }
+}
+
+void VirtualMachine::Return(Value result) {
+    Frame& frame = frames_.back();
+
+    if (!frame.pending_memos.empty()) {
+        Evaluator::StoreMemoized(frame.pending_memos, result);
+    }
+
+    stack_.resize(frame.stack_base);
+    evaluator_.env_stack_.Truncate(frame.env_depth);
+    evaluator_.call_stack_.pop_back();
+
+    // the consumer gets no value from the finished generator
+    if (frame.generator != nullptr) {
+        frame.generator->finished_ = true;
+        frames_.pop_back();
+        return;
+    }
+
+    frames_.pop_back();
+    stack_.push_back(std::move(result));
+}
+
+Value VirtualMachine::MakeGenerator(const CallSite& site, const Function& func) {
+    size_t args_begin = stack_.size() - site.args_count;
+    Environment env{func.frame_size()};
+
+    for (size_t i = 0; i < site.args_count; ++i) {
+        stack_[args_begin + i].Thaw();
+        env.Set(static_cast<uint32_t>(i), std::move(stack_[args_begin + i]));
+    }
+
+    stack_.resize(args_begin);
+    return Generator{new BytecodeGenerator(*this, site.function_name, func, std::move(env))};
+}
+
+void VirtualMachine::Yield(Value value) {
+    Frame& frame = frames_.back();
+    BytecodeGenerator& generator = *frame.generator;
+
+    generator.ip_ = frame.ip;
+    generator.stack_.assign(
+        std::make_move_iterator(stack_.begin() + static_cast<std::ptrdiff_t>(frame.stack_base)),
+        std::make_move_iterator(stack_.end())
+    );
+
+    stack_.resize(frame.stack_base);
+
+    // the frame keeps its storage on the stack for reuse, the values are swapped out
+    std::swap(evaluator_.env_stack_.top(), generator.env_);
+    evaluator_.env_stack_.Pop();
+    evaluator_.call_stack_.pop_back();
+
+    value.Thaw();
+    generator.yielded_ = std::move(value);
+    frames_.pop_back();
+}
+
+std::optional<Value> VirtualMachine::BytecodeGenerator::Next() {
+    if (finished_) {
+        return std::nullopt;
+    }
+
+    Evaluator& evaluator = machine_.evaluator_;
+
+    if (running_) {
+        evaluator.ThrowRuntimeError<lang_exceptions::ControlFlowError>("generator is already running");
+    }
+
+    evaluator.CheckCallDepth();
+
+    // the body may drop the last handle to the generator
+    Generator self{this};
+
+    const Token* token = evaluator.current_token_;
+    size_t depth = machine_.frames_.size();
+    size_t env_depth = evaluator.env_stack_.size();
+    size_t stack_base = machine_.stack_.size();
+
+    evaluator.call_stack_.push_back(CallFrame{.function_name = &name_, .entry_token = token});
+    std::swap(evaluator.env_stack_.Push(0), env_);
+
+    machine_.stack_.insert(
+        machine_.stack_.end(),
+        std::make_move_iterator(stack_.begin()),
+        std::make_move_iterator(stack_.end())
+    );
+    stack_.clear();
+
+    machine_.frames_.push_back(Frame{
+        .function = function_,
+        .ip = ip_,
+        .stack_base = stack_base,
+        .env_depth = env_depth,
+        .generator = this,
+    });
+
+    running_ = true;
+
+    try {
+        machine_.Run(depth);
+    } catch (...) {
+        running_ = false;
+        finished_ = true;
+        throw;
+    }
+
+    running_ = false;
+    evaluator.current_token_ = token;
+    return std::exchange(yielded_, std::nullopt);
+}
+
+void VirtualMachine::BytecodeGenerator::ForEachValue(const std::function<void(const Value&)>& func) const {
+    for (const Value& value : stack_) {
+        func(value);
+    }
+
+    env_.ForEachValue(func);
+
+    if (yielded_.has_value()) {
+        func(*yielded_);
+    }
+}
+
+void VirtualMachine::BytecodeGenerator::ReleaseValues() {
+    stack_.clear();
+    env_.Clear(0, static_cast<uint32_t>(env_.size()));
+    yielded_.reset();
+    finished_ = true;
+}
+
+} // namespace vm
+
+} // namespace itmoscript
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Chunk.hpp"
+#include "Compiler.hpp"
+
+#include "ast/AST.hpp"
+#include "evaluation/Evaluator.hpp"
+#include "objects/Value.hpp"
+#include "objects/Function.hpp"
+#include "objects/Generator.hpp"
+#include "objects/MemoTable.hpp"
+
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace itmoscript {
+
+namespace vm {
+
+/** @brief Engines the interpreter can execute the program with. */
+enum class ExecutionMode {
+    kBytecode,
+    kTreeWalk,
+};
+
+/**
+ * @class VirtualMachine
+ * @brief Compiles the AST to bytecode and executes it on a value stack.
+ *
+ * @details The machine doesn't own any language state: scopes, operators, the standard library
+ * and the call stack belong to the Evaluator it's attached to, so both engines share
+ * the same semantics and the same global scope.
+ *
+ * Calls of script functions don't recurse on the native stack: every call pushes a Frame
+ * and the dispatch loop continues with the callee's chunk. A generator keeps its frame
+ * while suspended: resuming it pushes the frame back and runs the loop until the frame is left.
+ *
+ * @example
+ * ```
+ * Evaluator evaluator;
+ * evaluator.EnableStandardOperators();
+ * evaluator.EnableStd();
+ *
+ * vm::VirtualMachine machine{evaluator};
+ * machine.Evaluate(program, std::cin, std::cout);
+ * ```
+ */
+class VirtualMachine {
+public:
+    explicit VirtualMachine(Evaluator& evaluator)
+        : evaluator_(evaluator), compiler_(evaluator.std_lib_) {}
+
+    VirtualMachine(const VirtualMachine&) = delete;
+    VirtualMachine(VirtualMachine&&) = delete;
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
+    VirtualMachine& operator=(VirtualMachine&&) = delete;
+    ~VirtualMachine() = default;
+
+    /**
+     * @brief Compiles and executes the program.
+     * Has the same contract as Evaluator::Evaluate(): the global scope is preserved
+     * between calls, the value of the last statement becomes the last evaluated value.
+     * @throws RuntimeError if evaluation fails.
+     */
+    void Evaluate(ast::Program& root, std::istream& input, std::ostream& output);
+
+private:
+    class BytecodeGenerator;
+
+    /**
+     * @struct Frame
+     * @brief Activation of a compiled function (or of the top-level program).
+     */
+    struct Frame {
+        std::shared_ptr<const CompiledFunction> function; // keeps the code alive during the call
+        size_t ip = 0;
+        size_t stack_base = 0; // stack size before the call
+        size_t env_depth = 0;  // env stack size before the call
+
+        /** @brief Code of the function which made the tail call, the call stack refers to its tokens. */
+        std::shared_ptr<const CompiledFunction> tail_caller;
+
+        /** @brief Caches of the memoized calls this frame returns the result of. */
+        std::vector<PendingMemo> pending_memos;
+
+        /** @brief Generator the frame executes the body of, nullptr for a call. */
+        BytecodeGenerator* generator = nullptr;
+    };
+
+    /**
+     * @class BytecodeGenerator
+     * @brief Generator created by a call of a generator function: the frame of the call, suspended.
+     * @details While suspended, the generator holds the instruction pointer, the part of the value stack
+     * above the frame's base (e.g. the state of the enclosing for loops) and the environment of the call.
+     */
+    class BytecodeGenerator : public GeneratorObject {
+    public:
+        BytecodeGenerator(VirtualMachine& machine, const std::string& name, const Function& func, Environment env)
+            : machine_(machine), name_(name), function_(func.compiled()), env_(std::move(env)) {}
+
+        /** @throws ControlFlowError if the generator is resumed by its own body. */
+        std::optional<Value> Next() override;
+
+        void ForEachValue(const std::function<void(const Value&)>& func) const override;
+        void ReleaseValues() override;
+
+    private:
+        friend class VirtualMachine;
+
+        VirtualMachine& machine_;
+        std::string name_;
+        std::shared_ptr<const CompiledFunction> function_;
+
+        size_t ip_ = 0;
+        std::vector<Value> stack_;
+        Environment env_;
+
+        std::optional<Value> yielded_;
+        bool running_ = false;
+        bool finished_ = false;
+    };
+
+    Evaluator& evaluator_;
+    Compiler compiler_;
+
+    std::shared_ptr<const CompiledFunction> script_;
+
+    std::vector<Value> stack_;
+    std::vector<Frame> frames_;
+
+    /**
+     * @brief Executes instructions until kHalt is reached,
+     * or until a function returns or yields with only depth frames left.
+     */
+    void Run(size_t depth = 0);
+
+    Value Pop();
+
+    /**
+     * @brief Calls the value with the arguments on the top of the stack.
+     * Pushes the frame of the callee, so its code is executed next.
+     * A memoized function with the result cached pushes the result instead.
+     */
+    void CallValue(const CallSite& site, const Value& callee);
+
+    /**
+     * @brief Calls the value in place of the current function: its frame, its environment
+     * and its entry of the call stack are reused, so tail recursion runs in constant memory.
+     */
+    void TailCallValue(const CallSite& site, const Value& callee);
+
+    /** @brief Checks that the value can be called at the site and compiles the function if needed. */
+    const Function& PrepareCallee(const CallSite& site, const Value& callee);
+
+    /** @brief Calls the standard function with the arguments on the top of the stack. */
+    void CallBuiltin(const Chunk& chunk, const CallSite& site);
+
+    /**
+     * @brief Leaves the current function, pushing the result for the caller.
+     * A generator finishes instead, the result is discarded.
+     */
+    void Return(Value result);
+
+    /** @brief Creates the generator of the call, taking the arguments on the top of the stack. */
+    Value MakeGenerator(const CallSite& site, const Function& func);
+
+    /** @brief Suspends the generator of the current frame, passing the value to its consumer. */
+    void Yield(Value value);
+};
+
+} // namespace vm
+
+} // namespace itmoscript
@@ -36,7 +36,7 @@ void TestValue(const IsValue& value, T expected) {
 }
 
 template<typename T, typename Inner>
-void TestHeavyValue(const IsValue& value, const std::shared_ptr<Inner>& expected) {
+void TestHeavyValue(const IsValue& value, const itmoscript::Ref<Inner>& expected) {
     ASSERT_TRUE(value.IsOfType<T>()) 
         << "real type of " << value.ToString() << 
         " is: " << itmoscript::GetTypeName(value.GetType());
@@ -89,3 +89,12 @@ TEST(EvaluationFunctionTestSuite, FunctionShadowingScopeTest) {
         ASSERT_EQ(evaluated, expected) << "input: " << input;
     }
 }
+
+TEST(EvaluationFunctionTestSuite, ShadowedStandardFunctionTest) {
+    std::string code = R"(
+        apply = function(len, x) return len(x) end function
+        len("abc") + apply(function(s) return 10 end function, "q") + len([1])
+    )";
+
+    ASSERT_EQ(Eval(code), IsValue{14});
+}
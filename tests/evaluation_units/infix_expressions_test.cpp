@@ -131,6 +131,24 @@ TEST(EvaluationInfixTestSuite, LogicalOperatorsTest) {
     }
 }
 
+TEST(EvaluationInfixTestSuite, LogicalShortCircuitTest) {
+    // the right operands refer to undefined names, evaluating them would throw
+    std::vector<std::pair<std::string, bool>> expressions{
+        {"false and undefined", false},
+        {"true or undefined", true},
+        {"nil and undefined()", false},
+        {"1 or undefined[0]", true},
+        {"x = [] len(x) > 0 and x[0] > 0", false},
+        {"true and 0", false},
+        {"false or \"a\"", true},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        IsValue evaluated = Eval(input);
+        TestValue<itmoscript::Bool>(evaluated, expected);
+    }
+}
+
 TEST(EvaluationInfixTestSuite, ListComparisonTest) {
     std::vector<std::pair<std::string, bool>> expressions{
         {"[1, 2, 3] == [1, 2, 3]", true},
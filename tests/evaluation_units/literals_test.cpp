@@ -72,3 +72,43 @@ TEST(EvaluationLiteralsTestSuite, StringLiteralTest) {
         TestHeavyValue<itmoscript::String>(evaluated, itmoscript::CreateString(expected));
     }
 }
+
+TEST(EvaluationLiteralsTestSuite, LiteralsEvaluatedAgainTest) {
+    // literals are kept in the constant pool, changes of their values must not leak to the next evaluation
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {R"(f = function() s = "a" t = s s = s + "b" return t end function f() f())", R"("ab")"},
+        {R"(f = function(i) l = [1, 2] push(l, i) return l end function f(0) f(1))", "[1, 2, 1]"},
+        {R"(f = function() l = ["x"] s = l[0] s = "y" return l end function f() f())", R"(["y"])"},
+        {R"(f = function(s) s = s + "!" return s end function f("a") f("a"))", R"("a!")"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Eval(input).ToString(), expected) << input;
+    }
+}
+
+TEST(EvaluationLiteralsTestSuite, ConstantsFreedWithProgramTest) {
+    itmoscript::Evaluator evaluator;
+    evaluator.EnableStandardOperators();
+    evaluator.EnableStd();
+    std::stringstream dummy;
+
+    itmoscript::ast::Program first = GetParsedProgram(R"(
+        f = function() return "kept" end function
+        [1, 2, 3]
+    )");
+    evaluator.Evaluate(first, dummy, dummy);
+
+    auto& statement = static_cast<itmoscript::ast::ExpressionStatement&>(*first.GetStatements()[1]);
+    std::weak_ptr<const itmoscript::Value> list = static_cast<itmoscript::ast::ListLiteral&>(*statement.expr).constant;
+    ASSERT_FALSE(list.expired());
+
+    // like the REPL: the line is gone, the function it defined stays
+    first = GetParsedProgram("");
+
+    itmoscript::ast::Program second = GetParsedProgram(R"(f() + "!")");
+    evaluator.Evaluate(second, dummy, dummy);
+
+    ASSERT_TRUE(list.expired());
+    ASSERT_EQ(evaluator.GetLastEvaluatedValue().ToString(), R"("kept!")");
+}
@@ -0,0 +1,320 @@
+#include "evaluation_units_test.hpp"
+
+#include "lib/evaluation/StandardFunctions.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+static std::string Optimize(const std::string& input) {
+    itmoscript::Evaluator evaluator;
+    itmoscript::ast::Program program = GetParsedProgram(input);
+    evaluator.EnableStandardOperators();
+    evaluator.EnableStd();
+    evaluator.EnableOptimizer(true);
+    evaluator.Optimize(program);
+    return program.String();
+}
+
+TEST(EvaluationOptimizerTestSuite, ConstantFoldingTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"x = 1 + 2 * 3", "x = 7"},
+        {"-(2 + 3)", "-5"},
+        {"not (1 < 2)", "false"},
+        {"\"ab\" + \"c\"", "\"abc\""},
+        {"[1, 2] + [3]", "[1, 2, 3]"},
+        {"false and x", "false"},
+        {"true or x", "true"},
+        {"x and true", "(x AND true)"},
+        {"1 + x * 2", "(1 + (x * 2))"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, FailingExpressionNotFoldedTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"1 / 0", "(1 / 0)"},
+        {"1 + \"a\"", "(1 + \"a\")"},
+        {"\"a\" * 1000", "(\"a\" * 1000)"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, ConstantPropagationTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"n = 10\nm = n * 2", "n = 10\nm = 20"},
+        {"n = 10\nn = 11\nm = n * 2", "n = 10\nn = 11\nm = (n * 2)"},
+        {"m = n * 2\nn = 10", "m = (n * 2)\nn = 10"},
+        {"s = \"ab\"\nt = s", "s = \"ab\"\nt = s"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, PureFunctionsTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"len(\"abc\")", "3"},
+        {"range(3)", "[0, 1, 2]"},
+        {"range(1000)", "range(1000)"},
+        {"upper(\"ab\") + \"c\"", "\"ABc\""},
+        {"print(len(\"abc\"))", "print(3)"},
+        {"len(x)", "len(x)"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, OptimizedProgramResultTest) {
+    std::vector<std::pair<std::string, int64_t>> expressions{
+        {"n = 4\nf = function(len) return len(n) end function\nf(function(x) return x * 2 end function)", 8},
+        {"n = 4\nfor i in range(3)\n n = n + i\nend for\nn", 7},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        itmoscript::Evaluator evaluator;
+        itmoscript::ast::Program program = GetParsedProgram(input);
+        evaluator.EnableStandardOperators();
+        evaluator.EnableStd();
+        evaluator.EnableOptimizer(true);
+        std::stringstream dummy;
+        evaluator.Evaluate(program, dummy, dummy);
+        TestValue<itmoscript::Int>(evaluator.GetLastEvaluatedValue(), expected);
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, DeadCodeTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"f = function()\n return 1\n print(2)\nend function", "f = function() return 1 end function"},
+        {"if false then 1 elseif x then 2 else 3 end if", " if x then 2 else 3 end if"},
+        {"if false then 1 else 3 end if", " if true then 3 end if"},
+        {"if x then 1 elseif true then 2 else 3 end if", " if x then 1 elseif true then 2 end if"},
+        {"if false then 1 end if", "nil"},
+        {"if x then\n 1\n while false\n print(1)\n end while\n 2\nend if", " if x then 2 end if"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, LoopInvariantTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        // arr may be a generator, len() drains it
+        {
+            "f = function(arr, k)\n while i < len(arr) - 1\n i = i + k * 2\n end while\nend function",
+            "f = function(arr, k) while (i < (len(arr) - 1)) i = (i + invariant((k * 2)))  end while end function"
+        },
+        {
+            "f = function(a, b)\n for i in range(a)\n print(i + a * b)\n end for\nend function",
+            "f = function(a, b) for i in range(a)print((i + invariant((a * b))))  end for end function"
+        },
+        {
+            "f = function(a)\n while a < 10\n a += 1\n print(a * 2)\n end while\nend function",
+            "f = function(a) while (a < 10) a += 1 print((a * 2))  end while end function"
+        },
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+/** @brief Generator counting its resumptions, it yields nothing. */
+class CountingGenerator : public itmoscript::GeneratorObject {
+public:
+    std::optional<itmoscript::Value> Next() override {
+        ++resumed;
+        return std::nullopt;
+    }
+
+    size_t resumed = 0;
+};
+
+TEST(EvaluationOptimizerTestSuite, StandardFunctionsRunNoScriptCodeTest) {
+    // the loop-invariant hoisting assumes these functions run no script code, unless they drain a generator
+    itmoscript::stdlib::StdLib std_lib;
+    std_lib.LoadDefault();
+
+    itmoscript::Token token{};
+    itmoscript::CallStack call_stack;
+    std::istringstream input;
+    std::ostringstream output;
+
+    for (const auto* table : {&itmoscript::kPureFunctions, &itmoscript::kValuePreservingFunctions,
+                              &itmoscript::kListModifyingFunctions}) {
+        for (const std::string& name : *table) {
+            ASSERT_TRUE(std_lib.Has(name)) << name;
+
+            for (size_t arg_count = 0; arg_count <= 3; ++arg_count) {
+                auto* generator = new CountingGenerator();
+                itmoscript::Generator handle{generator};
+                std::vector<itmoscript::Value> args(arg_count, itmoscript::Value{handle});
+
+                try {
+                    if (auto* func = std_lib.FindValueHandlingFunc(name)) {
+                        (*func)(args, token, call_stack);
+                    } else if (auto* func = std_lib.FindOutStreamHandlingFunc(name)) {
+                        (*func)(output, args, token, call_stack);
+                    } else if (auto* func = std_lib.FindInStreamHandlingFunc(name)) {
+                        (*func)(input, args, token, call_stack);
+                    }
+                } catch (const std::exception&) {
+                    // wrong number or types of the arguments
+                }
+
+                if (generator->resumed > 0) {
+                    ASSERT_TRUE(itmoscript::kGeneratorDrainingFunctions.contains(name)) << name;
+                }
+            }
+        }
+    }
+}
+
+static std::string RunProgram(const std::string& code, bool optimize, itmoscript::vm::ExecutionMode mode) {
+    std::istringstream code_stream{code};
+    itmoscript::Lexer lexer{code_stream};
+    itmoscript::Parser parser{lexer};
+    std::istringstream input{"7\n5\n-2\nend\n"};
+    std::ostringstream output;
+
+    try {
+        itmoscript::ast::Program program = parser.ParseProgram();
+        itmoscript::Evaluator evaluator;
+        evaluator.EnableStandardOperators();
+        evaluator.EnableStd();
+
+        if (optimize) {
+            evaluator.EnableOptimizer(true);
+        }
+
+        if (mode == itmoscript::vm::ExecutionMode::kTreeWalk) {
+            evaluator.Evaluate(program, input, output);
+        } else {
+            itmoscript::vm::VirtualMachine machine{evaluator};
+            machine.Evaluate(program, input, output);
+        }
+    } catch (const itmoscript::lang_exceptions::LangException& e) {
+        output << e.what();
+    }
+
+    return output.str();
+}
+
+static void ExpectSameOptimized(const std::string& code) {
+    for (auto mode : {itmoscript::vm::ExecutionMode::kTreeWalk, itmoscript::vm::ExecutionMode::kBytecode}) {
+        ASSERT_EQ(RunProgram(code, true, mode), RunProgram(code, false, mode)) << code;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, ScriptCodeInLoopSemanticsTest) {
+    // every way to run script code inside a loop makes the global the loop reads variable
+    std::vector<std::string> programs{
+        "n = 0\nf = function() n += 1 return n end function\ni = 0\nwhile i < 3\n f()\n println(n * 2)\n i += 1\nend while",
+        "n = 0\ng = function() for i in range(3) n += 1 yield i end for end function\n"
+        "for x in g()\n println(n * 2)\nend for",
+        "n = 0\ng = function() for i in range(3) n += 1 yield i end for end function\ni = 0\n"
+        "while i < 2\n for x in g() end for\n println(n * 2)\n i += 1\nend while",
+        "n = 0\ng = function() for i in range(3) n += 1 yield i end for end function\ni = 0\n"
+        "while i < 2\n l = [len(g()), join(g(), \",\"), sort(g())]\n println(n * 2)\n i += 1\nend while",
+    };
+
+    for (const std::string& code : programs) {
+        ExpectSameOptimized(code);
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, LoopInvariantSemanticsTest) {
+    std::vector<std::pair<std::string, std::string>> programs{
+        // the list is modified through its alias
+        {"a = [1, 2, 3]\nb = a\nn = 0\ni = 0\nwhile i < len(a)\n if i == 0 then b = [1, 2, 3, 4, 5] end if\n"
+         "n += 1\n i += 1\nend while\nprint(n)", "5"},
+        // the function assigns the global
+        {"n = 3\nf = function() n = n + 1 end function\nc = 0\ni = 0\nwhile i < n * 2\n"
+         "if i == 0 then f() end if\n c += 1\n i += 1\nend while\nprint(c)", "8"},
+        {"l = []\nwhile len(l) < 5\n push(l, 0)\nend while\nprint(len(l))", "5"},
+        {"f = function(n)\n s = 0\n for i in range(3)\n  for j in range(i * n)\n   s += n * 2\n  end for\n end for\n"
+         "return s\nend function\nprint(f(2))", "24"},
+        // every call of the recursive function has its own hoisted values
+        {"f = function(n, k)\n s = 0\n i = 0\n while i < k * 2\n  if n > 0 then s += f(n - 1, k + 1) end if\n"
+         "  s += 1\n  i += 1\n end while\n return s\nend function\nprint(f(2, 1))", "58"},
+        // the value is computed again when the loop starts again
+        {"r = []\nfor k in range(3)\n i = 0\n while i < k * 2\n  i += 1\n end while\n push(r, i)\nend for\nprint(r)",
+         "[0, 2, 4]"},
+        // the failing expression fails when reached
+        {"x = \"a\"\ni = 0\nwhile i < 3\n i += 1\n if i == 2 then print(x - 1) end if\n print(i)\nend while", ""},
+        {"x = 0\nwhile true\n x += 1\n if x > 2 then\n  break\n  print(1)\n end if\nend while\nprint(x)", "3"},
+    };
+
+    for (const auto& [code, expected] : programs) {
+        ExpectSameOptimized(code);
+
+        if (!expected.empty()) {
+            ASSERT_EQ(RunProgram(code, true, itmoscript::vm::ExecutionMode::kBytecode), expected) << code;
+        }
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, ExamplesSemanticsTest) {
+    for (const auto& entry : std::filesystem::directory_iterator{ITMOSCRIPT_EXAMPLES_DIR}) {
+        std::ifstream file{entry.path()};
+        std::string code{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+        ExpectSameOptimized(code);
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, InliningTest) {
+    std::vector<std::pair<std::string, std::string>> expressions{
+        {"sq = function(x) return x * x end function\nsq(3)",
+         "sq = function(x) return (x * x) end function\ninline sq(3) (x * x)"},
+        {"sq = function(x) return x * x end function\nf = function(a) return sq(a + 1) end function\nf(2)",
+         "sq = function(x) return (x * x) end function\n"
+         "f = function(a) return inline sq((a + 1)) (x * x) end function\n"
+         "inline f(2) inline sq((a + 1)) (x * x)"},
+        {"function(y) return y + 1 end function(41)", "inline <anonymous function>(41) (y + 1)"},
+        // recursive, assigned twice, called before the assignment or with other arguments
+        {"f = function(n) return f(n - 1) end function\nf(1)",
+         "f = function(n) return f((n - 1)) end function\nf(1)"},
+        {"f = function(x) return x end function\nf = 1\nf(1)", "f = function(x) return x end function\nf = 1\nf(1)"},
+        {"f(1)\nf = function(x) return x end function", "f(1)\nf = function(x) return x end function"},
+        {"f = function(x) return x end function\nf(1, 2)", "f = function(x) return x end function\nf(1, 2)"},
+        {"f = function(x)\n print(x)\n return x\nend function\nf(1)",
+         "f = function(x) print(x)\nreturn x end function\nf(1)"},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Optimize(input), expected) << input;
+    }
+}
+
+TEST(EvaluationOptimizerTestSuite, InliningSemanticsTest) {
+    std::vector<std::pair<std::string, std::string>> programs{
+        {"sq = function(x) return x * x end function\nadd = function(a, b) return sq(a) + b end function\n"
+         "s = 0\nfor i in range(5)\n s += add(i, 1)\nend for\nprint(s)", "35"},
+        // the call is still on the stack
+        {"f = function(x) return stacktrace() end function\nprint(f(1))", "[[\"f\", 2]]"},
+        {"f = function(x) return x - 1 end function\ng = function(s) return f(s) end function\nprint(g(\"a\"))", ""},
+        // the argument is modified in place through the parameter
+        {"f = function(l) return push(l, 1) end function\nl = []\nf(l)\nf(l)\nprint(l)", "[1, 1]"},
+        {"f = function(a, b) return a + b end function\nprint(f(f(1, 2), f(3, 4)))", "10"},
+        {"f = function(x) return x + n end function\nn = 1\nprint(f(1))\nn = 5\nprint(f(1))", "26"},
+    };
+
+    for (const auto& [code, expected] : programs) {
+        ExpectSameOptimized(code);
+
+        if (!expected.empty()) {
+            ASSERT_EQ(RunProgram(code, true, itmoscript::vm::ExecutionMode::kBytecode), expected) << code;
+        }
+    }
+}
@@ -59,3 +59,77 @@ TEST(EvaluationScopeTestSuite, UpdateOuterScopeVarTest) {
         ASSERT_EQ(evaluated, expected) << "input: " << input;
     }
 }
+
+TEST(EvaluationScopeTestSuite, ShadowingTest) {
+    std::vector<std::pair<std::string, IsValue>> expressions = {
+        {R"(
+            x = 1
+            f = function(x)
+                x = x + 10
+                return x
+            end function
+            f(5) + x
+        )", IsValue{16}},
+        {R"(
+            f = function(x)
+                for x in [100, 200]
+                    x += 1
+                end for
+                return x
+            end function
+            f(7)
+        )", IsValue{7}},
+        {R"(
+            counter = 0
+            inc = function()
+                counter += 1
+            end function
+            inc()
+            inc()
+            counter
+        )", IsValue{2}},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        IsValue evaluated = Eval(input);
+        ASSERT_EQ(evaluated, expected) << "input: " << input;
+    }
+}
+
+TEST(EvaluationScopeTestSuite, CallerLocalsAreInvisibleTest) {
+    std::string expr = R"(
+        getY = function() return y end function
+        if true then
+            y = 10
+            getY()
+        end if
+    )";
+
+    ASSERT_THROW(Eval(expr), itmoscript::lang_exceptions::UndefinedNameError);
+}
+
+TEST(EvaluationScopeTestSuite, IterationScopeIsFreshTest) {
+    std::string expr = R"(
+        for i in [1, 2]
+            if i == 2 then
+                y
+            end if
+            y = i
+        end for
+    )";
+
+    ASSERT_THROW(Eval(expr), itmoscript::lang_exceptions::UndefinedNameError);
+}
+
+TEST(EvaluationScopeTestSuite, SiblingScopesTest) {
+    std::string expr = R"(
+        if true then
+            a = 1
+        end if
+        if true then
+            a
+        end if
+    )";
+
+    ASSERT_THROW(Eval(expr), itmoscript::lang_exceptions::UndefinedNameError);
+}
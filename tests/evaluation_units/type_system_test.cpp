@@ -35,7 +35,7 @@ TEST(EvaluationTypesTestSuite, ExplicitConversionTest) {
         ASSERT_EQ(type_system.TryConvert(value, requested_type), expected)
             << "value: " << value << "; requested type: " << itmoscript::GetTypeName(value.GetType()) 
             << "; expected: " 
-            << (expected.has_value() ? *expected : IsValue{std::make_shared<std::string>("nullopt")});
+            << (expected.has_value() ? *expected : IsValue{itmoscript::CreateString("nullopt")});
     }
 }
 
@@ -72,3 +72,80 @@ TEST(EvaluationTypesTestSuite, CommonTypeTest) {
             << (expected.has_value() ? itmoscript::GetTypeName(*expected) : "nullopt");
     }
 }
+
+TEST(EvaluationTypesTestSuite, OperatorPromotionTest) {
+    itmoscript::TypeConversionSystem type_system;
+    RegisterConversions(type_system);
+
+    itmoscript::OperatorRegistry registry;
+    registry.RegisterBinaryOper<itmoscript::Float, itmoscript::Float>(
+        itmoscript::TokenType::kPlus,
+        [](const IsValue& left, const IsValue& right) { return left.Get<itmoscript::Float>() + right.Get<itmoscript::Float>(); }
+    );
+    registry.RegisterPromotions(type_system);
+
+    auto float_type = itmoscript::GetType<itmoscript::Float>();
+    auto int_type = itmoscript::GetType<itmoscript::Int>();
+    auto string_type = itmoscript::GetType<itmoscript::String>();
+
+    const auto& exact = registry.FindHandler(itmoscript::TokenType::kPlus, float_type, float_type);
+    ASSERT_NE(exact.handler, nullptr);
+    ASSERT_FALSE(exact.IsPromoted());
+
+    const auto& mixed = registry.FindHandler(itmoscript::TokenType::kPlus, int_type, float_type);
+    ASSERT_EQ(mixed.handler, exact.handler);
+    ASSERT_NE(mixed.convert_left, nullptr);
+    ASSERT_EQ(mixed.convert_right, nullptr);
+    ASSERT_EQ((*mixed.convert_left)(IsValue{2}), IsValue{2.0});
+
+    ASSERT_EQ(registry.FindHandler(itmoscript::TokenType::kPlus, int_type, int_type).handler, nullptr);
+    ASSERT_EQ(registry.FindHandler(itmoscript::TokenType::kPlus, string_type, float_type).handler, nullptr);
+    ASSERT_EQ(registry.FindHandler(itmoscript::TokenType::kMinus, int_type, float_type).handler, nullptr);
+}
+
+TEST(EvaluationTypesTestSuite, MixedOperandsTest) {
+    std::vector<std::pair<std::string, IsValue>> expressions = {
+        {"1 + 2.5", IsValue{3.5}},
+        {"2.5 * 2", IsValue{5.0}},
+        {"true + 1", IsValue{2}},
+        {"1 < 1.5", IsValue{true}},
+        {"2 == 2.0", IsValue{true}},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        ASSERT_EQ(Eval(input), expected) << "input: " << input;
+    }
+}
+
+TEST(EvaluationTypesTestSuite, OperandTypesChangeTest) {
+    std::string code = R"(
+        add = function(a, b) return a + b end function
+        less = function(a, b) return a < b end function
+        at = function(seq, i) return seq[i] end function
+
+        result = []
+        for i in range(0, 3) 
+            result = result + [add(i, 1), add(i * 1.5, 1), add("a", to_string(i)), add(i, 0.5), add([i], [1])]
+            result = result + [less(i, 2), less(i * 1.0, 0.5), less("b", "a")]
+            result = result + [at([i, 7], 0), at("xy", 1), at([i, 7], -1)]
+        end for
+        result
+    )";
+
+    std::vector<IsValue> expected;
+    for (itmoscript::Int i = 0; i < 3; ++i) {
+        expected.emplace_back(i + 1);
+        expected.emplace_back(i * 1.5 + 1);
+        expected.emplace_back(itmoscript::CreateString("a" + std::to_string(i)));
+        expected.emplace_back(i + 0.5);
+        expected.emplace_back(itmoscript::CreateList(std::vector<IsValue>{i, 1}));
+        expected.emplace_back(i < 2);
+        expected.emplace_back(i < 0.5);
+        expected.emplace_back(false);
+        expected.emplace_back(i);
+        expected.emplace_back(itmoscript::CreateString("y"));
+        expected.emplace_back(7);
+    }
+
+    ASSERT_EQ(Eval(code), IsValue{itmoscript::CreateList(expected)});
+}
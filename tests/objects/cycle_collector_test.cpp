@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "lib/objects/List.hpp"
+#include "lib/objects/CycleCollector.hpp"
+#include "tests/vm/vm_test.hpp"
+
+using Value = itmoscript::Value;
+
+TEST(ObjectsCycleCollectorTestSuite, SelfReferenceTest) {
+    itmoscript::CycleCollector& collector = itmoscript::CycleCollector::Instance();
+    collector.Collect();
+    size_t tracked = collector.tracked_count();
+
+    {
+        itmoscript::List list = itmoscript::CreateList(std::vector<Value>{1});
+        list->Insert(1, Value{list});
+    }
+
+    ASSERT_EQ(collector.tracked_count(), tracked + 1);
+    ASSERT_EQ(collector.Collect(), 1);
+    ASSERT_EQ(collector.tracked_count(), tracked);
+}
+
+TEST(ObjectsCycleCollectorTestSuite, ReachableCycleTest) {
+    itmoscript::CycleCollector& collector = itmoscript::CycleCollector::Instance();
+    collector.Collect();
+
+    itmoscript::List outer = itmoscript::CreateList(std::vector<Value>{});
+    {
+        itmoscript::List first = itmoscript::CreateList(std::vector<Value>{});
+        itmoscript::List second = itmoscript::CreateList(std::vector<Value>{first});
+        first->Insert(0, Value{second});
+        outer->Insert(0, Value{first});
+    }
+
+    // the cycle is referenced from outside, so nothing is freed
+    ASSERT_EQ(collector.Collect(), 0);
+    ASSERT_EQ(outer->At(0).Get<itmoscript::List>()->size(), 1);
+
+    outer = nullptr;
+    ASSERT_EQ(collector.Collect(), 2);
+}
+
+TEST(ObjectsCycleCollectorTestSuite, SharedElementsTest) {
+    itmoscript::CycleCollector& collector = itmoscript::CycleCollector::Instance();
+    collector.Collect();
+
+    std::optional<Value> copy;
+    {
+        itmoscript::List list = itmoscript::CreateList(std::vector<Value>{1});
+        list->Insert(1, Value{list});
+        copy = Value{list}.GetCopy();
+    }
+
+    // the copy shares the elements of the list, including the list itself
+    ASSERT_EQ(collector.Collect(), 0);
+
+    copy.reset();
+    ASSERT_EQ(collector.Collect(), 1);
+}
+
+TEST(ObjectsCycleCollectorTestSuite, SuspendedGeneratorTest) {
+    // the list holds the generator, the suspended generator holds the list as its argument
+    std::string code = R"(
+        gen = function(l)
+            yield 1
+            yield 2
+        end function
+
+        make = function()
+            l = [1]
+            g = gen(l)
+            push(l, g)
+            for x in g break end for
+        end function
+
+        gc()
+        make()
+        print(gc())
+    )";
+
+    ASSERT_EQ(RunCode(code, itmoscript::vm::ExecutionMode::kTreeWalk), "2");
+    ASSERT_EQ(RunCode(code, itmoscript::vm::ExecutionMode::kBytecode), "2");
+}
@@ -11,21 +11,21 @@ TEST(ObjectsListTestSuite, SmallListTest) {
     std::vector<Value> values = {
         1,
         1.5,
-        Value{std::make_shared<std::string>("aaa")},
+        Value{itmoscript::CreateString("aaa")},
         Value{true}
     };
 
-    itmoscript::List list = std::make_shared<itmoscript::ListObject>(values);
+    itmoscript::List list = itmoscript::CreateList(values);
     ASSERT_EQ(list->size(), values.size());
-    ASSERT_EQ(list->data(), values);
+    ASSERT_THAT(list->data(), testing::ElementsAreArray(values));
 }
 
 TEST(ObjectsListTestSuite, EmptyListTest) {
     std::vector<Value> values = {};
 
-    itmoscript::List list = std::make_shared<itmoscript::ListObject>(values);
+    itmoscript::List list = itmoscript::CreateList(values);
     ASSERT_EQ(list->size(), values.size());
-    ASSERT_EQ(list->data(), values);
+    ASSERT_THAT(list->data(), testing::ElementsAreArray(values));
 }
 
 TEST(ObjectsListTestSuite, ListSliceTest) {
@@ -33,9 +33,9 @@ TEST(ObjectsListTestSuite, ListSliceTest) {
         1, 2, 3, 4, 5, 6,
     };
 
-    itmoscript::List list = std::make_shared<itmoscript::ListObject>(values);
+    itmoscript::List list = itmoscript::CreateList(values);
     ASSERT_EQ(list->size(), values.size());
-    ASSERT_EQ(list->data(), values);
+    ASSERT_THAT(list->data(), testing::ElementsAreArray(values));
 
     // <start, end, expected>
     std::vector<std::tuple<size_t, size_t, std::vector<Value>>> slices = {
@@ -49,8 +49,66 @@ TEST(ObjectsListTestSuite, ListSliceTest) {
     };
 
     for (const auto& [start, end, expected] : slices) {
-        std::vector<Value> slice = list->GetSlice(start, end);
-        ASSERT_EQ(slice, expected) 
+        itmoscript::ListObject slice = list->GetSlice(start, end);
+        ASSERT_THAT(slice.data(), testing::ElementsAreArray(expected)) 
             << "start: " << start << "; end: " << end;
     }
 }
+
+TEST(ObjectsListTestSuite, CopyOnWriteTest) {
+    itmoscript::List original = itmoscript::CreateList(std::vector<Value>{1, 2, 3});
+    Value copy = Value{original}.GetCopy();
+    const itmoscript::List& copied = copy.Get<itmoscript::List>();
+
+    ASSERT_NE(copied, original);
+    ASSERT_EQ(copied->data().data(), original->data().data());
+
+    copied->Set(0, 10);
+    copied->Insert(3, Value{4});
+    original->Remove(0);
+
+    ASSERT_THAT(copied->data(), testing::ElementsAre(10, 2, 3, 4));
+    ASSERT_THAT(original->data(), testing::ElementsAre(2, 3));
+}
+
+TEST(ObjectsListTestSuite, SliceViewTest) {
+    itmoscript::List list = itmoscript::CreateList(std::vector<Value>{1, 2, 3, 4, 5, 6});
+    itmoscript::List slice = itmoscript::CreateList(list->GetSlice(1, 5));
+    itmoscript::ListObject nested = slice->GetSlice(1, 3);
+
+    ASSERT_EQ(slice->data().data(), list->data().data() + 1);
+    ASSERT_THAT(nested.data(), testing::ElementsAre(3, 4));
+
+    slice->Set(0, 20);
+    ASSERT_THAT(slice->data(), testing::ElementsAre(20, 3, 4, 5));
+    ASSERT_THAT(list->data(), testing::ElementsAre(1, 2, 3, 4, 5, 6));
+    ASSERT_THAT(nested.data(), testing::ElementsAre(3, 4));
+
+    // the slice outlives the sliced list and trims the buffer it owns alone
+    list = nullptr;
+    nested.Insert(0, Value{0});
+    ASSERT_THAT(nested.data(), testing::ElementsAre(0, 3, 4));
+}
+
+TEST(ObjectsListTestSuite, LazyRangeTest) {
+    itmoscript::ListObject range = itmoscript::ListObject::MakeRange(10, -3, 4);
+
+    ASSERT_TRUE(range.lazy());
+    ASSERT_EQ(range.size(), 4);
+    ASSERT_EQ(range.At(3), Value{1});
+    ASSERT_EQ(range, itmoscript::ListObject(std::vector<Value>{10, 7, 4, 1}));
+
+    itmoscript::ListObject slice = range.GetSlice(1, 3);
+    ASSERT_TRUE(slice.lazy());
+    ASSERT_EQ(slice, itmoscript::ListObject::MakeRange(7, -3, 2));
+
+    // a huge range is not materialized by the access to its elements
+    itmoscript::ListObject huge = itmoscript::ListObject::MakeRange(0, 1, 1'000'000'000'000);
+    ASSERT_EQ(huge.At(999'999'999'999), Value{999'999'999'999});
+    ASSERT_TRUE(huge.lazy());
+
+    range.Insert(4, Value{-2});
+    ASSERT_FALSE(range.lazy());
+    ASSERT_THAT(range.data(), testing::ElementsAre(10, 7, 4, 1, -2));
+    ASSERT_THAT(slice.data(), testing::ElementsAre(7, 4));
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "lib/objects/MemoTable.hpp"
+#include "lib/objects/List.hpp"
+
+using Value = itmoscript::Value;
+
+TEST(ObjectsMemoTableTestSuite, FindInsertTest) {
+    itmoscript::MemoTable memo;
+    std::vector<Value> args{1, itmoscript::CreateString("a")};
+
+    ASSERT_FALSE(memo.Find(args).has_value());
+    memo.Insert(itmoscript::MemoTable::MakeKey(args), Value{42});
+
+    auto result = memo.Find(args);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(*result, Value{42});
+
+    // the types of the arguments are a part of the key
+    ASSERT_FALSE(memo.Find(std::vector<Value>{1.0, itmoscript::CreateString("a")}).has_value());
+
+    ASSERT_EQ(memo.hits(), 1);
+    ASSERT_EQ(memo.misses(), 2);
+    ASSERT_EQ(memo.size(), 1);
+}
+
+TEST(ObjectsMemoTableTestSuite, LeastRecentlyUsedTest) {
+    itmoscript::MemoTable memo{2};
+
+    memo.Insert({Value{1}}, Value{10});
+    memo.Insert({Value{2}}, Value{20});
+    ASSERT_TRUE(memo.Find(std::vector<Value>{1}).has_value());
+
+    memo.Insert({Value{3}}, Value{30});
+
+    ASSERT_EQ(memo.size(), 2);
+    ASSERT_TRUE(memo.Find(std::vector<Value>{1}).has_value());
+    ASSERT_FALSE(memo.Find(std::vector<Value>{2}).has_value());
+    ASSERT_TRUE(memo.Find(std::vector<Value>{3}).has_value());
+}
+
+TEST(ObjectsMemoTableTestSuite, HashableTest) {
+    ASSERT_TRUE(itmoscript::MemoTable::IsHashable(std::vector<Value>{1, 2.5, true, Value{}, itmoscript::CreateString("s")}));
+    ASSERT_FALSE(itmoscript::MemoTable::IsHashable(std::vector<Value>{1, itmoscript::CreateList(std::vector<Value>{})}));
+
+    itmoscript::MemoTable memo;
+    memo.Insert({Value{1}}, itmoscript::CreateList(std::vector<Value>{1}));
+    ASSERT_EQ(memo.size(), 0);
+}
+
+TEST(ObjectsMemoTableTestSuite, StringCopyTest) {
+    itmoscript::MemoTable memo;
+    itmoscript::String arg = itmoscript::CreateString("key");
+    itmoscript::String result = itmoscript::CreateString("value");
+
+    memo.Insert(itmoscript::MemoTable::MakeKey(std::vector<Value>{arg}), Value{result});
+    *arg = "other";
+    *result = "changed";
+
+    auto found = memo.Find(std::vector<Value>{itmoscript::CreateString("key")});
+    ASSERT_TRUE(found.has_value());
+    ASSERT_EQ(*found->Get<itmoscript::String>(), "value");
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "lib/objects/List.hpp"
+
+#include <sstream>
+
+using Value = itmoscript::Value;
+using ValueType = itmoscript::ValueType;
+
+TEST(ObjectsValueTestSuite, TypeTagTest) {
+    ASSERT_EQ(Value{}.GetType(), ValueType::kNullType);
+    ASSERT_EQ(Value{42}.GetType(), ValueType::kInt);
+    ASSERT_EQ(Value{size_t{42}}.GetType(), ValueType::kInt);
+    ASSERT_EQ(Value{1.5}.GetType(), ValueType::kFloat);
+    ASSERT_EQ(Value{true}.GetType(), ValueType::kBool);
+    ASSERT_EQ(Value{itmoscript::CreateString("a")}.GetType(), ValueType::kString);
+    ASSERT_EQ(Value{itmoscript::CreateList({})}.GetType(), ValueType::kList);
+
+    ASSERT_TRUE(Value{itmoscript::CreateString("a")}.IsReferenceType());
+    ASSERT_FALSE(Value{1.5}.IsReferenceType());
+    ASSERT_THROW(Value{1}.Get<itmoscript::Float>(), std::bad_variant_access);
+}
+
+TEST(ObjectsValueTestSuite, ReassignTest) {
+    Value value = itmoscript::CreateString("abc");
+    Value copy = value;
+    ASSERT_EQ(copy.Get<itmoscript::String>(), value.Get<itmoscript::String>());
+
+    value = 5;
+    ASSERT_EQ(value, Value{5});
+    ASSERT_EQ(*copy.Get<itmoscript::String>(), "abc");
+
+    copy = std::move(value);
+    ASSERT_EQ(copy, Value{5});
+}
+
+TEST(ObjectsValueTestSuite, AssignOwnedElementTest) {
+    Value value = itmoscript::CreateList(std::vector<Value>{itmoscript::CreateString("inner"), 2});
+
+    // the assigned element is destroyed together with the list it was taken from
+    value = value.Get<itmoscript::List>()->At(0);
+    ASSERT_EQ(*value.Get<itmoscript::String>(), "inner");
+
+    Value list = itmoscript::CreateList(std::vector<Value>{itmoscript::CreateList(std::vector<Value>{1})});
+    list = list.Get<itmoscript::List>()->At(0);
+    ASSERT_EQ(list, Value{itmoscript::CreateList(std::vector<Value>{1})});
+}
+
+TEST(ObjectsValueTestSuite, ReferenceCountTest) {
+    itmoscript::String str = itmoscript::CreateString("shared");
+    ASSERT_EQ(str->ref_count(), 1);
+
+    {
+        Value first = str;
+        Value second = first;
+        ASSERT_EQ(str->ref_count(), 3);
+
+        Value moved = std::move(second);
+        ASSERT_EQ(str->ref_count(), 3);
+    }
+
+    ASSERT_EQ(str->ref_count(), 1);
+
+    // a copy of the object is a new object without owners
+    itmoscript::String copy = itmoscript::CreateString(*str);
+    ASSERT_EQ(copy->ref_count(), 1);
+    ASSERT_EQ(*copy, *str);
+}
+
+TEST(ObjectsValueTestSuite, SerializeTest) {
+    std::vector<Value> values = {
+        Value{},
+        Value{-42},
+        Value{0.1},
+        Value{1e300},
+        Value{false},
+        Value{itmoscript::CreateString("text")},
+        Value{itmoscript::CreateList({})},
+        Value{itmoscript::CreateList(std::vector<Value>{
+            1,
+            itmoscript::CreateString("a"),
+            itmoscript::CreateList(std::vector<Value>{2.5, Value{}}),
+        })},
+    };
+
+    for (const Value& value : values) {
+        std::ostringstream stream;
+        value.Serialize(stream);
+        ASSERT_EQ(stream.str(), value.ToString());
+    }
+
+    std::ostringstream stream;
+    stream << values.back();
+    ASSERT_EQ(stream.str(), "[1, \"a\", [2.5, nil]]");
+}
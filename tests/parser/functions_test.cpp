@@ -105,3 +105,51 @@ TEST(ParserFunctionsTestSuite, FunctionCallParametersTest) {
         }
     }
 }
+
+TEST(ParserFunctionsTestSuite, DuplicateParametersTest) {
+    ASSERT_THROW(GetParsedProgram("function(x, y, x) end function"), itmoscript::lang_exceptions::ParsingError);
+    ASSERT_THROW(GetParsedProgram("function(a,\n a) return a end function"), itmoscript::lang_exceptions::ParsingError);
+}
+
+TEST(ParserFunctionsTestSuite, GeneratorTest) {
+    std::string code = R"(
+        function (n)
+            yield n
+            f = function() return 1 end function
+            yield
+            return
+        end function
+    )";
+
+    auto program = GetParsedProgram(code);
+    auto* function_literal = GetFuncLiteral(program);
+    ASSERT_TRUE(function_literal->is_generator);
+
+    const auto& body_statements = function_literal->body->GetStatements();
+    ASSERT_EQ(body_statements.size(), 4);
+
+    auto* yield = dynamic_cast<itmoscript::ast::YieldStatement*>(body_statements[0].get());
+    ASSERT_NE(yield, nullptr);
+    TestIdentifier(yield->expr, "n");
+
+    // the nested function has no yield of its own
+    auto* assign = dynamic_cast<itmoscript::ast::AssignStatement*>(body_statements[1].get());
+    ASSERT_NE(assign, nullptr);
+    ASSERT_FALSE(static_cast<itmoscript::ast::FunctionLiteral&>(*assign->expr).is_generator);
+
+    yield = dynamic_cast<itmoscript::ast::YieldStatement*>(body_statements[2].get());
+    ASSERT_NE(yield, nullptr);
+    ASSERT_EQ(yield->expr, nullptr);
+}
+
+TEST(ParserFunctionsTestSuite, GeneratorErrorsTest) {
+    ASSERT_THROW(GetParsedProgram("yield 1"), itmoscript::lang_exceptions::ParsingError);
+    ASSERT_THROW(
+        GetParsedProgram("function() yield 1 return 2 end function"),
+        itmoscript::lang_exceptions::ParsingError
+    );
+    ASSERT_THROW(
+        GetParsedProgram("function() return 2 yield 1 end function"),
+        itmoscript::lang_exceptions::ParsingError
+    );
+}
@@ -4,6 +4,7 @@
 #include <sstream>
 
 #include "lib/Interpreter.hpp"
+#include "lib/parser/ParsingError.hpp"
 
 using TT = itmoscript::TokenType;
 
@@ -0,0 +1,108 @@
+#include "stdlib_test.hpp"
+#include "lib/stdlib/exceptions/FileAccessError.hpp"
+#include "lib/stdlib/exceptions/InvalidArgumentError.hpp"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+using IsValue = itmoscript::Value;
+
+namespace {
+
+std::string WriteTempFile(const std::string& name, const std::string& content) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream{path, std::ios::binary} << content;
+    return path.string();
+}
+
+} // namespace
+
+TEST(StdFilesTestSuite, FileReadTest) {
+    std::string path = WriteTempFile("itmoscript_file_read.txt", "first\nsecond\n\nlast");
+    std::string empty = WriteTempFile("itmoscript_file_read_empty.txt", "");
+
+    ASSERT_EQ(
+        Eval(std::format(R"(file_read("{}"))", path)),
+        IsValue{itmoscript::CreateString("first\nsecond\n\nlast")}
+    );
+    ASSERT_EQ(Eval(std::format(R"(file_read("{}"))", empty)), IsValue{itmoscript::CreateString("")});
+    ASSERT_THROW(Eval(R"(file_read("no/such/file.txt"))"), itmoscript::lang_exceptions::FileAccessError);
+}
+
+TEST(StdFilesTestSuite, FileLinesTest) {
+    std::string path = WriteTempFile("itmoscript_file_lines.txt", "first\nsecond\n\nlast");
+
+    std::vector<std::pair<std::string, IsValue>> expressions = {
+        {std::format(R"(join(file_lines("{}"), "|"))", path), IsValue{itmoscript::CreateString("first|second||last")}},
+        {std::format(R"(len(file_lines("{}")))", path), 4},
+        {std::format(R"(join(file_read_lines("{}"), "|"))", path), IsValue{itmoscript::CreateString("first|second||last")}},
+        {std::format(R"(
+            total = 0
+            for line in file_lines("{}")
+                total += len(line)
+            end for
+            total
+        )", path), 15},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        IsValue evaluated = Eval(input);
+        ASSERT_EQ(evaluated, expected);
+    }
+
+    ASSERT_THROW(Eval(R"(file_lines("no/such/file.txt"))"), itmoscript::lang_exceptions::FileAccessError);
+}
+
+TEST(StdFilesTestSuite, FileHandleTest) {
+    std::string path = (std::filesystem::temp_directory_path() / "itmoscript_file_handle.txt").string();
+    std::filesystem::remove(path);
+
+    std::vector<std::pair<std::string, IsValue>> expressions = {
+        {std::format(R"(
+            out = file_open("{}", "w")
+            for i in range(5)
+                file_write_handle(out, i)
+                file_write_handle(out, ";")
+            end for
+            file_close(out)
+            file_read("{}")
+        )", path, path), IsValue{itmoscript::CreateString("0;1;2;3;4;")}},
+        {std::format(R"(
+            out = file_open("{}", "a", 0)
+            file_write_handle(out, "tail")
+            file_read("{}")
+        )", path, path), IsValue{itmoscript::CreateString("0;1;2;3;4;tail")}},
+        {std::format(R"(
+            out = file_open("{}", "w", 16)
+            file_write_handle(out, "buffered")
+            before = file_read("{}")
+            file_flush(out)
+            before + "|" + file_read("{}")
+        )", path, path, path), IsValue{itmoscript::CreateString("|buffered")}},
+        {std::format(R"(
+            write = function(text)
+                out = file_open("{}", "w")
+                file_write_handle(out, text)
+            end function
+            write("closed at the end of the call")
+            file_read("{}")
+        )", path, path), IsValue{itmoscript::CreateString("closed at the end of the call")}},
+    };
+
+    for (const auto& [input, expected] : expressions) {
+        IsValue evaluated = Eval(input);
+        ASSERT_EQ(evaluated, expected);
+    }
+
+    std::string closed = std::format(R"(
+        out = file_open("{}", "w")
+        file_close(out)
+        file_close(out)
+        file_write_handle(out, "late")
+    )", path);
+
+    ASSERT_THROW(Eval(closed), itmoscript::lang_exceptions::InvalidArgumentError);
+    ASSERT_THROW(Eval(std::format(R"(file_open("{}", "r"))", path)), itmoscript::lang_exceptions::InvalidArgumentError);
+    ASSERT_THROW(Eval(R"(file_open("no/such/dir/file.txt", "w"))"), itmoscript::lang_exceptions::FileAccessError);
+}
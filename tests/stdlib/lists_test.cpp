@@ -11,7 +11,10 @@ TEST(StdListTestSuite, RangeTest) {
         {R"(range(0, 5, 2))", {0, 2, 4}},
         {R"(range(5, 5, 1))", {}},
         {R"(range(0, 3))", {0, 1, 2}},
-        {R"(range(10, 0, -3))", {10, 7, 4, 1}}
+        {R"(range(10, 0, -3))", {10, 7, 4, 1}},
+        {R"(range(5, 10, -1))", {}},
+        {R"(range(-9223372036854775807, 9223372036854775807, 9223372036854775807))", {-9223372036854775807, 0}},
+        {R"(range(10)[3:6])", {3, 4, 5}}
     };
 
     for (const auto& [input, expected_nums] : test_cases) {
@@ -30,7 +33,9 @@ TEST(StdListTestSuite, LenTest) {
         {R"(len([1, 2, 3]))", 3},
         {R"(len([]))", 0},
         {R"(len("hello"))", 5},
-        {R"(len(""))", 0}
+        {R"(len(""))", 0},
+        {R"(len(range(1000000000000)))", 1000000000000},
+        {R"(len(range(-5, 5, 3)))", 4}
     };
 
     for (const auto& [input, expected] : expressions) {
@@ -135,3 +140,19 @@ TEST(StdListTestSuite, SetTest) {
         ASSERT_EQ(evaluated, itmoscript::CreateList(expected_values));
     }
 }
+
+TEST(StdListTestSuite, GcTest) {
+    std::string code = R"(
+        gc()
+        a = [1]
+        push(a, a)
+        b = [a, [2]]
+        push(b[1], b)
+        a = 0
+        b = 0
+        gc()
+    )";
+
+    ASSERT_EQ(Eval(code), IsValue{3});
+    ASSERT_EQ(Eval("gc_threshold(5) \n gc_threshold(1000)"), IsValue{5});
+}
@@ -0,0 +1,74 @@
+#include "vm_test.hpp"
+
+TEST(CompilerTestSuite, ExpressionTest) {
+    std::string expected =
+        "   0 CONSTANT                0 (1)\n"
+        "   1 CONSTANT                1 (2)\n"
+        "   2 CONSTANT                2 (3)\n"
+        "   3 BINARY_OP               *\n"
+        "   4 BINARY_OP               +\n"
+        "   5 DUP\n"
+        "   6 ASSIGN_COPY             0 (x)\n"
+        "   7 SET_RESULT\n"
+        "   8 HALT\n";
+
+    ASSERT_EQ(Compile("x = 1 + 2 * 3"), expected);
+}
+
+TEST(CompilerTestSuite, BuiltinCallTest) {
+    std::string expected =
+        "   0 LOAD_NAME               0 (x)\n"
+        "   1 CALL_BUILTIN            0 (print, 1 args)\n"
+        "   2 SET_RESULT\n"
+        "   3 HALT\n";
+
+    ASSERT_EQ(Compile("print(x)"), expected);
+}
+
+TEST(CompilerTestSuite, WhileLoopTest) {
+    std::string expected =
+        "   0 LOAD_NAME               0 (x)\n"
+        "   1 JUMP_IF_FALSE           4\n"
+        "   2 JUMP                    0\n"
+        "   3 JUMP                    0\n"
+        "   4 CONSTANT                0 (nil)\n"
+        "   5 SET_RESULT\n"
+        "   6 HALT\n";
+
+    ASSERT_EQ(Compile("while x\n continue\nend while"), expected);
+}
+
+TEST(CompilerTestSuite, ForLoopTest) {
+    std::string expected =
+        "   0 LOAD_NAME               0 (xs)\n"
+        "   1 ITER_PREPARE\n"
+        "   2 ITER_NEXT               8\n"
+        "   3 STORE_LOCAL             0\n"
+        "   4 LOAD_LOCAL              0\n"
+        "   5 ASSIGN                  1 (y)\n"
+        "   6 POP_SCOPE               1 ([1, 2))\n"
+        "   7 JUMP                    2\n"
+        "   8 POP_SCOPE               0 ([0, 1))\n"
+        "   9 POP\n"
+        "  10 POP\n"
+        "  11 CONSTANT                0 (nil)\n"
+        "  12 SET_RESULT\n"
+        "  13 HALT\n";
+
+    ASSERT_EQ(Compile("for i in xs\n y = i\nend for"), expected);
+}
+
+TEST(CompilerTestSuite, LogicalOperatorsTest) {
+    std::string expected =
+        "   0 LOAD_NAME               0 (x)\n"
+        "   1 JUMP_IF_FALSE           6\n"
+        "   2 LOAD_NAME               1 (y)\n"
+        "   3 JUMP_IF_FALSE           6\n"
+        "   4 CONSTANT                0 (true)\n"
+        "   5 JUMP                    7\n"
+        "   6 CONSTANT                1 (false)\n"
+        "   7 SET_RESULT\n"
+        "   8 HALT\n";
+
+    ASSERT_EQ(Compile("x and y"), expected);
+}
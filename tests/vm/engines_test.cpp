@@ -0,0 +1,655 @@
+#include "vm_test.hpp"
+
+TEST(EnginesTestSuite, NestedLoopsTest) {
+    std::string code = R"(
+        result = ""
+        for i in range(5)
+            if i == 1 then continue end if
+            j = 0
+            while true
+                j += 1
+                if j > i then break end if
+                if j % 2 == 0 then
+                    continue
+                end if
+                result += to_string(i) + to_string(j) + " "
+            end while
+            if i == 3 then break end if
+        end for
+        print(result)
+    )";
+
+    ExpectSameOutput(code, "21 31 33 ");
+}
+
+TEST(EnginesTestSuite, RecursionTest) {
+    std::string code = R"(
+        fib = function(n)
+            if n < 2 then return n end if
+            return fib(n - 1) + fib(n - 2)
+        end function
+
+        print(fib(15))
+    )";
+
+    ExpectSameOutput(code, "610");
+}
+
+TEST(EnginesTestSuite, ReturnFromLoopTest) {
+    std::string code = R"(
+        find = function(list, value)
+            for i in range(len(list))
+                while true
+                    if list[i] == value then
+                        return i
+                    end if
+                    break
+                end while
+            end for
+            return -1
+        end function
+
+        print(find([3, 1, 4, 1, 5], 4))
+        print(find([1, 2], 3))
+    )";
+
+    ExpectSameOutput(code, "2-1");
+}
+
+TEST(EnginesTestSuite, ShadowedStandardFunctionTest) {
+    std::string code = R"(
+        apply = function(print, x)
+            return print(x)
+        end function
+
+        print(apply(function(x) return x * 2 end function, 21))
+    )";
+
+    ExpectSameOutput(code, "42");
+}
+
+TEST(EnginesTestSuite, ReferenceSemanticsTest) {
+    std::string code = R"(
+        clear = function(arr)
+            arr = []
+        end function
+
+        x = [1, 2, 3]
+        clear(x)
+        s = "abc"
+        t = s
+        s = "de"
+        print(x)
+        print(t + s[1:] + s[-1])
+    )";
+
+    ExpectSameOutput(code, "[]deee");
+}
+
+TEST(EnginesTestSuite, IfExpressionValueTest) {
+    std::string code = R"(
+        x = if 1 > 2 then "a" elseif 2 > 1 then "b" else "c" end if
+        y = if false then 1 end if
+        print(x)
+        print(y)
+    )";
+
+    ExpectSameOutput(code, "bnil");
+}
+
+TEST(EnginesTestSuite, LoopValueTest) {
+    std::vector<std::string> loops = {
+        "for v in [1, 2] break end for",
+        "for v in [1, 2] v end for",
+        "for v in [] end for",
+        "x = 0 while x < 3 x += 1 end while",
+        "while false end while",
+        R"(
+            g = function()
+                yield 1
+                yield 2
+            end function
+            for v in g() if v == 1 then break end if end for
+        )",
+        "for v in [1, 2] if v == 2 then continue end if v end for",
+    };
+
+    // a loop is a statement, its value is nil however it ends
+    for (const std::string& code : loops) {
+        ASSERT_EQ(EvalLastValue(code, itmoscript::vm::ExecutionMode::kTreeWalk), itmoscript::Value{}) << code;
+        ASSERT_EQ(EvalLastValue(code, itmoscript::vm::ExecutionMode::kBytecode), itmoscript::Value{}) << code;
+    }
+
+    // continue in the last iteration doesn't leave the enclosing function
+    std::string code = R"(
+        f = function()
+            for i in [1, 2]
+                continue
+            end for
+            return "after"
+        end function
+        print(f())
+    )";
+
+    ExpectSameOutput(code, "after");
+}
+
+TEST(EnginesTestSuite, RuntimeErrorTest) {
+    std::string code = R"(
+        f = function(x)
+            return x / 0
+        end function
+
+        print("before")
+        f(1)
+        print("after")
+    )";
+
+    std::string walker_output = RunCode(code, itmoscript::vm::ExecutionMode::kTreeWalk);
+    std::string vm_output = RunCode(code, itmoscript::vm::ExecutionMode::kBytecode);
+
+    ASSERT_TRUE(vm_output.starts_with("before"));
+    ASSERT_EQ(vm_output.find("after"), std::string::npos);
+    ASSERT_NE(vm_output.find("ZeroDivisionError"), std::string::npos);
+    ASSERT_NE(vm_output.find("f, on line 7"), std::string::npos);
+    ASSERT_NE(walker_output.find("f, on line 7"), std::string::npos);
+}
+
+TEST(EnginesTestSuite, ControlFlowErrorTest) {
+    std::string code = R"(
+        print(1)
+        break
+    )";
+
+    std::string vm_output = RunCode(code, itmoscript::vm::ExecutionMode::kBytecode);
+
+    ASSERT_TRUE(vm_output.starts_with("1"));
+    ASSERT_NE(vm_output.find("ControlFlowError"), std::string::npos);
+}
+
+TEST(EnginesTestSuite, ScopesTest) {
+    std::string code = R"(
+        total = 0
+        add = function(n)
+            for i in range(n)
+                if i % 2 == 0 then
+                    even = i
+                    total += even
+                end if
+            end for
+            return total
+        end function
+
+        print(add(5))
+        print(add(3))
+
+        for i in range(2)
+            seen = "next"
+            if i == 0 then
+                seen = "first"
+            end if
+            print(seen)
+        end for
+    )";
+
+    ExpectSameOutput(code, "68firstnext");
+}
+
+TEST(EnginesTestSuite, NestedCallArgumentsTest) {
+    std::string code = R"(
+        add = function(a, b) return a + b end function
+        depth = function() return len(stacktrace()) end function
+
+        print(add(add(1, len([1, 2])), add(depth(), add(3, 4))))
+        print(add(to_string(len(range(add(2, 3)))), "!"))
+    )";
+
+    ExpectSameOutput(code, "115!");
+}
+
+TEST(EnginesTestSuite, LogicalShortCircuitTest) {
+    std::string code = R"(
+        calls = 0
+        check = function(value)
+            calls += 1
+            return value
+        end function
+
+        a = check(false) and check(true)
+        b = check(true) or check(false)
+        c = check(true) and check(nil)
+        d = check(0) or check(1)
+        print([a, b, c, d, calls])
+    )";
+
+    ExpectSameOutput(code, "[false, true, false, true, 6]");
+}
+
+TEST(EnginesTestSuite, TailCallTest) {
+    std::string code = R"(
+        sum = function(n, acc)
+            if n == 0 then return acc end if
+            return sum(n - 1, acc + n)
+        end function
+
+        is_even = function(n)
+            if n == 0 then return true end if
+            return is_odd(n - 1)
+        end function
+
+        is_odd = function(n)
+            if n == 0 then return false end if
+            return is_even(n - 1)
+        end function
+
+        print(sum(100000, 0))
+        print(is_even(100001))
+    )";
+
+    ExpectSameOutput(code, "5000050000false");
+}
+
+TEST(EnginesTestSuite, TailCallStacktraceTest) {
+    std::string code = R"(
+        trace = function(n)
+            if n == 0 then
+                s = stacktrace()
+                return s
+            end if
+            return trace(n - 1)
+        end function
+
+        outer = function()
+            s = trace(3)
+            return s
+        end function
+
+        print(outer())
+    )";
+
+    // the tail calls replace the frame of the first call
+    ExpectSameOutput(code, R"([["outer", 15], ["trace", 7]])");
+}
+
+TEST(EnginesTestSuite, DeepRecursionTest) {
+    std::string code = R"(
+        sum = function(n)
+            if n == 0 then return 0 end if
+            return n + sum(n - 1)
+        end function
+
+        print(sum(200000))
+    )";
+
+    ExpectSameOutput(code, "20000100000");
+}
+
+TEST(EnginesTestSuite, RecursionDepthErrorTest) {
+    std::string code = R"(
+        down = function(n)
+            return 1 + down(n + 1)
+        end function
+
+        print("before")
+        down(0)
+    )";
+
+    for (auto mode : {itmoscript::vm::ExecutionMode::kTreeWalk, itmoscript::vm::ExecutionMode::kBytecode}) {
+        std::istringstream input(code);
+        std::ostringstream output;
+
+        itmoscript::Interpreter interpreter{mode};
+        interpreter.SetMaxCallDepth(100);
+        ASSERT_FALSE(interpreter.Interpret(input, std::cin, output));
+
+        std::string result = output.str();
+        ASSERT_TRUE(result.starts_with("before"));
+        ASSERT_NE(result.find("RecursionDepthError"), std::string::npos);
+        ASSERT_NE(result.find("maximum call depth exceeded (100 calls)"), std::string::npos);
+        // the identical frames of the recursion are printed once
+        ASSERT_NE(result.find("[previous line repeated 98 more times]"), std::string::npos);
+    }
+}
+
+TEST(EnginesTestSuite, FunctionPrototypeTest) {
+    std::string code = R"(
+        make = function()
+            return function(x) return x * 2 end function
+        end function
+
+        f = make()
+        g = make()
+        print(f == g)
+        print(f == f)
+        print(f(2) + g(3))
+    )";
+
+    // the functions share the literal's prototype but stay distinct objects
+    ExpectSameOutput(code, "falsetrue10");
+}
+
+TEST(EnginesTestSuite, StringLiteralSharingTest) {
+    std::string code = R"(
+        f = function()
+            for i in range(3)
+                if i == 2 then return "end" end if
+            end for
+        end function
+        f()
+    )";
+
+    // every evaluation of the literal loads the frozen constant, a copy would not be frozen
+    for (auto mode : {itmoscript::vm::ExecutionMode::kTreeWalk, itmoscript::vm::ExecutionMode::kBytecode}) {
+        itmoscript::Value value = EvalLastValue(code, mode);
+        ASSERT_TRUE(value.IsOfType<itmoscript::String>());
+        ASSERT_TRUE(value.Get<itmoscript::String>()->frozen());
+    }
+
+    // stored literals are copies, changing them leaves the constant as is
+    std::string stores = R"(
+        exclaim = function(s)
+            s += "!"
+            return s
+        end function
+
+        g = function()
+            l = []
+            for i in range(2)
+                w = "end"
+                w += "?"
+                push(l, exclaim("end"))
+                push(l, w)
+                push(l, ["end"])
+            end for
+            return l
+        end function
+
+        print(g())
+        print("end")
+    )";
+
+    ExpectSameOutput(stores, R"(["end!", "end?", ["end"], "end!", "end?", ["end"]]end)");
+}
+
+TEST(EnginesTestSuite, MemoizeTest) {
+    std::string code = R"(
+        // the recursive calls go through the memoized function too
+        fib = memoize(function(n)
+            if n < 2 then return n end if
+            return fib(n - 1) + fib(n - 2)
+        end function)
+
+        print(fib(90))
+        print(memo_stats(fib))
+    )";
+
+    ExpectSameOutput(code, "2880067194370816120[88, 91, 91]");
+}
+
+TEST(EnginesTestSuite, MemoizePureCalleeTest) {
+    std::string code = R"(
+        sq = function(x)
+            t = x * x
+            return t
+        end function
+
+        sumsq = memoize(function(n)
+            s = 0
+            for i in range(1, n + 1)
+                s += sq(i)
+            end for
+            return s
+        end function)
+
+        print(sumsq(100))
+        print(sumsq(100))
+        print(memo_stats(sumsq))
+    )";
+
+    ExpectSameOutput(code, "338350338350[1, 1, 1]");
+}
+
+TEST(EnginesTestSuite, MemoizeCapacityTest) {
+    std::string code = R"(
+        greet = memoize(function(name) return name + "!" end function, 2)
+        for name in ["a", "b", "a", "c", "b"]
+            print(greet(name))
+        end for
+        print(memo_stats(greet))
+    )";
+
+    // "b" is evicted by "c" as the least recently used one
+    ExpectSameOutput(code, "a!b!a!c!b![1, 4, 2]");
+}
+
+TEST(EnginesTestSuite, ImpureFunctionErrorTest) {
+    std::string code = R"(
+        count = 0
+        f = function(x)
+            count += 1
+            return x
+        end function
+
+        print("before")
+        g = memoize(f)
+    )";
+
+    for (auto mode : {itmoscript::vm::ExecutionMode::kTreeWalk, itmoscript::vm::ExecutionMode::kBytecode}) {
+        std::string output = RunCode(code, mode);
+        ASSERT_TRUE(output.starts_with("before"));
+        ASSERT_NE(output.find("ImpureFunctionError"), std::string::npos);
+    }
+}
+
+TEST(EnginesTestSuite, IterationTest) {
+    std::string code = R"(
+        s = 0
+        for i in range(1000000)
+            s += i
+        end for
+        print(s)
+
+        for c in "abc"
+            print(c + ".")
+        end for
+
+        list = [1, 2]
+        for x in list
+            if x < 4 then push(list, x + 2) end if
+            print(x)
+        end for
+    )";
+
+    // the loop walks the range lazily and sees the elements appended by its body
+    ExpectSameOutput(code, "499999500000a.b.c.12345");
+}
+
+TEST(EnginesTestSuite, GeneratorPipelineTest) {
+    std::string code = R"(
+        naturals = function(n)
+            i = 0
+            while i < n
+                yield i
+                i += 1
+            end while
+        end function
+
+        squares = function(source)
+            for x in source
+                yield x * x
+            end for
+        end function
+
+        evens = function(source)
+            for x in source
+                if x % 2 == 0 then yield x end if
+            end for
+        end function
+
+        total = 0
+        for v in evens(squares(naturals(100000)))
+            total += v
+        end for
+        print(total)
+
+        g = naturals(4)
+        for x in g
+            print(x)
+            if x == 1 then break end if
+        end for
+        for x in g
+            print(x)
+        end for
+        for x in g
+            print("drained")
+        end for
+    )";
+
+    // the stages run in turns, one value at a time; a generator resumes where the previous loop left it
+    ExpectSameOutput(code, "1666616667000000123");
+}
+
+TEST(EnginesTestSuite, GeneratorBuiltinsTest) {
+    std::string code = R"(
+        walk = function(n)
+            if n == 0 then
+                yield 0
+                return
+            end if
+            for x in walk(n - 1)
+                yield x + 1
+            end for
+            yield n * 10
+        end function
+
+        print(join(walk(3), " "))
+        print(len(walk(3)))
+        print(sort(walk(2)))
+        print(type_of(walk(1)))
+
+        chars = function(s)
+            for c in s
+                yield upper(c)
+            end for
+        end function
+        print(join(chars("abc"), "-"))
+    )";
+
+    ExpectSameOutput(code, "3 12 21 304[2, 11, 20]GeneratorA-B-C");
+}
+
+TEST(EnginesTestSuite, GeneratorLoopInvariantTest) {
+    // every iteration resumes the generator, which assigns the global the loop reads
+    std::string code = R"(
+        n = 0
+        gen = function()
+            for i in range(3)
+                n = n + 1
+                yield n
+            end for
+        end function
+
+        total = 0
+        for x in gen()
+            total += n * 10
+            println(total)
+        end for
+    )";
+
+    ExpectSameOutput(code, "10\n30\n60\n");
+}
+
+TEST(EnginesTestSuite, GeneratorDrainingLoopInvariantTest) {
+    // len(), join() and sort() drain the generator, so their results differ on every iteration
+    std::string code = R"(
+        gen = function()
+            for i in range(3)
+                yield i
+            end for
+        end function
+
+        a = gen()
+        b = gen()
+        c = gen()
+        i = 0
+        while i < 2
+            println(len(a))
+            println(join(b, ","))
+            println(sort(c))
+            i += 1
+        end while
+    )";
+
+    ExpectSameOutput(code, "3\n0,1,2\n[0, 1, 2]\n0\n\n[]\n");
+}
+
+TEST(EnginesTestSuite, GeneratorStacktraceTest) {
+    std::string code = R"(
+        gen = function()
+            yield stacktrace()
+        end function
+
+        consume = function()
+            for s in gen()
+                return s
+            end for
+        end function
+
+        print(consume())
+    )";
+
+    // the body runs as a call made by the loop resuming it
+    ExpectSameOutput(code, R"([["consume", 12], ["gen", 7]])");
+}
+
+TEST(EnginesTestSuite, OutputBufferingTest) {
+    std::string code = R"(
+        println([1, "two", 3.5, [nil, true]])
+        print("number: ")
+        n = parse_num(read())
+        println(n * 2)
+    )";
+
+    // input of one line, which remembers the output printed before it was read
+    class PromptCheckingInput : public std::streambuf {
+    public:
+        explicit PromptCheckingInput(const std::ostringstream& output)
+            : output_(output) {}
+
+        std::string printed;
+
+    protected:
+        int_type underflow() override {
+            if (served_) {
+                return traits_type::eof();
+            }
+
+            printed = output_.str();
+            served_ = true;
+            setg(line_, line_, line_ + 3);
+            return traits_type::to_int_type(line_[0]);
+        }
+
+    private:
+        const std::ostringstream& output_;
+        char line_[3] = {'2', '1', '\n'};
+        bool served_ = false;
+    };
+
+    for (auto policy : {itmoscript::OutputSink::Policy::kLine, itmoscript::OutputSink::Policy::kBlock, itmoscript::OutputSink::Policy::kNone}) {
+        for (auto mode : {itmoscript::vm::ExecutionMode::kTreeWalk, itmoscript::vm::ExecutionMode::kBytecode}) {
+            std::istringstream source(code);
+            std::ostringstream output;
+            PromptCheckingInput input_buffer{output};
+            std::istream input{&input_buffer};
+
+            itmoscript::Interpreter interpreter{mode};
+            interpreter.SetOutputBuffering(policy);
+            ASSERT_TRUE(interpreter.Interpret(source, input, output));
+
+            // the prompt is flushed before the input is read
+            ASSERT_EQ(input_buffer.printed, "[1, \"two\", 3.5, [nil, true]]\nnumber: ");
+            ASSERT_EQ(output.str(), "[1, \"two\", 3.5, [nil, true]]\nnumber: 42\n");
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include <lib/Interpreter.hpp>
+#include <lib/vm/Compiler.hpp>
+#include <lib/evaluation/Resolver.hpp>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+inline std::string Compile(const std::string& code) {
+    itmoscript::Lexer lexer{code};
+    itmoscript::Parser parser{lexer};
+    itmoscript::ast::Program program = parser.ParseProgram();
+
+    itmoscript::GlobalSlots globals;
+    itmoscript::Resolver resolver{globals};
+    resolver.Resolve(program);
+
+    itmoscript::stdlib::StdLib std_lib;
+    std_lib.LoadDefault();
+
+    itmoscript::vm::Compiler compiler{std_lib};
+    return compiler.CompileProgram(program)->chunk.Disassemble();
+}
+
+inline std::string RunCode(const std::string& code, itmoscript::vm::ExecutionMode mode) {
+    std::istringstream input(code);
+    std::ostringstream output;
+
+    itmoscript::Interpreter interpreter{mode};
+    interpreter.Interpret(input, std::cin, output);
+
+    return output.str();
+}
+
+/** @brief Runs the code and returns the value of the last statement, the one the REPL prints. */
+inline itmoscript::Value EvalLastValue(const std::string& code, itmoscript::vm::ExecutionMode mode) {
+    itmoscript::Lexer lexer{code};
+    itmoscript::Parser parser{lexer};
+    itmoscript::ast::Program program = parser.ParseProgram();
+
+    itmoscript::Evaluator evaluator;
+    evaluator.EnableStandardOperators();
+    evaluator.EnableStd();
+
+    std::stringstream dummy;
+
+    if (mode == itmoscript::vm::ExecutionMode::kTreeWalk) {
+        evaluator.Evaluate(program, dummy, dummy);
+    } else {
+        itmoscript::vm::VirtualMachine machine{evaluator};
+        machine.Evaluate(program, dummy, dummy);
+    }
+
+    return evaluator.GetLastEvaluatedValue();
+}
+
+/** @brief Runs the code with both engines and checks that the output is the same. */
+inline void ExpectSameOutput(const std::string& code, const std::string& expected) {
+    ASSERT_EQ(RunCode(code, itmoscript::vm::ExecutionMode::kTreeWalk), expected);
+    ASSERT_EQ(RunCode(code, itmoscript::vm::ExecutionMode::kBytecode), expected);
+}